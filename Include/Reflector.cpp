@@ -5,8 +5,23 @@
 #if defined(REFLECTOR_USES_GC) && REFLECTOR_USES_GC
 #include "ReflectorGC.h"
 #endif
+#if defined(REFLECTOR_USES_BINARY) && REFLECTOR_USES_BINARY
+#include "ReflectorBinary.h"
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <optional>
+#endif
 
 #include <unordered_map>
+#include <chrono>
+#include <cassert>
+#if defined(REFLECTOR_USES_GC) && REFLECTOR_USES_GC
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#endif
 
 namespace Reflector
 {
@@ -72,16 +87,20 @@ namespace Reflector
 		return result;
 	}
 
+#if defined(REFLECTOR_CONSTINIT_DATABASE) && REFLECTOR_CONSTINIT_DATABASE
+#define REFLECTOR_REFLECTABLE_DATA_STORAGE constinit
+#else
+#define REFLECTOR_REFLECTABLE_DATA_STORAGE
+#endif
+
 	Class const& Reflectable::StaticGetReflectionData()
 	{
-		static const Class data = {
+		/// In constinit mode this is constant-initialized, so there is no guard check on access
+		static REFLECTOR_REFLECTABLE_DATA_STORAGE const Class data = {
 			.Name = "Reflectable",
 			.FullType = "Reflector::Reflectable",
 			.BaseClassName = "",
 			.Attributes = "",
-	#if REFLECTOR_USES_JSON
-			.AttributesJSON = {},
-	#endif
 			.Alignment = alignof(Reflectable),
 			.Size = sizeof(Reflectable),
 			.Destructor = [](void* obj) { auto ptr = (Reflectable*)obj; ptr->~Reflectable(); },
@@ -90,38 +109,355 @@ namespace Reflector
 		return data;
 	}
 
+#undef REFLECTOR_REFLECTABLE_DATA_STORAGE
+
 	Class const& Reflectable::GetReflectionData() const
 	{
 		return StaticGetReflectionData();
 	}
 
+#if REFLECTOR_USES_JSON
+	void ReleaseParsedAttributes()
+	{
+		for (auto klass = Classes; *klass; ++klass)
+		{
+			(*klass)->AttributesJSON.Release();
+			for (auto& field : (*klass)->Fields)
+				field.AttributesJSON.Release();
+			for (auto& method : (*klass)->Methods)
+				method.AttributesJSON.Release();
+			for (auto& property : (*klass)->Properties)
+				property.AttributesJSON.Release();
+		}
+		for (auto henum = Enums; *henum; ++henum)
+		{
+			(*henum)->AttributesJSON.Release();
+			for (auto& enumerator : (*henum)->Enumerators)
+				enumerator.AttributesJSON.Release();
+		}
+	}
+#endif
+
+	/// Both of these are constant-initialized, so they can be safely written to during static initialization
+	std::chrono::nanoseconds mDatabaseStaticInitializationTime{};
+	std::chrono::nanoseconds mDatabaseEagerInitializationTime{};
+
+	void RecordDatabaseStaticInitializationTime(std::chrono::nanoseconds time) noexcept
+	{
+		mDatabaseStaticInitializationTime = time;
+	}
+
+#if REFLECTOR_USES_JSON && defined(NLOHMANN_JSON_NAMESPACE_BEGIN)
+	static size_t EstimateJSONBytes(REFLECTOR_JSON_TYPE const& value)
+	{
+		using json = REFLECTOR_JSON_TYPE;
+		/// Every value is stored inline in its parent; objects, arrays and strings additionally allocate their storage
+		size_t result = sizeof(json);
+		if (value.is_string())
+			result += sizeof(typename json::string_t) + value.template get_ref<typename json::string_t const&>().capacity();
+		else if (value.is_array())
+		{
+			result += sizeof(typename json::array_t);
+			for (auto const& element : value)
+				result += EstimateJSONBytes(element);
+		}
+		else if (value.is_object())
+		{
+			/// Assuming a node-based map with three pointers and a color per node
+			result += sizeof(typename json::object_t);
+			for (auto it = value.begin(); it != value.end(); ++it)
+				result += 4 * sizeof(void*) + sizeof(typename json::string_t) + it.key().capacity() + EstimateJSONBytes(it.value());
+		}
+		return result;
+	}
+#endif
+
+	template <typename T>
+	static size_t ListBytes(ReflectionList<T> const& list) noexcept
+	{
+#if defined(REFLECTOR_CONSTINIT_DATABASE) && REFLECTOR_CONSTINIT_DATABASE
+		return list.size_bytes();
+#else
+		return list.capacity() * sizeof(T);
+#endif
+	}
+
+	static size_t OwnedStringBytes([[maybe_unused]] ReflectionString const& str) noexcept
+	{
+#if defined(REFLECTOR_CONSTINIT_DATABASE) && REFLECTOR_CONSTINIT_DATABASE
+		return 0;
+#else
+		/// Strings that fit in the small-string buffer don't allocate
+		return str.capacity() > std::string{}.capacity() ? str.capacity() + 1 : 0;
+#endif
+	}
+
+	DatabaseStatistics GetDatabaseStatistics()
+	{
+		DatabaseStatistics result;
+		result.StaticInitializationTime = mDatabaseStaticInitializationTime;
+		result.EagerInitializationTime = mDatabaseEagerInitializationTime;
+
+		const auto add_common = [&](auto const& entity) {
+			result.StaticStringBytes += entity.Name.size() + entity.DisplayName.size() + entity.Attributes.size();
+#if REFLECTOR_USES_JSON
+			if (entity.AttributesJSON.IsParsed())
+			{
+				++result.ParsedAttributeCount;
+#if defined(NLOHMANN_JSON_NAMESPACE_BEGIN)
+				result.ParsedAttributeBytes += EstimateJSONBytes(entity.AttributesJSON.Get());
+#endif
+			}
+#endif
+		};
+
+		for (auto klass = Classes; *klass; ++klass)
+		{
+			auto const& k = **klass;
+			++result.ClassCount;
+			result.DataBytes += sizeof(Class) + ListBytes(k.Fields) + ListBytes(k.Methods) + ListBytes(k.Properties);
+			result.OwnedStringBytes += OwnedStringBytes(k.GUID);
+			result.StaticStringBytes += k.FullType.size() + k.BaseClassName.size();
+			add_common(k);
+
+			for (auto& field : k.Fields)
+			{
+				++result.FieldCount;
+				result.StaticStringBytes += field.FieldType.size() + field.Initializer.size();
+				add_common(field);
+			}
+			for (auto& method : k.Methods)
+			{
+				++result.MethodCount;
+				result.DataBytes += ListBytes(method.ParametersSplit) + ListBytes(method.ParameterTypeIndices);
+				for (auto& param : method.ParametersSplit)
+					result.OwnedStringBytes += OwnedStringBytes(param.Name) + OwnedStringBytes(param.Type) + OwnedStringBytes(param.Initializer);
+				result.StaticStringBytes += method.ReturnType.size() + method.Parameters.size() + method.UniqueName.size() + method.ArtificialBody.size();
+				add_common(method);
+			}
+			for (auto& property : k.Properties)
+			{
+				++result.PropertyCount;
+				result.StaticStringBytes += property.Type.size();
+				add_common(property);
+			}
+		}
+
+		for (auto henum = Enums; *henum; ++henum)
+		{
+			auto const& e = **henum;
+			++result.EnumCount;
+			result.DataBytes += sizeof(Enum) + ListBytes(e.Enumerators);
+			result.StaticStringBytes += e.FullType.size();
+			add_common(e);
+			for (auto& enumerator : e.Enumerators)
+			{
+				++result.EnumeratorCount;
+				add_common(enumerator);
+			}
+		}
+
+		return result;
+	}
+
+	std::chrono::nanoseconds InitializeDatabase([[maybe_unused]] bool parse_attributes)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		/// The reflection data of all types is already created when `Classes` and `Enums` are initialized (or constant-initialized,
+		/// if REFLECTOR_CONSTINIT_DATABASE is set), so what is left to do on first access is parsing the attributes.
+#if REFLECTOR_USES_JSON
+		if (parse_attributes)
+		{
+			for (auto klass = Classes; *klass; ++klass)
+			{
+				(void)(*klass)->AttributesJSON.Get();
+				for (auto& field : (*klass)->Fields)
+					(void)field.AttributesJSON.Get();
+				for (auto& method : (*klass)->Methods)
+					(void)method.AttributesJSON.Get();
+				for (auto& property : (*klass)->Properties)
+					(void)property.AttributesJSON.Get();
+			}
+			for (auto henum = Enums; *henum; ++henum)
+			{
+				(void)(*henum)->AttributesJSON.Get();
+				for (auto& enumerator : (*henum)->Enumerators)
+					(void)enumerator.AttributesJSON.Get();
+			}
+		}
+#endif
+
+		mDatabaseEagerInitializationTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+		return mDatabaseEagerInitializationTime;
+	}
+
 #if defined(REFLECTOR_USES_GC) && REFLECTOR_USES_GC
 
-	std::unordered_set<Reflectable*> mExtantObjects;
-	/// TODO: Force RootSet items to always be in Objects, as serializing depends on it
-	std::unordered_map<Class const*, std::vector<Reflectable*>> mFreeLists;
-	size_t mAllocatedBytes = 0;
-	size_t mFreeListBytes = 0;
-	std::unordered_map<intptr_t, std::pair<Reflectable*, Class const*>> mLoadingMapping;
-	bool mLoadingHeap = false;
+	/// The state of a thread marking objects in parallel with others. Each worker marks the objects in its private stack,
+	/// and when it has a lot of them, moves some into its shared queue, from which idle workers can steal them.
+	struct MarkWorker
+	{
+		std::vector<Reflectable const*> Local;
+		std::mutex SharedMutex;
+		std::deque<Reflectable const*> Shared;
+		std::atomic<size_t> SharedSize = 0;
+
+		/// Once the private stack is this large, half of it is moved to the shared queue (if that is empty)
+		static constexpr size_t ShareThreshold = 64;
 
-	std::map<std::string, Reflectable*, std::less<>> mRoots;
+		void Push(Reflectable const* obj)
+		{
+			Local.push_back(obj);
+			if (Local.size() >= ShareThreshold && SharedSize.load(std::memory_order_relaxed) == 0)
+			{
+				/// The bottom of the stack is closest to the roots, so it's the most likely to lead to more work for the thief
+				const auto half = Local.begin() + Local.size() / 2;
+				std::unique_lock lock{ SharedMutex };
+				Shared.insert(Shared.end(), Local.begin(), half);
+				SharedSize.store(Shared.size());
+				Local.erase(Local.begin(), half);
+			}
+		}
 
-	std::map<std::string, Reflectable*, std::less<>> const& Heap::Roots()
+		/// Moves objects from `from`'s shared queue into our private stack; all of them if `from` is us, half otherwise
+		bool TakeFrom(MarkWorker& from)
+		{
+			if (from.SharedSize.load() == 0)
+				return false;
+			std::unique_lock lock{ from.SharedMutex };
+			const auto count = (&from == this) ? from.Shared.size() : (from.Shared.size() + 1) / 2;
+			Local.insert(Local.end(), from.Shared.begin(), from.Shared.begin() + count);
+			from.Shared.erase(from.Shared.begin(), from.Shared.begin() + count);
+			from.SharedSize.store(from.Shared.size());
+			return count > 0;
+		}
+	};
+
+	thread_local MarkWorker* tMarkWorker = nullptr;
+
+	/// Adds the time spent in its scope to `Total`
+	struct StatisticsTimer
 	{
-		return mRoots;
+		std::chrono::nanoseconds& Total;
+		std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+		~StatisticsTimer() { Total += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Start); }
+	};
+
+	/// The pages a thread allocates objects from on a heap, one per class, and whether the thread is attached to that heap
+	struct Heap::AllocationBuffer
+	{
+		uint64_t HeapID = 0;
+		uint64_t Epoch = 0;
+		bool Attached = false;
+		std::unordered_map<Class const*, HeapPage*> Pages;
+	};
+
+	/// The heaps that exist, with their IDs, so that exiting threads don't give pages back to heaps that were destroyed
+	struct HeapRegistry
+	{
+		std::mutex Mutex;
+		std::unordered_map<Heap const*, uint64_t> LiveHeaps;
+		/// Used for both heap IDs and epochs
+		std::atomic<uint64_t> NextID = 0;
+	};
+
+	static HeapRegistry& Registry()
+	{
+		static HeapRegistry registry;
+		return registry;
 	}
-	
+
+	struct Heap::ThreadAllocationBuffers
+	{
+		std::unordered_map<Heap*, AllocationBuffer> Buffers;
+		/// Most threads only use a single heap
+		Heap const* LastHeap = nullptr;
+		AllocationBuffer* LastBuffer = nullptr;
+
+		~ThreadAllocationBuffers()
+		{
+			auto& registry = Registry();
+			std::unique_lock lock{ registry.Mutex };
+			for (auto& [heap, buffer] : Buffers)
+			{
+				if (const auto it = registry.LiveHeaps.find(heap); it != registry.LiveHeaps.end() && it->second == buffer.HeapID)
+					heap->Detach(buffer);
+			}
+		}
+	};
+
+	thread_local Heap::ThreadAllocationBuffers Heap::mThreadBuffers;
+	thread_local Heap* tCurrentHeap = nullptr;
+
+#if defined(REFLECTOR_USES_BINARY) && REFLECTOR_USES_BINARY
+	/// The heap whose snapshot is being saved, and for each word of the live bitmap of each of its pages (by `HeapPage::Index`),
+	/// the snapshot index of the first object in that word; the objects of the snapshot being loaded, by index
+	thread_local Heap const* tSnapshotHeap = nullptr;
+	thread_local std::vector<uint64_t> tSnapshotWordIndices;
+	thread_local std::vector<Reflectable*> tSnapshotObjects;
+#endif
+
+	Heap::Heap()
+		: mEpoch(++Registry().NextID)
+		, mID(mEpoch)
+	{
+		auto& registry = Registry();
+		std::unique_lock lock{ registry.Mutex };
+		registry.LiveHeaps[this] = mID;
+	}
+
+	Heap::~Heap()
+	{
+		{
+			auto& registry = Registry();
+			std::unique_lock lock{ registry.Mutex };
+			registry.LiveHeaps.erase(this);
+		}
+		Clear();
+	}
+
+	Heap& Heap::Default()
+	{
+		/// Never destroyed, so that its objects can be used until the program exits
+		static const auto heap = new Heap;
+		return *heap;
+	}
+
+	Heap& Heap::Current()
+	{
+		return tCurrentHeap ? *tCurrentHeap : Default();
+	}
+
+	Heap::CurrentScope::CurrentScope(Heap& heap)
+		: mPrevious(tCurrentHeap)
+	{
+		tCurrentHeap = &heap;
+	}
+
+	Heap::CurrentScope::~CurrentScope()
+	{
+		tCurrentHeap = mPrevious;
+	}
+
 	bool Heap::SetRoot(std::string_view key, Reflectable* r)
 	{
 		if (r == nullptr)
 			return false;
+		const auto heap = Of(r);
+		if (heap && heap != this)
+			return false;
+		std::unique_lock lock{ mHeapMutex };
+		if (mPhase == Phase::Mark && heap && !r->GC_IsMarked())
+			ShadeObject(r);
 		mRoots[std::string{ key }] = r;
 		return true;
 	}
 	
 	bool Heap::RemoveRoot(std::string_view key)
 	{
+		std::unique_lock lock{ mHeapMutex };
 		if (const auto it = mRoots.find(key); it != mRoots.end())
 		{
 			mRoots.erase(it);
@@ -132,6 +468,7 @@ namespace Reflector
 
 	Reflectable* Heap::GetRoot(std::string_view key)
 	{
+		std::unique_lock lock{ mHeapMutex };
 		if (const auto it = mRoots.find(key); it != mRoots.end())
 			return it->second;
 		return nullptr;
@@ -139,13 +476,24 @@ namespace Reflector
 	
 	void Heap::ClearRoots()
 	{
+		std::unique_lock lock{ mHeapMutex };
 		mRoots.clear();
 	}
 
 
-	std::unordered_set<Reflectable*> const& Heap::Objects()
+	std::span<HeapPage* const> Heap::PagesOf(Class const* klass) const
+	{
+		if (const auto it = mClassPages.find(klass); it != mClassPages.end())
+			return it->second;
+		return {};
+	}
+
+	size_t Heap::ObjectCount() const
 	{
-		return mExtantObjects;
+		size_t result = 0;
+		for (auto page : mPages)
+			result += page->LiveCount;
+		return result;
 	}
 
 	/*
@@ -159,58 +507,229 @@ namespace Reflector
 
 	void Heap::MinimizeMemory()
 	{
-		for (auto const& [klass, vec] : mFreeLists)
+		/// The pages of the calling thread can only be freed once it gives them up
+		ReleaseAllocationPages(ThreadBuffer());
+		for (size_t i = mPages.size(); i > 0; --i)
 		{
-			for (auto& obj : vec)
-				AlignedFree(obj);
+			if (const auto page = mPages[i - 1]; page->LiveCount == 0 && !page->Owned)
+				FreePage(page);
 		}
-		mFreeLists.clear();
-		mFreeListBytes = 0;
+
+		std::erase_if(mAvailablePages, [](auto const& kvp) { return kvp.second.empty(); });
+		for (auto& [klass, pages] : mAvailablePages)
+			pages.shrink_to_fit();
+		std::erase_if(mClassPages, [](auto const& kvp) { return kvp.second.empty(); });
+		for (auto& [klass, pages] : mClassPages)
+			pages.shrink_to_fit();
+		mPages.shrink_to_fit();
+		mGrayObjects.shrink_to_fit();
+		mRememberedObjects.shrink_to_fit();
+	}
+
+	size_t Heap::AllocatedBytes() const
+	{
+		std::unique_lock lock{ mHeapMutex };
+		return mAllocatedBytes;
 	}
 
-	void Heap::Clear()
+	void Heap::Clear(bool run_destructors)
 	{
-		for (auto& obj : mExtantObjects)
+		for (auto page : mPages)
 		{
-			obj->~Reflectable();
-			AlignedFree(obj);
+			if (run_destructors)
+			{
+				for (auto obj : ObjectRange{ std::span{ &page, 1 } })
+					obj->~Reflectable();
+			}
+			page->~HeapPage();
+			AlignedFree(page);
 		}
-		MinimizeMemory();
 
-		mExtantObjects.clear();
+		mPages.clear();
+		mAvailablePages.clear();
+		mClassPages.clear();
+		mEpoch = ++Registry().NextID;
+		mGrayObjects.clear();
+		mRememberedObjects.clear();
+		mSweepCursor = 0;
+		mPhase = Phase::Idle;
 		mRoots.clear();
+		mFreedPagesAllocationCount = 0;
+		mFreedPagesAllocationBytes = 0;
+		mPinnedObjects.clear();
 		
 		mAllocatedBytes = 0;
 	}
 
-	Reflectable* Heap::Alloc(Class const* klass_data)
+	HeapPage* Heap::NewPage(Class const* klass_data)
+	{
+		const auto alignment = std::max(klass_data->Alignment, alignof(HeapPage));
+		if (alignment > HeapPage::Size)
+			throw UserError{ std::format("Class '{}' is over-aligned and cannot be allocated on the GC heap", klass_data->FullType) };
+
+		const auto align_up = [](size_t value, size_t alignment) { return (value + alignment - 1) / alignment * alignment; };
+		const auto first_slot_offset = align_up(sizeof(HeapPage), alignment);
+		const auto slot_size = align_up(std::max(klass_data->Size, size_t{ 1 }), alignment);
+		auto slot_count = std::min((HeapPage::Size - first_slot_offset) / slot_size, HeapPage::MaxSlots);
+		auto allocation_size = HeapPage::Size;
+		if (slot_count == 0)
+		{
+			slot_count = 1;
+			allocation_size = align_up(first_slot_offset + slot_size, HeapPage::Size);
+		}
+
+		const auto memory = AlignedAlloc(HeapPage::Size, allocation_size);
+		if (!memory)
+			throw std::bad_alloc{};
+
+		const auto page = new (memory) HeapPage{};
+		page->ParentHeap = this;
+		page->Klass = klass_data;
+		page->SlotSize = slot_size;
+		page->FirstSlotOffset = first_slot_offset;
+		page->AllocationSize = allocation_size;
+		page->SlotCount = uint32_t(slot_count);
+		page->Index = uint32_t(mPages.size());
+		mPages.push_back(page);
+		auto& class_pages = mClassPages[klass_data];
+		page->ClassIndex = uint32_t(class_pages.size());
+		class_pages.push_back(page);
+		mAllocatedBytes += allocation_size;
+		return page;
+	}
+
+	void Heap::FreePage(HeapPage* page)
+	{
+		/// Moves the last page into the freed page's place; when sweeping, it will have been swept already
+		const auto last = mPages.back();
+		last->Index = page->Index;
+		mPages[page->Index] = last;
+		mPages.pop_back();
+
+		auto& class_pages = mClassPages[page->Klass];
+		const auto last_of_class = class_pages.back();
+		last_of_class->ClassIndex = page->ClassIndex;
+		class_pages[page->ClassIndex] = last_of_class;
+		class_pages.pop_back();
+
+		if (page->Available)
+			std::erase(mAvailablePages[page->Klass], page);
+
+		mFreedPagesAllocationCount += page->AllocationCount;
+		mFreedPagesAllocationBytes += page->AllocationCount * page->Klass->Size;
+		mAllocatedBytes -= page->AllocationSize;
+		page->~HeapPage();
+		AlignedFree(page);
+	}
+
+	/// Gives up the (full) page the thread was allocating objects of this class from, and takes another one
+	HeapPage* Heap::TakeAllocationPage(Class const* klass_data, HeapPage* full_page)
 	{
-		void* result_alloc = nullptr;
+		std::unique_lock lock{ mHeapMutex };
+		if (full_page)
+			full_page->Owned = false;
 
-		if (const auto listit = mFreeLists.find(klass_data); listit != mFreeLists.end() && !listit->second.empty())
+		HeapPage* page = nullptr;
+		if (auto& available = mAvailablePages[klass_data]; !available.empty())
 		{
-			result_alloc = listit->second.back();
-			listit->second.pop_back();
+			page = available.back();
+			available.pop_back();
+			page->Available = false;
+			++mPagesReused;
 		}
 		else
 		{
-			result_alloc = klass_data->Alloc();
+			page = NewPage(klass_data);
+			++mPagesCreated;
+		}
+		page->Owned = true;
+		return page;
+	}
+
+	void Heap::ReleaseAllocationPages(AllocationBuffer& buffer)
+	{
+		std::unique_lock lock{ mHeapMutex };
+		if (buffer.Epoch == mEpoch)
+		{
+			for (auto const& [klass, page] : buffer.Pages)
+			{
+				page->Owned = false;
+				if (page->LiveCount < page->SlotCount)
+				{
+					page->Available = true;
+					mAvailablePages[klass].push_back(page);
+				}
+			}
+		}
+		buffer.Pages.clear();
+	}
+
+	Heap::AllocationBuffer& Heap::ThreadBuffer()
+	{
+		auto& buffers = mThreadBuffers;
+		if (buffers.LastHeap != this)
+		{
+			buffers.LastBuffer = &buffers.Buffers[this];
+			buffers.LastHeap = this;
 		}
 
+		auto& buffer = *buffers.LastBuffer;
+		/// The buffer might have been left behind by a destroyed heap at the same address
+		if (buffer.HeapID != mID)
+			buffer = AllocationBuffer{ .HeapID = mID, .Epoch = mEpoch, .Attached = false, .Pages = {} };
+		else if (buffer.Epoch != mEpoch)
+		{
+			buffer.Pages.clear();
+			buffer.Epoch = mEpoch;
+		}
+		return buffer;
+	}
+
+	Reflectable* Heap::Alloc(Class const* klass_data)
+	{
+		auto& page = ThreadBuffer().Pages[klass_data];
+		if (!page || page->LiveCount == page->SlotCount)
+			page = TakeAllocationPage(klass_data, page);
+
+		size_t slot = 0;
+		for (size_t word = 0; ; ++word)
+		{
+			if (const auto free_bits = ~page->LiveBits[word])
+			{
+				slot = word * 64 + std::countr_zero(free_bits);
+				break;
+			}
+		}
+		assert(slot < page->SlotCount);
+
+		page->LiveBits[slot / 64] |= 1ULL << (slot % 64);
+		++page->LiveCount;
+		++page->AllocationCount;
+
+		/// Objects created while marking are marked, so they survive the sweep; `Add` makes them gray, as their constructors
+		/// might have stored pointers to white objects. Objects created while sweeping are marked only if their page hasn't been swept yet
+		if (mPhase == Phase::Mark || (mPhase == Phase::Sweep && page->NeedsSweep))
+			page->Mark(slot);
+		else
+			page->HasYoungObjects = true;
+
+		const auto result_alloc = page->SlotAt(slot);
 		::memset(result_alloc, 0, klass_data->Size);
-		return new (result_alloc) Reflectable(*klass_data, (1ULL << int(Reflectable::Flags::OnHeap)));
+		const auto result = new (result_alloc) Reflectable(*klass_data, (1ULL << int(Reflectable::Flags::OnHeap)));
+		result->mHeapIndex = uint32_t(slot);
+		return result;
 	}
 
 #if REFLECTOR_USES_JSON && defined(NLOHMANN_JSON_NAMESPACE_BEGIN)
 
-	REFLECTOR_JSON_TYPE Heap::ToJson()
+	REFLECTOR_JSON_TYPE Heap::ToJson() const
 	{
 		using json = REFLECTOR_JSON_TYPE;
 		json j = json::object();
 		auto& roots = j["Roots"] = json::object();
 		auto& objects = j["Objects"] = json::array();
 
-		for (auto obj : mExtantObjects)
+		for (auto obj : Objects())
 		{
 			auto& j2 = objects.emplace_back();
 			j2["$id"] = reinterpret_cast<intptr_t>(obj);
@@ -226,17 +745,19 @@ namespace Reflector
 
 	void Heap::FromJson(REFLECTOR_JSON_TYPE const& j)
 	{
-		mLoadingHeap = true;
+		mLoadingHeap = this;
 
 		Clear();
 
 		mLoadingMapping.clear();
+		std::unordered_set<intptr_t> object_ids;
 
 		/// Go through all serialized objects, alloc/construct them if necessary, and load their data.
 		for (auto& obj_data : j.at("Objects"))
 		{
 			const intptr_t id = obj_data.at("$id");
-			std::string_view type = obj_data.at("$type");
+			object_ids.insert(id);
+			std::string_view type = obj_data.at("$type").template get_ref<typename REFLECTOR_JSON_TYPE::string_t const&>();
 			auto klass = FindClassByFullType(type);
 			assert(klass);
 
@@ -263,7 +784,7 @@ namespace Reflector
 		/// these objects, just in case, and let the GC and the user sort'em out.
 		for (auto& [id, mapping] : mLoadingMapping)
 		{
-			if (mExtantObjects.contains(mapping.first))
+			if (object_ids.contains(id))
 				continue;
 
 			const auto klass = mapping.second;
@@ -276,11 +797,11 @@ namespace Reflector
 		for (auto& [name, id] : j.at("Roots").items())
 			mRoots[name] = mLoadingMapping.at(id).first;
 
-		mLoadingHeap = false;
+		mLoadingHeap = nullptr;
 	}
 
 
-	void Heap::ResolveHeapObject(Class const* base_type, Reflectable const*& p, std::string_view obj_type, intptr_t obj_id)
+	void Heap::ResolveObject(Class const* base_type, Reflectable const*& p, std::string_view obj_type, intptr_t obj_id)
 	{
 		const auto actual_type = FindClassByFullType(obj_type);
 		assert(actual_type);
@@ -288,7 +809,7 @@ namespace Reflector
 		/// TODO: assert(base_type->IsDerivedFrom(actual_type));
 
 		Reflectable* obj = nullptr;
-		if (mLoadingHeap)
+		if (mLoadingHeap == this)
 		{
 			if (const auto it = mLoadingMapping.find(obj_id); it != mLoadingMapping.end())
 			{
@@ -302,7 +823,14 @@ namespace Reflector
 		}
 		else
 		{
-			if (const auto it = mExtantObjects.find(reinterpret_cast<Reflectable*>(obj_id)); it != mExtantObjects.end())
+			/// We can't dereference the pointer before we know it's valid, but we can check if it points to a live slot of one of our pages
+			const auto page = HeapPage::Of(reinterpret_cast<void const*>(obj_id));
+			const auto offset = size_t(obj_id - reinterpret_cast<intptr_t>(page));
+			if (std::ranges::find(mPages, page) != mPages.end()
+				&& offset >= page->FirstSlotOffset
+				&& (offset - page->FirstSlotOffset) % page->SlotSize == 0
+				&& (offset - page->FirstSlotOffset) / page->SlotSize < page->SlotCount
+				&& page->IsLive((offset - page->FirstSlotOffset) / page->SlotSize))
 			{
 				obj = reinterpret_cast<Reflectable*>(obj_id);
 				assert(obj->GetReflectionData().FullType == obj_type);
@@ -317,45 +845,921 @@ namespace Reflector
 		p = obj;
 	}
 
+#endif
+
+#if defined(REFLECTOR_USES_BINARY) && REFLECTOR_USES_BINARY
+
+	/// Snapshot layout, after the magic and version:
+	/// - class group count, followed by each group's class id (`BinaryClassID`, fixed64) and object count
+	/// - root count, followed by each root's name and object index
+	/// - the fields of each object, length-delimited, in group order
+	/// Groups are ordered by class name, and objects by page and slot within their group; objects are indexed in that order.
+	inline constexpr uint8_t SnapshotFormatMagic[4] = { 'R', 'F', 'L', 'S' };
+	inline constexpr uint32_t SnapshotFormatVersion = 1;
+
+	static void SnapshotFlush(std::ostream& out, BinaryWriter& writer)
+	{
+		out.write(reinterpret_cast<char const*>(writer.Buffer.data()), std::streamsize(writer.Buffer.size()));
+		writer.Buffer.clear();
+	}
+
+	static void SnapshotRead(std::istream& in, void* dest, size_t size)
+	{
+		if (!in.read(static_cast<char*>(dest), std::streamsize(size)))
+			throw DataError{ "Unexpected end of heap snapshot" };
+	}
+
+	static uint64_t SnapshotReadVarint(std::istream& in)
+	{
+		uint64_t result = 0;
+		for (int shift = 0; shift < 64; shift += 7)
+		{
+			uint8_t byte = 0;
+			SnapshotRead(in, &byte, 1);
+			result |= uint64_t(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return result;
+		}
+		throw DataError{ "Malformed varint in heap snapshot" };
+	}
+
+	/// Returns the number of bytes left in the stream, or nothing if the stream can't tell
+	static std::optional<uint64_t> SnapshotRemainingSize(std::istream& in)
+	{
+		const auto position = in.tellg();
+		if (position == std::istream::pos_type(-1))
+			return std::nullopt;
+		in.seekg(0, std::ios::end);
+		const auto end = in.tellg();
+		in.clear();
+		in.seekg(position);
+		if (end == std::istream::pos_type(-1) || !in)
+			return std::nullopt;
+		return uint64_t(end - position);
+	}
+
+	/// Counts and lengths are checked against the size of the snapshot before anything is allocated for them,
+	/// so that corrupted snapshots can't make us allocate huge amounts of memory
+	static uint64_t SnapshotReadCount(std::istream& in, uint64_t limit)
+	{
+		const auto count = SnapshotReadVarint(in);
+		if (count > limit)
+			throw DataError{ std::format("Heap snapshot is corrupted: count {} exceeds the size of the snapshot", count) };
+		return count;
+	}
+
+	void Heap::SaveSnapshot(std::ostream& out)
+	{
+		/// The groups are sorted so that the same heap always gives the same snapshot
+		std::vector<std::pair<Class const*, uint64_t>> groups;
+		for (auto const& [klass, pages] : mClassPages)
+		{
+			uint64_t count = 0;
+			for (auto page : pages)
+				count += page->LiveCount;
+			if (count > 0)
+				groups.emplace_back(klass, count);
+		}
+		std::ranges::sort(groups, {}, [](auto const& group) { return std::string_view{ group.first->FullType }; });
+
+		/// Objects are written in page and slot order, so their indices can be computed from their slots (see `SnapshotIndexOf`)
+		tSnapshotHeap = this;
+		tSnapshotWordIndices.assign(mPages.size() * HeapPage::BitmapWords, 0);
+		uint64_t next_index = 0;
+		for (auto const& [klass, count] : groups)
+		{
+			for (auto page : PagesOf(klass))
+			{
+				for (size_t word = 0; word * 64 < page->SlotCount; ++word)
+				{
+					tSnapshotWordIndices[page->Index * HeapPage::BitmapWords + word] = next_index;
+					next_index += std::popcount(page->LiveBits[word]);
+				}
+			}
+		}
+
+		BinaryWriter writer;
+		try
+		{
+			writer.WriteBytes(SnapshotFormatMagic);
+			writer.WriteVarint(SnapshotFormatVersion);
+			writer.WriteVarint(groups.size());
+			for (auto const& [klass, count] : groups)
+			{
+				writer.WriteFixed64(BinaryClassID(klass->FullType));
+				writer.WriteVarint(count);
+			}
+			writer.WriteVarint(mRoots.size());
+			for (auto const& [name, obj] : mRoots)
+			{
+				BinarySerializer<std::string>::Write(writer, name);
+				writer.WriteVarint(SnapshotIndexOf(obj));
+			}
+			SnapshotFlush(out, writer);
+
+			for (auto const& [klass, count] : groups)
+			{
+				for (auto obj : ObjectRange{ PagesOf(klass) })
+				{
+					const auto start = writer.BeginLengthDelimited();
+					obj->BinarySaveFields(writer);
+					writer.EndLengthDelimited(start);
+					SnapshotFlush(out, writer);
+				}
+			}
+		}
+		catch (...)
+		{
+			tSnapshotHeap = nullptr;
+			tSnapshotWordIndices.clear();
+			throw;
+		}
+		tSnapshotHeap = nullptr;
+		tSnapshotWordIndices.clear();
+
+		if (!out)
+			throw UserError{ "Could not write heap snapshot" };
+	}
+
+	void Heap::LoadSnapshot(std::istream& in)
+	{
+		const auto snapshot_size = SnapshotRemainingSize(in);
+		if (!snapshot_size)
+		{
+			/// Streams that can't tell their size are read into memory first, so that the counts can be checked
+			std::stringstream buffered;
+			buffered << in.rdbuf();
+			buffered.clear();
+			return LoadSnapshot(buffered);
+		}
+
+		uint8_t magic[sizeof(SnapshotFormatMagic)]{};
+		SnapshotRead(in, magic, sizeof(magic));
+		if (!std::ranges::equal(magic, SnapshotFormatMagic))
+			throw DataError{ "Not a reflector heap snapshot" };
+		if (const auto version = SnapshotReadVarint(in); version > SnapshotFormatVersion)
+			throw DataError{ std::format("Heap snapshot has format version {}, only versions up to {} are supported", version, SnapshotFormatVersion) };
+
+		/// Each group takes at least 9 bytes, and each object at least 1 (its length)
+		std::vector<std::pair<Class const*, uint64_t>> groups(SnapshotReadCount(in, *snapshot_size / 9));
+		uint64_t object_count = 0;
+		for (auto& [klass, count] : groups)
+		{
+			uint8_t class_id[8]{};
+			SnapshotRead(in, class_id, sizeof(class_id));
+			klass = FindClassByBinaryID(BinaryReader{ class_id }.ReadFixed64());
+			if (!klass)
+				throw DataError{ "Heap snapshot contains objects of an unknown class" };
+			count = SnapshotReadCount(in, *snapshot_size - object_count);
+			object_count += count;
+		}
+
+		/// The snapshot is loaded into a separate heap, whose contents replace ours only once it's fully loaded,
+		/// so that an invalid snapshot leaves the heap as it was
+		Heap staging;
+
+		/// Create all the objects up-front, so that pointers between them can be resolved while loading
+		tSnapshotObjects.clear();
+		tSnapshotObjects.reserve(object_count);
+		try
+		{
+			for (auto const& [klass, count] : groups)
+			{
+				for (uint64_t i = 0; i < count; ++i)
+				{
+					const auto obj = staging.Alloc(klass);
+					klass->DefaultPlacementConstructor(obj);
+					tSnapshotObjects.push_back(staging.Add(obj));
+				}
+			}
+
+			for (auto root_count = SnapshotReadVarint(in); root_count > 0; --root_count)
+			{
+				std::string name(SnapshotReadCount(in, *snapshot_size), '\0');
+				SnapshotRead(in, name.data(), name.size());
+				staging.mRoots[std::move(name)] = SnapshotObjectAt(SnapshotReadVarint(in));
+			}
+
+			std::vector<uint8_t> buffer;
+			for (auto obj : tSnapshotObjects)
+			{
+				buffer.resize(SnapshotReadCount(in, *snapshot_size));
+				SnapshotRead(in, buffer.data(), buffer.size());
+				obj->BinaryLoadFields(BinaryObject{ buffer });
+			}
+		}
+		catch (...)
+		{
+			tSnapshotObjects.clear();
+			throw;
+		}
+		tSnapshotObjects.clear();
+
+		Clear();
+		TakeContents(staging);
+	}
+
+	void Heap::TakeContents(Heap& other)
+	{
+		other.ReleaseAllocationPages(other.ThreadBuffer());
+		for (auto page : other.mPages)
+			page->ParentHeap = this;
+
+		/// The page lists are empty, as the heap was just cleared, so the pages keep their indices
+		mPages = std::exchange(other.mPages, {});
+		mAvailablePages = std::exchange(other.mAvailablePages, {});
+		mClassPages = std::exchange(other.mClassPages, {});
+		mRoots = std::exchange(other.mRoots, {});
+		mAllocatedBytes = std::exchange(other.mAllocatedBytes, 0);
+		mPagesCreated += other.mPagesCreated;
+		other.mEpoch = ++Registry().NextID;
+	}
+
+	uint64_t Heap::SnapshotIndexOf(Reflectable const* obj)
+	{
+		const auto page = (obj && obj->GC_IsOnHeap()) ? HeapPage::Of(obj) : nullptr;
+		if (!page || page->ParentHeap != tSnapshotHeap || !page->IsLive(obj->mHeapIndex))
+			throw UserError{ "Pointers to heap objects can only be saved as part of a heap snapshot, and must point to objects on the heap" };
+		const auto slot = obj->mHeapIndex;
+		return tSnapshotWordIndices[page->Index * HeapPage::BitmapWords + slot / 64] + std::popcount(page->LiveBits[slot / 64] & ((1ULL << (slot % 64)) - 1));
+	}
+
+	Reflectable* Heap::SnapshotObjectAt(uint64_t index)
+	{
+		if (index >= tSnapshotObjects.size())
+			throw DataError{ std::format("Heap snapshot object index {} is out of range", index) };
+		return tSnapshotObjects[index];
+	}
+
 #endif
 
 	Reflectable* Heap::Add(Reflectable* obj)
 	{
 		obj->mFlags |= 1ULL<<int(Reflectable::Flags::OnHeap);
-		mExtantObjects.insert(obj);
+		/// The constructor of the object might have overwritten the slot index set by `Alloc`
+		const auto page = HeapPage::Of(obj);
+		obj->mHeapIndex = uint32_t((reinterpret_cast<uintptr_t>(obj) - reinterpret_cast<uintptr_t>(page) - page->FirstSlotOffset) / page->SlotSize);
+
+		/// The fields of objects created while marking still have to be traced, as the write barriers don't see the stores
+		/// made by the constructor
+		if (mPhase == Phase::Mark)
+		{
+			std::unique_lock lock{ mHeapMutex };
+			if (mPhase == Phase::Mark && !obj->GC_IsGray())
+			{
+				obj->mFlags |= 1U << int(Reflectable::Flags::Gray);
+				mGrayObjects.push_back(obj);
+			}
+		}
 		return obj;
 	}
 
-	void Heap::Mark()
+	void Heap::Shade(Reflectable const* obj)
+	{
+		/// Pointers to objects on other heaps are not followed
+		if (const auto heap = HeapPage::Of(obj)->ParentHeap; heap == mMarkingHeap)
+			heap->ShadeObject(obj);
+	}
+
+	void Heap::ShadeObject(Reflectable const* obj)
+	{
+		/// Parallel marking doesn't need the gray flag, as there are no write barriers during a full collection
+		const auto page = HeapPage::Of(obj);
+		if (tMarkWorker)
+		{
+			/// Another thread might have marked the object since we checked
+			if (page->Mark(obj->mHeapIndex))
+				tMarkWorker->Push(obj);
+			return;
+		}
+		page->Mark(obj->mHeapIndex);
+		obj->mFlags |= 1U << int(Reflectable::Flags::Gray);
+		mGrayObjects.push_back(obj);
+	}
+
+	void Heap::ShadeFromMutator(Reflectable const* obj)
+	{
+		const auto heap = HeapPage::Of(obj)->ParentHeap;
+		std::unique_lock lock{ heap->mHeapMutex };
+		if (!obj->GC_IsGray())
+			heap->ShadeObject(obj);
+	}
+
+	void Heap::RememberFromMutator(Reflectable const* obj)
+	{
+		const auto heap = HeapPage::Of(obj)->ParentHeap;
+		std::unique_lock lock{ heap->mHeapMutex };
+		if (!obj->GC_IsDirty())
+		{
+			std::atomic_ref{ obj->mFlags }.fetch_or(1U << int(Reflectable::Flags::Dirty), std::memory_order_relaxed);
+			heap->mRememberedObjects.push_back(obj);
+		}
+	}
+
+	void Heap::ForgetRememberedObjects()
+	{
+		for (auto obj : mRememberedObjects)
+			obj->mFlags &= ~(1U << int(Reflectable::Flags::Dirty));
+		mRememberedObjects.clear();
+	}
+
+	size_t Heap::RememberedObjectCount() const
+	{
+		std::unique_lock lock{ mHeapMutex };
+		return mRememberedObjects.size();
+	}
+
+	void Heap::AttachThread()
+	{
+		auto& buffer = ThreadBuffer();
+		if (buffer.Attached)
+			return;
+		std::unique_lock lock{ mSafepointMutex };
+		mSafepointCondition.wait(lock, [this] { return !mStopRequested.load(); });
+		++mAttachedThreads;
+		buffer.Attached = true;
+	}
+
+	void Heap::DetachThread()
+	{
+		Detach(ThreadBuffer());
+	}
+
+	void Heap::Detach(AllocationBuffer& buffer)
+	{
+		ReleaseAllocationPages(buffer);
+		if (!buffer.Attached)
+			return;
+		std::unique_lock lock{ mSafepointMutex };
+		--mAttachedThreads;
+		buffer.Attached = false;
+		mSafepointCondition.notify_all();
+	}
+
+	void Heap::ParkAtSafepoint()
+	{
+		if (!ThreadBuffer().Attached)
+			return;
+		std::unique_lock lock{ mSafepointMutex };
+		++mParkedThreads;
+		mSafepointCondition.notify_all();
+		mSafepointCondition.wait(lock, [this] { return !mStopRequested.load(); });
+		--mParkedThreads;
+	}
+
+	void Heap::EnterSafeRegion()
+	{
+		if (!ThreadBuffer().Attached)
+			return;
+		std::unique_lock lock{ mSafepointMutex };
+		++mParkedThreads;
+		mSafepointCondition.notify_all();
+	}
+
+	void Heap::LeaveSafeRegion()
+	{
+		if (!ThreadBuffer().Attached)
+			return;
+		std::unique_lock lock{ mSafepointMutex };
+		mSafepointCondition.wait(lock, [this] { return !mStopRequested.load(); });
+		--mParkedThreads;
+	}
+
+	void Heap::StopTheWorld()
 	{
+		const auto attached = ThreadBuffer().Attached;
+		std::unique_lock lock{ mSafepointMutex };
+		/// We count as parked while waiting for another thread to resume the world, and while we have it stopped
+		if (attached)
+		{
+			++mParkedThreads;
+			mSafepointCondition.notify_all();
+		}
+		mSafepointCondition.wait(lock, [this] { return !mStopRequested.load(); });
+		mStopRequested.store(true);
+		mSafepointCondition.wait(lock, [this] { return mParkedThreads == mAttachedThreads; });
+	}
+
+	void Heap::ResumeTheWorld()
+	{
+		const auto attached = ThreadBuffer().Attached;
+		std::unique_lock lock{ mSafepointMutex };
+		mStopRequested.store(false);
+		if (attached)
+			--mParkedThreads;
+		mSafepointCondition.notify_all();
+	}
+
+	void Heap::SetMarkThreadCount(size_t count)
+	{
+		mMarkThreadCount = std::max(count, size_t{ 1 });
+	}
+
+	size_t Heap::MarkThreadCount() const
+	{
+		return mMarkThreadCount;
+	}
+
+	void Heap::MarkAll()
+	{
+		if (mMarkThreadCount > 1 && mGrayObjects.size() > 1)
+		{
+			StatisticsTimer timer{ mCurrentCollection.MarkTime };
+			ParallelMark(mMarkThreadCount);
+		}
+		else
+		{
+			size_t budget = std::numeric_limits<size_t>::max();
+			MarkStep(budget);
+		}
+	}
+
+	void Heap::ParallelMark(size_t thread_count)
+	{
+		std::vector<MarkWorker> workers(thread_count);
+
+		/// Partition the gray objects (the roots) between the workers
+		for (size_t i = 0; i < mGrayObjects.size(); ++i)
+			workers[i % thread_count].Local.push_back(mGrayObjects[i]);
+		mGrayObjects.clear();
+
+		std::atomic<size_t> active_workers = thread_count;
+		const auto work = [&](MarkWorker& self) {
+			tMarkWorker = &self;
+			MarkingScope marking{ *this };
+			for (;;)
+			{
+				while (!self.Local.empty() || self.TakeFrom(self))
+				{
+					const auto obj = self.Local.back();
+					self.Local.pop_back();
+					std::atomic_ref{ obj->mFlags }.fetch_and(~(1U << int(Reflectable::Flags::Gray)), std::memory_order_relaxed);
+					MarkFields(obj);
+				}
+
+				if (std::ranges::any_of(workers, [&](MarkWorker& victim) { return self.TakeFrom(victim); }))
+					continue;
+
+				/// We're out of work; wait until someone shares some, or until everyone is out of work
+				active_workers.fetch_sub(1);
+				bool found_work = false;
+				while (!found_work)
+				{
+					if (std::ranges::any_of(workers, [](MarkWorker& victim) { return victim.SharedSize.load() > 0; }))
+					{
+						active_workers.fetch_add(1);
+						found_work = std::ranges::any_of(workers, [&](MarkWorker& victim) { return self.TakeFrom(victim); });
+						if (found_work)
+							break;
+						active_workers.fetch_sub(1);
+					}
+					if (active_workers.load() == 0)
+					{
+						tMarkWorker = nullptr;
+						return;
+					}
+					std::this_thread::yield();
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count - 1);
+		for (size_t i = 1; i < thread_count; ++i)
+			threads.emplace_back(work, std::ref(workers[i]));
+		work(workers[0]);
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	void Heap::StartCycle()
+	{
+		StartCollectionStatistics(false);
+		StatisticsTimer timer{ mCurrentCollection.MarkTime };
+
+		/// A full collection starts with all objects white; the old objects are all marked again anyway
+		for (auto page : mPages)
+		{
+			std::ranges::fill(page->MarkBits, 0);
+			page->HasYoungObjects = true;
+		}
+		ForgetRememberedObjects();
+
+		mPhase = Phase::Mark;
 		for (auto const& [name, root] : mRoots)
+			Reflector::GCMark(root);
+	}
+
+	void Heap::StartMinorCycle()
+	{
+		StartCollectionStatistics(true);
+		StatisticsTimer timer{ mCurrentCollection.MarkTime };
+		mPhase = Phase::Mark;
+		for (auto const& [name, root] : mRoots)
+			Reflector::GCMark(root);
+
+		/// Old objects are already marked, so they're not traced from the roots; the ones that were modified since the last
+		/// collection are made gray, so that the young objects they point to get marked
+		for (auto obj : mRememberedObjects)
 		{
-			GCMark(root);
+			obj->mFlags = (obj->mFlags & ~(1U << int(Reflectable::Flags::Dirty))) | (1U << int(Reflectable::Flags::Gray));
+			mGrayObjects.push_back(obj);
 		}
+		mRememberedObjects.clear();
 	}
 
-	void Heap::Delete(Reflectable* ptr)
+	void Heap::MarkFields(Reflectable const* obj)
 	{
-		const auto klass_data = &ptr->GetReflectionData();
-		mFreeLists[klass_data].push_back(ptr);
-		ptr->~Reflectable();
+		auto const& map = obj->GCGetPointerMap();
+		if (&map == &Reflectable::GCEmptyPointerMap())
+		{
+			obj->GCMark();
+			return;
+		}
+
+		const auto object = reinterpret_cast<char const*>(obj);
+		for (auto const& entry : map.Entries)
+		{
+			if (entry.Kind == GCPointerMap::EntryKind::Pointer)
+				Reflector::GCMark(entry.Functions->LoadPointer(object + entry.Offset));
+			else
+				entry.Functions->MarkElements(object + entry.Offset);
+		}
+
+		/// Fields that the map can't describe get marked through the `GCMark` overloads
+		if (!map.Complete)
+			obj->GCMarkUnmapped();
+	}
+
+	bool Heap::MarkStep(size_t& work_budget)
+	{
+		StatisticsTimer timer{ mCurrentCollection.MarkTime };
+		while (!mGrayObjects.empty())
+		{
+			if (work_budget == 0)
+				return false;
+			--work_budget;
+
+			const auto obj = mGrayObjects.back();
+			mGrayObjects.pop_back();
+			obj->mFlags &= ~(1ULL << int(Reflectable::Flags::Gray));
+			MarkFields(obj);
+		}
+
+		/// All reachable objects are black; objects created from now on in swept pages will not be swept in this cycle, so they are white
+		mPhase = Phase::Sweep;
+		for (auto page : mPages)
+			page->NeedsSweep = true;
+		mSweepCursor = mPages.size();
+		return true;
+	}
+
+	bool Heap::SweepStep(size_t& work_budget)
+	{
+		{
+			StatisticsTimer timer{ mCurrentCollection.SweepTime };
+			while (mSweepCursor > 0)
+			{
+				if (work_budget == 0)
+					return false;
+
+				const auto page = mPages[--mSweepCursor];
+				work_budget -= std::min(work_budget, std::max(size_t{ page->LiveCount }, size_t{ 1 }));
+				SweepPage(page);
+			}
+		}
+
+		mPhase = Phase::Idle;
+		FinishCollectionStatistics();
+		return true;
+	}
+
+	/// Destroys the live objects that weren't marked, and frees the page if it's left empty.
+	/// The survivors are left marked, which makes them old.
+	void Heap::SweepPage(HeapPage* page)
+	{
+		page->NeedsSweep = false;
+		auto& class_statistics = mCurrentCollection.Classes[page->Klass];
+		if (!page->HasYoungObjects)
+		{
+			class_statistics.Survivors += page->LiveCount;
+			return;
+		}
+		page->HasYoungObjects = false;
+
+		uint32_t live_count = 0;
+		for (size_t word = 0; word * 64 < page->SlotCount; ++word)
+		{
+			for (auto dead = page->LiveBits[word] & ~page->MarkBits[word]; dead; dead &= dead - 1)
+				Delete(static_cast<Reflectable*>(page->SlotAt(word * 64 + std::countr_zero(dead))));
+			page->LiveBits[word] &= page->MarkBits[word];
+			live_count += std::popcount(page->LiveBits[word]);
+		}
+		class_statistics.Freed += page->LiveCount - live_count;
+		class_statistics.Survivors += live_count;
+		page->LiveCount = live_count;
+
+		/// Pages owned by threads are kept, even when empty, as the threads will keep allocating from them
+		if (page->Owned)
+			return;
+		if (live_count == 0)
+			FreePage(page);
+		else if (live_count < page->SlotCount && !page->Available)
+		{
+			page->Available = true;
+			mAvailablePages[page->Klass].push_back(page);
+		}
+	}
+
+	void Heap::StartCollectionStatistics(bool minor)
+	{
+		mCurrentCollection = {};
+		mCurrentCollection.Minor = minor;
+		mCurrentCollection.ObjectsAllocated = mFreedPagesAllocationCount;
+		mCurrentCollection.BytesAllocated = mFreedPagesAllocationBytes;
+		mFreedPagesAllocationCount = 0;
+		mFreedPagesAllocationBytes = 0;
+		for (auto page : mPages)
+		{
+			mCurrentCollection.ObjectsAllocated += page->AllocationCount;
+			mCurrentCollection.BytesAllocated += page->AllocationCount * page->Klass->Size;
+			page->AllocationCount = 0;
+		}
+	}
+
+	void Heap::FinishCollectionStatistics()
+	{
+		for (auto const& [klass, statistics] : mCurrentCollection.Classes)
+		{
+			mCurrentCollection.ObjectsFreed += statistics.Freed;
+			mCurrentCollection.BytesFreed += statistics.Freed * klass->Size;
+			mCurrentCollection.Survivors += statistics.Survivors;
+		}
 
+		++(mCurrentCollection.Minor ? mMinorCollectionCount : mCollectionCount);
+		mTotalObjectsFreed += mCurrentCollection.ObjectsFreed;
+		mLastCollection = std::move(mCurrentCollection);
+		mCurrentCollection = {};
+
+		if (mCollectionCallback)
+			mCollectionCallback(*this, mLastCollection);
+	}
+
+	HeapStatistics Heap::GetStatistics() const
+	{
+		std::unique_lock lock{ mHeapMutex };
+		HeapStatistics result{
+			.PageCount = mPages.size(),
+			.AllocatedBytes = mAllocatedBytes,
+			.ObjectCount = 0,
+			.LiveBytes = 0,
+			.FreeBytes = 0,
+			.ObjectsAllocatedSinceCollection = mFreedPagesAllocationCount,
+			.BytesAllocatedSinceCollection = mFreedPagesAllocationBytes,
+			.RememberedObjectCount = mRememberedObjects.size(),
+			.Collections = mCollectionCount,
+			.MinorCollections = mMinorCollectionCount,
+			.TotalObjectsFreed = mTotalObjectsFreed,
+			.TotalObjectsMoved = mTotalObjectsMoved,
+			.PagesReused = mPagesReused,
+			.PagesCreated = mPagesCreated,
+		};
+		for (auto page : mPages)
+		{
+			result.ObjectCount += page->LiveCount;
+			result.LiveBytes += page->LiveCount * page->SlotSize;
+			result.FreeBytes += (page->SlotCount - page->LiveCount) * page->SlotSize;
+			result.ObjectsAllocatedSinceCollection += page->AllocationCount;
+			result.BytesAllocatedSinceCollection += page->AllocationCount * page->Klass->Size;
+		}
+		return result;
+	}
+
+	void Heap::SetCollectionCallback(std::function<void(Heap&, CollectionStatistics const&)> callback)
+	{
+		mCollectionCallback = std::move(callback);
+	}
+
+	void Heap::Pin(Reflectable const* obj)
+	{
+		std::unique_lock lock{ mHeapMutex };
+		++mPinnedObjects[obj];
+	}
+
+	void Heap::Unpin(Reflectable const* obj)
+	{
+		std::unique_lock lock{ mHeapMutex };
+		if (const auto it = mPinnedObjects.find(obj); it != mPinnedObjects.end() && --it->second == 0)
+			mPinnedObjects.erase(it);
+	}
+
+	bool Heap::IsPinned(Reflectable const* obj) const
+	{
+		std::unique_lock lock{ mHeapMutex };
+		return mPinnedObjects.contains(obj);
+	}
+
+	size_t Heap::Compact(double max_occupancy)
+	{
+		Collect();
+
+		const auto unmovable = FindUnmovableObjects();
+		std::unordered_map<Reflectable const*, Reflectable*> moved;
+		for (auto const& [klass, pages] : mClassPages)
+			CompactClass(klass, unmovable, max_occupancy, moved);
+		if (moved.empty())
+			return 0;
+
+		UpdateMovedPointers(moved);
+		mTotalObjectsMoved += moved.size();
+
+		for (size_t i = mPages.size(); i > 0; --i)
+		{
+			if (const auto page = mPages[i - 1]; page->LiveCount == 0 && !page->Owned)
+				FreePage(page);
+		}
+
+		/// The pages objects were moved into might be full now
+		for (auto& [klass, pages] : mAvailablePages)
+			pages.clear();
+		for (auto page : mPages)
+		{
+			page->Available = !page->Owned && page->LiveCount < page->SlotCount;
+			if (page->Available)
+				mAvailablePages[page->Klass].push_back(page);
+		}
+
+		return moved.size();
+	}
+
+	/// Returns the pinned objects, and the objects pointed to by fields that pointer maps don't describe, as those pointers can't be updated
+	std::unordered_set<Reflectable const*> Heap::FindUnmovableObjects()
+	{
+		std::unordered_set<Reflectable const*> result;
+		for (auto const& [obj, count] : mPinnedObjects)
+			result.insert(obj);
+
+		/// With all mark bits cleared, marking the unmapped fields of all objects marks the objects they point to.
+		/// Classes without pointer maps might mark themselves as well, which only makes them unmovable.
+		for (auto page : mPages)
+			std::ranges::fill(page->MarkBits, 0);
+		MarkingScope marking{ *this };
+		for (auto obj : Objects())
+		{
+			if (auto const& map = obj->GCGetPointerMap(); &map == &Reflectable::GCEmptyPointerMap())
+				obj->GCMark();
+			else if (!map.Complete)
+				obj->GCMarkUnmapped();
+		}
+		for (auto obj : mGrayObjects)
+			obj->mFlags &= ~(1U << int(Reflectable::Flags::Gray));
+		mGrayObjects.clear();
+
+		for (auto obj : Objects())
+		{
+			if (obj->GC_IsMarked())
+				result.insert(obj);
+		}
+
+		/// All objects have just survived a collection, so they're all old
+		for (auto page : mPages)
+			std::ranges::copy(page->LiveBits, page->MarkBits);
+		return result;
+	}
+
+	/// Moves the objects of the class out of its sparsest pages, into its fullest ones
+	void Heap::CompactClass(Class const* klass, std::unordered_set<Reflectable const*> const& unmovable, double max_occupancy, std::unordered_map<Reflectable const*, Reflectable*>& moved)
+	{
+		if (!klass->Relocate)
+			return;
+
+		/// Pages that threads allocate from are left alone
+		std::vector<HeapPage*> pages;
+		for (auto page : PagesOf(klass))
+		{
+			if (!page->Owned)
+				pages.push_back(page);
+		}
+		std::ranges::sort(pages, std::greater{}, [](HeapPage const* page) { return page->LiveCount; });
+
+		size_t destination = 0;
+		for (size_t source = pages.size(); source > destination + 1; --source)
+		{
+			const auto from = pages[source - 1];
+			if (from->LiveCount > from->SlotCount * max_occupancy)
+				return;
+
+			for (size_t slot = from->NextLiveSlot(0); slot < from->SlotCount; slot = from->NextLiveSlot(slot + 1))
+			{
+				const auto obj = static_cast<Reflectable*>(from->SlotAt(slot));
+				if (unmovable.contains(obj))
+					continue;
+
+				while (pages[destination]->LiveCount == pages[destination]->SlotCount)
+				{
+					if (++destination == source - 1)
+						return;
+				}
+
+				const auto to = pages[destination];
+				size_t new_slot = 0;
+				for (size_t word = 0; ; ++word)
+				{
+					if (const auto free_bits = ~to->LiveBits[word])
+					{
+						new_slot = word * 64 + std::countr_zero(free_bits);
+						break;
+					}
+				}
+
+				const auto dest = to->SlotAt(new_slot);
+				::memset(dest, 0, klass->Size);
+				klass->Relocate(dest, obj);
+				const auto new_obj = static_cast<Reflectable*>(dest);
+				new_obj->mFlags = 1U << int(Reflectable::Flags::OnHeap);
+				new_obj->mHeapIndex = uint32_t(new_slot);
+				to->LiveBits[new_slot / 64] |= 1ULL << (new_slot % 64);
+				to->Mark(new_slot);
+				++to->LiveCount;
+
+				from->LiveBits[slot / 64] &= ~(1ULL << (slot % 64));
+				from->MarkBits[slot / 64] &= ~(1ULL << (slot % 64));
+				--from->LiveCount;
 #ifndef NDEBUG
-		std::memset(ptr, 0xFE, klass_data->Size);
+				std::memset(static_cast<void*>(obj), 0xFE, klass->Size);
 #endif
+				moved[obj] = new_obj;
+			}
+		}
 	}
 
-	void Heap::Sweep()
+	/// The objects moved by the compaction being done by the calling thread
+	thread_local std::unordered_map<Reflectable const*, Reflectable*> const* tMovedObjects = nullptr;
+
+	static Reflectable* MovedObject(Reflectable* obj)
 	{
-		std::erase_if(mExtantObjects, [](Reflectable* obj) {
-			if (obj->mFlags & (1ULL << int(Reflectable::Flags::Marked)))
+		if (const auto it = tMovedObjects->find(obj); it != tMovedObjects->end())
+			return it->second;
+		return obj;
+	}
+
+	void Heap::UpdateMovedPointers(std::unordered_map<Reflectable const*, Reflectable*> const& moved)
+	{
+		tMovedObjects = &moved;
+		for (auto obj : Objects())
+		{
+			const auto object = reinterpret_cast<char*>(obj);
+			for (auto const& entry : obj->GCGetPointerMap().Entries)
 			{
-				obj->mFlags &= ~(1ULL << int(Reflectable::Flags::Marked));
-				return false;
+				if (entry.Kind == GCPointerMap::EntryKind::Pointer)
+				{
+					if (const auto it = moved.find(entry.Functions->LoadPointer(object + entry.Offset)); it != moved.end())
+						entry.Functions->StorePointer(object + entry.Offset, it->second);
+				}
+				else
+					entry.Functions->UpdateElements(object + entry.Offset, &MovedObject);
 			}
-			Delete(obj);
-			return true;
-		});
+		}
+
+		for (auto& [name, root] : mRoots)
+		{
+			if (const auto it = moved.find(root); it != moved.end())
+				root = it->second;
+		}
+		tMovedObjects = nullptr;
+	}
+
+	bool Heap::Step(size_t work_budget)
+	{
+		MarkingScope marking{ *this };
+		if (mPhase == Phase::Idle)
+			StartCycle();
+		if (mPhase == Phase::Mark && !MarkStep(work_budget))
+			return false;
+		return SweepStep(work_budget);
+	}
+
+	bool Heap::Step(std::chrono::nanoseconds time_budget)
+	{
+		/// Checking the clock after every object would be too expensive
+		static constexpr size_t work_per_clock_check = 256;
+		const auto deadline = std::chrono::steady_clock::now() + time_budget;
+		do
+		{
+			if (Step(work_per_clock_check))
+				return true;
+		} while (std::chrono::steady_clock::now() < deadline);
+		return false;
+	}
+
+	void Heap::Delete(Reflectable* ptr)
+	{
+		const auto klass_data = &ptr->GetReflectionData();
+		ptr->~Reflectable();
+
+#ifndef NDEBUG
+		std::memset(ptr, 0xFE, klass_data->Size);
+#endif
 	}
 
 #endif
@@ -0,0 +1,745 @@
+#pragma once
+
+#if !(defined(REFLECTOR_USES_BINARY) && REFLECTOR_USES_BINARY)
+#error "ReflectorBinary.h requires binary serializers to be generated; include the generated Reflector.h first"
+#endif
+
+#include "ReflectorUtils.h"
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <unordered_map>
+
+/// Compact binary serialization of reflected classes.
+///
+/// The format is a sequence of tag-prefixed values, similar to protocol buffers:
+/// - each field is written as a varint tag (`field_id << 3 | wire_type`) followed by its value
+/// - field ids are derived from the save/load names of the fields (see `BinaryFieldID`), so they don't change when the source is rearranged
+/// - objects, strings and containers are length-delimited, so loaders can skip fields they don't know about
+/// - all multi-byte values are little-endian
+/// The `BinarySave`/`BinaryLoad` functions additionally write/check a small header with the format version.
+
+namespace Reflector
+{
+	/// Same as `FieldNameHash`, so the generated methods can share the ids with the other serializers
+	constexpr uint32_t BinaryFieldID(std::string_view name) noexcept
+	{
+		return FieldNameHash(name);
+	}
+
+	/// FNV-1a of the class's full type name; used to identify the actual class of polymorphic objects
+	constexpr uint64_t BinaryClassID(std::string_view full_type) noexcept
+	{
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (const char c : full_type)
+		{
+			hash ^= uint8_t(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	enum class BinaryWireType : uint8_t
+	{
+		Varint = 0,          /// bools, integers (zig-zag encoded if signed) and enums
+		Fixed64 = 1,         /// doubles
+		LengthDelimited = 2, /// strings, objects and containers
+		Fixed32 = 5,         /// floats
+	};
+
+	inline constexpr uint32_t BinaryFormatVersion = 1;
+	inline constexpr uint8_t BinaryFormatMagic[4] = { 'R', 'F', 'L', 'B' };
+
+	struct BinaryWriter
+	{
+		std::vector<uint8_t> Buffer;
+
+		void WriteVarint(uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				Buffer.push_back(uint8_t(value | 0x80));
+				value >>= 7;
+			}
+			Buffer.push_back(uint8_t(value));
+		}
+
+		void WriteFixed32(uint32_t value)
+		{
+			for (int i = 0; i < 4; ++i)
+				Buffer.push_back(uint8_t(value >> (i * 8)));
+		}
+
+		void WriteFixed64(uint64_t value)
+		{
+			for (int i = 0; i < 8; ++i)
+				Buffer.push_back(uint8_t(value >> (i * 8)));
+		}
+
+		void WriteBytes(std::span<uint8_t const> bytes)
+		{
+			Buffer.insert(Buffer.end(), bytes.begin(), bytes.end());
+		}
+
+		void WriteTag(uint32_t field_id, BinaryWireType type)
+		{
+			WriteVarint((uint64_t(field_id) << 3) | uint64_t(type));
+		}
+
+		/// Nested values are written in place, after a single byte reserved for their length;
+		/// `EndLengthDelimited` writes the actual length, making room for it if it doesn't fit in that byte.
+		size_t BeginLengthDelimited()
+		{
+			Buffer.push_back(0);
+			return Buffer.size();
+		}
+
+		void EndLengthDelimited(size_t start)
+		{
+			uint64_t length = Buffer.size() - start;
+			uint8_t encoded[10]{};
+			size_t encoded_size = 0;
+			while (length >= 0x80)
+			{
+				encoded[encoded_size++] = uint8_t(length | 0x80);
+				length >>= 7;
+			}
+			encoded[encoded_size++] = uint8_t(length);
+
+			if (encoded_size > 1)
+				Buffer.insert(Buffer.begin() + start, encoded_size - 1, uint8_t{});
+			std::memcpy(Buffer.data() + start - 1, encoded, encoded_size);
+		}
+	};
+
+	struct BinaryReader
+	{
+		std::span<uint8_t const> Data;
+		size_t Position = 0;
+
+		bool AtEnd() const noexcept { return Position >= Data.size(); }
+
+		uint64_t ReadVarint()
+		{
+			uint64_t result = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				const uint8_t byte = ReadByte();
+				result |= uint64_t(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+					return result;
+			}
+			throw DataError{ "Malformed varint in binary data" };
+		}
+
+		uint32_t ReadFixed32()
+		{
+			uint32_t result = 0;
+			for (const auto byte : ReadBytes(4) | std::views::reverse)
+				result = (result << 8) | byte;
+			return result;
+		}
+
+		uint64_t ReadFixed64()
+		{
+			uint64_t result = 0;
+			for (const auto byte : ReadBytes(8) | std::views::reverse)
+				result = (result << 8) | byte;
+			return result;
+		}
+
+		std::span<uint8_t const> ReadBytes(size_t count)
+		{
+			Require(count);
+			const auto result = Data.subspan(Position, count);
+			Position += count;
+			return result;
+		}
+
+		std::span<uint8_t const> ReadLengthDelimited()
+		{
+			const auto length = ReadVarint();
+			Require(length);
+			return ReadBytes(size_t(length));
+		}
+
+		void Skip(BinaryWireType type)
+		{
+			switch (type)
+			{
+			case BinaryWireType::Varint: ReadVarint(); break;
+			case BinaryWireType::Fixed64: ReadBytes(8); break;
+			case BinaryWireType::LengthDelimited: ReadLengthDelimited(); break;
+			case BinaryWireType::Fixed32: ReadBytes(4); break;
+			default: throw DataError{ std::format("Unknown wire type {} in binary data", int(type)) };
+			}
+		}
+
+	private:
+
+		uint8_t ReadByte()
+		{
+			Require(1);
+			return Data[Position++];
+		}
+
+		void Require(uint64_t count) const
+		{
+			if (count > Data.size() - Position)
+				throw DataError{ "Unexpected end of binary data" };
+		}
+	};
+
+	/// The fields of a serialized object, indexed by id, so that the generated `BinaryLoadFields` functions can find
+	/// them regardless of the order they were saved in. Fields that nobody looks up (e.g. of removed fields) are simply ignored.
+	struct BinaryObject
+	{
+		struct Entry
+		{
+			uint32_t FieldID = 0;
+			BinaryWireType WireType{};
+			std::span<uint8_t const> Value; /// The encoded value, including the length for length-delimited values
+		};
+
+		explicit BinaryObject(std::span<uint8_t const> data)
+		{
+			BinaryReader reader{ data };
+			while (!reader.AtEnd())
+			{
+				const auto tag = reader.ReadVarint();
+				const auto type = BinaryWireType(tag & 7);
+				const auto start = reader.Position;
+				reader.Skip(type);
+				Entries.push_back({ uint32_t(tag >> 3), type, data.subspan(start, reader.Position - start) });
+			}
+			/// If a field is repeated, the first one wins
+			std::ranges::stable_sort(Entries, {}, &Entry::FieldID);
+		}
+
+		Entry const* Find(uint32_t field_id) const noexcept
+		{
+			const auto it = std::ranges::lower_bound(Entries, field_id, {}, &Entry::FieldID);
+			return (it != Entries.end() && it->FieldID == field_id) ? std::to_address(it) : nullptr;
+		}
+
+		std::vector<Entry> Entries;
+	};
+
+	inline Class const* FindClassByBinaryID(uint64_t class_id)
+	{
+		static const auto classes_by_id = [] {
+			std::unordered_map<uint64_t, Class const*> result;
+			for (auto klass = Classes; *klass; ++klass)
+				result.emplace(BinaryClassID((*klass)->FullType), *klass);
+			return result;
+		}();
+		const auto it = classes_by_id.find(class_id);
+		return it != classes_by_id.end() ? it->second : nullptr;
+	}
+
+	/// ///////////////////////////////////// ///
+	/// Serializers
+	/// ///////////////////////////////////// ///
+
+	/// Specialize this to make your own types binary-serializable. Specializations need a `static constexpr BinaryWireType WireType`,
+	/// and `static void Write(BinaryWriter&, T const&)` and `static void Read(BinaryReader&, T&)` functions.
+	template <typename T>
+	struct BinarySerializer;
+
+	template <typename T>
+	concept binary_serializable = requires { BinarySerializer<std::remove_cvref_t<T>>::WireType; };
+
+	template <typename T> concept binary_varint_type = std::integral<T> || std::is_enum_v<T>;
+	template <typename T> concept binary_object_type = requires (T& obj, T const& cobj, BinaryWriter& writer, BinaryObject const& src) {
+		cobj.BinarySaveFields(writer);
+		obj.BinaryLoadFields(src);
+	};
+	template <typename T> concept binary_map_type = std::ranges::range<T> && !binary_object_type<T>
+		&& requires { typename T::key_type; typename T::mapped_type; };
+	template <typename T> concept binary_set_type = std::ranges::range<T> && !binary_object_type<T>
+		&& requires { typename T::key_type; } && !requires { typename T::mapped_type; };
+	template <typename T> concept binary_sequence_type = std::ranges::range<T> && !binary_object_type<T> && !binary_map_type<T> && !binary_set_type<T>
+		&& !std::same_as<T, std::string> && !columnar_vector<T>
+		&& (requires (T& container, std::ranges::range_value_t<T>&& value) { container.clear(); container.push_back(std::move(value)); } || requires { std::tuple_size<T>::value; });
+
+	template <binary_varint_type T>
+	struct BinarySerializer<T>
+	{
+		static constexpr BinaryWireType WireType = BinaryWireType::Varint;
+
+		static void Write(BinaryWriter& writer, T const& value)
+		{
+			if constexpr (std::is_enum_v<T>)
+				BinarySerializer<std::underlying_type_t<T>>::Write(writer, std::underlying_type_t<T>(value));
+			else if constexpr (std::same_as<T, bool>)
+				writer.WriteVarint(value ? 1 : 0);
+			else if constexpr (std::is_signed_v<T>)
+				writer.WriteVarint((uint64_t(int64_t(value)) << 1) ^ uint64_t(int64_t(value) >> 63));
+			else
+				writer.WriteVarint(uint64_t(value));
+		}
+
+		static void Read(BinaryReader& reader, T& value)
+		{
+			if constexpr (std::is_enum_v<T>)
+			{
+				std::underlying_type_t<T> underlying{};
+				BinarySerializer<std::underlying_type_t<T>>::Read(reader, underlying);
+				value = T(underlying);
+			}
+			else if constexpr (std::same_as<T, bool>)
+				value = reader.ReadVarint() != 0;
+			else if constexpr (std::is_signed_v<T>)
+			{
+				const auto encoded = reader.ReadVarint();
+				value = T(int64_t(encoded >> 1) ^ -int64_t(encoded & 1));
+			}
+			else
+				value = T(reader.ReadVarint());
+		}
+	};
+
+	template <>
+	struct BinarySerializer<float>
+	{
+		static constexpr BinaryWireType WireType = BinaryWireType::Fixed32;
+		static void Write(BinaryWriter& writer, float const& value) { writer.WriteFixed32(std::bit_cast<uint32_t>(value)); }
+		static void Read(BinaryReader& reader, float& value) { value = std::bit_cast<float>(reader.ReadFixed32()); }
+	};
+
+	template <>
+	struct BinarySerializer<double>
+	{
+		static constexpr BinaryWireType WireType = BinaryWireType::Fixed64;
+		static void Write(BinaryWriter& writer, double const& value) { writer.WriteFixed64(std::bit_cast<uint64_t>(value)); }
+		static void Read(BinaryReader& reader, double& value) { value = std::bit_cast<double>(reader.ReadFixed64()); }
+	};
+
+	template <>
+	struct BinarySerializer<std::string>
+	{
+		static constexpr BinaryWireType WireType = BinaryWireType::LengthDelimited;
+
+		static void Write(BinaryWriter& writer, std::string const& value)
+		{
+			writer.WriteVarint(value.size());
+			writer.WriteBytes({ reinterpret_cast<uint8_t const*>(value.data()), value.size() });
+		}
+
+		static void Read(BinaryReader& reader, std::string& value)
+		{
+			const auto bytes = reader.ReadLengthDelimited();
+			value.assign(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+		}
+	};
+
+	/// Reflected classes with generated `BinarySaveFields`/`BinaryLoadFields` methods
+	template <binary_object_type T>
+	struct BinarySerializer<T>
+	{
+		static constexpr BinaryWireType WireType = BinaryWireType::LengthDelimited;
+
+		static void Write(BinaryWriter& writer, T const& value)
+		{
+			const auto start = writer.BeginLengthDelimited();
+			value.BinarySaveFields(writer);
+			writer.EndLengthDelimited(start);
+		}
+
+		static void Read(BinaryReader& reader, T& value)
+		{
+			const BinaryObject object{ reader.ReadLengthDelimited() };
+			value.BinaryLoadFields(object);
+		}
+	};
+
+	/// Containers are written as their element count followed by the elements
+	template <binary_sequence_type T>
+	struct BinarySerializer<T>
+	{
+		using ElementType = std::remove_cvref_t<std::ranges::range_value_t<T>>;
+		static constexpr BinaryWireType WireType = BinaryWireType::LengthDelimited;
+
+		static void Write(BinaryWriter& writer, T const& value)
+		{
+			const auto start = writer.BeginLengthDelimited();
+			writer.WriteVarint(uint64_t(std::ranges::distance(value)));
+			for (auto const& element : value)
+				BinarySerializer<ElementType>::Write(writer, element);
+			writer.EndLengthDelimited(start);
+		}
+
+		static void Read(BinaryReader& reader, T& value)
+		{
+			BinaryReader elements{ reader.ReadLengthDelimited() };
+			const auto count = elements.ReadVarint();
+			if constexpr (requires { std::tuple_size<T>::value; })
+			{
+				/// Fixed-size arrays keep their size; extra elements are read and discarded
+				for (uint64_t i = 0; i < count; ++i)
+				{
+					if (i < std::tuple_size_v<T>)
+						BinarySerializer<ElementType>::Read(elements, value[i]);
+					else
+					{
+						ElementType discarded{};
+						BinarySerializer<ElementType>::Read(elements, discarded);
+					}
+				}
+			}
+			else
+			{
+				value.clear();
+				/// Every element takes at least one byte, so don't trust counts larger than that
+				if constexpr (requires { value.reserve(size_t{}); })
+					value.reserve(size_t(std::min<uint64_t>(count, elements.Data.size())));
+				for (uint64_t i = 0; i < count; ++i)
+				{
+					ElementType element{};
+					BinarySerializer<ElementType>::Read(elements, element);
+					value.push_back(std::move(element));
+				}
+			}
+		}
+	};
+
+	/// Vectors of `Columnar` classes are written as their element count followed by a column for each saved field, tagged with the
+	/// field's id (so columns can be skipped like fields); each column starts with its `ColumnarType`, and packed columns are
+	/// written as-is, the others as a sequence of values
+	template <columnar_vector T>
+	struct BinarySerializer<T>
+	{
+		using ElementType = typename T::value_type;
+		static constexpr BinaryWireType WireType = BinaryWireType::LengthDelimited;
+
+		static void Write(BinaryWriter& writer, T const& value)
+		{
+			const auto start = writer.BeginLengthDelimited();
+			writer.WriteVarint(value.size());
+			ForEachColumn<ElementType>(true, [&]<typename PROPERTIES>(PROPERTIES) {
+				using field_type = typename PROPERTIES::Type;
+				constexpr auto type = ColumnarTypeOf<field_type>();
+				writer.WriteTag(FieldNameHash(PROPERTIES::SaveName), BinaryWireType::LengthDelimited);
+				const auto column_start = writer.BeginLengthDelimited();
+				writer.WriteVarint(uint64_t(type));
+				for (auto const& element : value)
+				{
+					if constexpr (type != ColumnarType::Values)
+					{
+						uint8_t bytes[sizeof(field_type)];
+						ColumnarStore(bytes, PROPERTIES::Getter(&element));
+						writer.WriteBytes(bytes);
+					}
+					else
+						BinarySerializer<field_type>::Write(writer, PROPERTIES::Getter(&element));
+				}
+				writer.EndLengthDelimited(column_start);
+			});
+			writer.EndLengthDelimited(start);
+		}
+
+		static void Read(BinaryReader& reader, T& value)
+		{
+			BinaryReader contents{ reader.ReadLengthDelimited() };
+			const auto count = contents.ReadVarint();
+			/// Every element takes at least one byte in each column, and there's at least one column for any element, so don't
+			/// trust counts larger than that
+			if (count > contents.Data.size())
+				throw DataError{ std::format("Columnar vector has {} elements, but only {} bytes of data", count, contents.Data.size()) };
+			const BinaryObject columns{ contents.Data.subspan(contents.Position) };
+
+			/// Returns the reader of the column of the field, positioned after its type, if the column is present
+			const auto find_column = [&]<typename PROPERTIES>(PROPERTIES) -> std::optional<BinaryReader> {
+				constexpr auto type = ColumnarTypeOf<typename PROPERTIES::Type>();
+				const auto entry = columns.Find(FieldNameHash(PROPERTIES::LoadName));
+				if (!entry)
+				{
+					if (PROPERTIES::HasFlag(FieldFlags::Required))
+						throw DataError{ std::format("Missing column '{}'", PROPERTIES::LoadName) };
+					return std::nullopt;
+				}
+				if (entry->WireType != BinaryWireType::LengthDelimited)
+					throw DataError{ std::format("Column '{}' is not length-delimited", PROPERTIES::LoadName) };
+
+				BinaryReader column_reader{ entry->Value };
+				BinaryReader column{ column_reader.ReadLengthDelimited() };
+				if (const auto column_type = column.ReadVarint(); column_type != uint64_t(type))
+					throw DataError{ std::format("Column '{}' has type {}, expected {}", PROPERTIES::LoadName, column_type, uint64_t(type)) };
+				return column;
+			};
+
+			/// All columns are checked against the count before anything is allocated
+			bool has_columns = false;
+			ForEachColumn<ElementType>(false, [&]<typename PROPERTIES>(PROPERTIES properties) {
+				using field_type = typename PROPERTIES::Type;
+				const auto column = find_column(properties);
+				if (!column)
+					return;
+				has_columns = true;
+				const auto size = column->Data.size() - column->Position;
+				if (ColumnarTypeOf<field_type>() != ColumnarType::Values ? size != count * sizeof(field_type) : size < count)
+					throw DataError{ std::format("Column '{}' has {} bytes, which is too few or too many for {} elements", PROPERTIES::LoadName, size, count) };
+			});
+			if (!has_columns && count != 0)
+				throw DataError{ std::format("Columnar vector has {} elements, but no columns", count) };
+
+			/// The elements are loaded into a new vector, so that `value` isn't left half-loaded if a column is invalid
+			T loaded(size_t(count), value.get_allocator());
+			ForEachColumn<ElementType>(false, [&]<typename PROPERTIES>(PROPERTIES properties) {
+				using field_type = typename PROPERTIES::Type;
+				auto column = find_column(properties);
+				if (!column)
+					return;
+
+				if constexpr (ColumnarTypeOf<field_type>() != ColumnarType::Values)
+				{
+					const auto bytes = column->ReadBytes(size_t(count) * sizeof(field_type));
+					for (size_t i = 0; i < loaded.size(); ++i)
+						PROPERTIES::Getter(&loaded[i]) = ColumnarLoad<field_type>(bytes.data() + i * sizeof(field_type));
+				}
+				else
+				{
+					for (auto& element : loaded)
+						BinarySerializer<field_type>::Read(*column, PROPERTIES::Getter(&element));
+				}
+			});
+			value = std::move(loaded);
+		}
+	};
+
+	template <binary_set_type T>
+	struct BinarySerializer<T>
+	{
+		using ElementType = typename T::key_type;
+		static constexpr BinaryWireType WireType = BinaryWireType::LengthDelimited;
+
+		static void Write(BinaryWriter& writer, T const& value)
+		{
+			const auto start = writer.BeginLengthDelimited();
+			writer.WriteVarint(uint64_t(std::ranges::distance(value)));
+			for (auto const& element : value)
+				BinarySerializer<ElementType>::Write(writer, element);
+			writer.EndLengthDelimited(start);
+		}
+
+		static void Read(BinaryReader& reader, T& value)
+		{
+			BinaryReader elements{ reader.ReadLengthDelimited() };
+			const auto count = elements.ReadVarint();
+			value.clear();
+			for (uint64_t i = 0; i < count; ++i)
+			{
+				ElementType element{};
+				BinarySerializer<ElementType>::Read(elements, element);
+				value.insert(std::move(element));
+			}
+		}
+	};
+
+	/// Maps are written as their element count followed by key-value pairs
+	template <binary_map_type T>
+	struct BinarySerializer<T>
+	{
+		using KeyType = typename T::key_type;
+		using MappedType = typename T::mapped_type;
+		static constexpr BinaryWireType WireType = BinaryWireType::LengthDelimited;
+
+		static void Write(BinaryWriter& writer, T const& value)
+		{
+			const auto start = writer.BeginLengthDelimited();
+			writer.WriteVarint(uint64_t(std::ranges::distance(value)));
+			for (auto const& [key, mapped] : value)
+			{
+				BinarySerializer<KeyType>::Write(writer, key);
+				BinarySerializer<MappedType>::Write(writer, mapped);
+			}
+			writer.EndLengthDelimited(start);
+		}
+
+		static void Read(BinaryReader& reader, T& value)
+		{
+			BinaryReader elements{ reader.ReadLengthDelimited() };
+			const auto count = elements.ReadVarint();
+			value.clear();
+			for (uint64_t i = 0; i < count; ++i)
+			{
+				KeyType key{};
+				MappedType mapped{};
+				BinarySerializer<KeyType>::Read(elements, key);
+				BinarySerializer<MappedType>::Read(elements, mapped);
+				value.emplace(std::move(key), std::move(mapped));
+			}
+		}
+	};
+
+	/// Empty if there is no value
+	template <typename T>
+	struct BinarySerializer<std::optional<T>>
+	{
+		static constexpr BinaryWireType WireType = BinaryWireType::LengthDelimited;
+
+		static void Write(BinaryWriter& writer, std::optional<T> const& value)
+		{
+			const auto start = writer.BeginLengthDelimited();
+			if (value)
+				BinarySerializer<T>::Write(writer, *value);
+			writer.EndLengthDelimited(start);
+		}
+
+		static void Read(BinaryReader& reader, std::optional<T>& value)
+		{
+			BinaryReader contents{ reader.ReadLengthDelimited() };
+			if (contents.AtEnd())
+				value.reset();
+			else
+				BinarySerializer<T>::Read(contents, value.emplace());
+		}
+	};
+
+	/// Empty if null. Pointers to reflectable classes are polymorphic, and start with the `BinaryClassID` of the actual class of the object.
+	template <typename T>
+	struct BinarySerializer<std::unique_ptr<T>>
+	{
+		static constexpr BinaryWireType WireType = BinaryWireType::LengthDelimited;
+
+		static void Write(BinaryWriter& writer, std::unique_ptr<T> const& value)
+		{
+			const auto start = writer.BeginLengthDelimited();
+			if (value)
+			{
+				if constexpr (derives_from_reflectable<T>)
+				{
+					writer.WriteVarint(BinaryClassID(value->GetReflectionData().FullType));
+					value->BinarySaveFields(writer);
+				}
+				else
+					BinarySerializer<T>::Write(writer, *value);
+			}
+			writer.EndLengthDelimited(start);
+		}
+
+		static void Read(BinaryReader& reader, std::unique_ptr<T>& value)
+		{
+			const auto contents = reader.ReadLengthDelimited();
+			if (contents.empty())
+			{
+				value.reset();
+				return;
+			}
+
+			BinaryReader contents_reader{ contents };
+			if constexpr (derives_from_reflectable<T>)
+			{
+				const auto class_id = contents_reader.ReadVarint();
+				if (!value || BinaryClassID(value->GetReflectionData().FullType) != class_id)
+				{
+					value.reset();
+
+					const auto klass = FindClassByBinaryID(class_id);
+					if (!klass)
+						throw DataError{ std::format("Unknown reflectable class id {:016x}", class_id) };
+					const auto ptr = static_cast<Reflectable*>(klass->New());
+					if (!ptr)
+						throw UserError{ std::format("Could not construct object of type '{}' - type has no default constructor", klass->FullType) };
+					value = std::unique_ptr<T>{ dynamic_cast<T*>(ptr) };
+					if (!value)
+					{
+						delete ptr;
+						throw UserError{ std::format("Could not pass constructed object of type '{}' to pointer of type '{}'", klass->FullType, T::StaticGetReflectionData().Name) };
+					}
+				}
+				value->BinaryLoadFields(BinaryObject{ contents.subspan(contents_reader.Position) });
+			}
+			else
+			{
+				if (!value)
+					value = std::make_unique<T>();
+				BinarySerializer<T>::Read(contents_reader, *value);
+			}
+		}
+	};
+
+#if defined(REFLECTOR_USES_GC) && REFLECTOR_USES_GC
+	/// Pointers to objects on the GC heap can only be written as part of a heap snapshot (see `Heap::SaveSnapshot`).
+	/// They are stored as the index of the object in the snapshot plus one, or zero if null.
+	template <typename T>
+	requires derives_from_reflectable<std::remove_const_t<T>>
+	struct BinarySerializer<T*>
+	{
+		static constexpr BinaryWireType WireType = BinaryWireType::Varint;
+
+		static void Write(BinaryWriter& writer, T* const& value)
+		{
+			writer.WriteVarint(value ? Heap::SnapshotIndexOf(value) + 1 : 0);
+		}
+
+		static void Read(BinaryReader& reader, T*& value)
+		{
+			const auto index = reader.ReadVarint();
+			if (index == 0)
+			{
+				value = nullptr;
+				return;
+			}
+			value = Heap::SnapshotObjectAt(index - 1)->template As<std::remove_const_t<T>>();
+			if (!value)
+				throw DataError{ std::format("Snapshot object {} is not of type '{}'", index - 1, T::StaticGetReflectionData().FullType) };
+		}
+	};
+#endif
+
+	/// ///////////////////////////////////// ///
+	/// Functions used by generated code
+	/// ///////////////////////////////////// ///
+
+	template <typename T>
+	void BinaryWriteField(BinaryWriter& writer, uint32_t field_id, T const& value)
+	{
+		writer.WriteTag(field_id, BinarySerializer<T>::WireType);
+		BinarySerializer<T>::Write(writer, value);
+	}
+
+	template <typename T>
+	void BinaryReadField(BinaryObject::Entry const& entry, T& value)
+	{
+		if (entry.WireType != BinarySerializer<T>::WireType)
+			throw DataError{ std::format("Field was saved with wire type {}, expected {}", int(entry.WireType), int(BinarySerializer<T>::WireType)) };
+		BinaryReader reader{ entry.Value };
+		BinarySerializer<T>::Read(reader, value);
+	}
+
+	/// ///////////////////////////////////// ///
+	/// Top-level
+	/// ///////////////////////////////////// ///
+
+	/// Saves the value, preceded by the format magic and version
+	template <binary_serializable T>
+	void BinarySave(BinaryWriter& writer, T const& value)
+	{
+		writer.WriteBytes(BinaryFormatMagic);
+		writer.WriteVarint(BinaryFormatVersion);
+		BinarySerializer<T>::Write(writer, value);
+	}
+
+	template <binary_serializable T>
+	std::vector<uint8_t> BinarySave(T const& value)
+	{
+		BinaryWriter writer;
+		BinarySave(writer, value);
+		return std::move(writer.Buffer);
+	}
+
+	template <binary_serializable T>
+	void BinaryLoad(std::span<uint8_t const> data, T& value)
+	{
+		BinaryReader reader{ data };
+		if (!std::ranges::equal(reader.ReadBytes(sizeof(BinaryFormatMagic)), BinaryFormatMagic))
+			throw DataError{ "Not reflector binary data" };
+		if (const auto version = reader.ReadVarint(); version > BinaryFormatVersion)
+			throw DataError{ std::format("Binary data has format version {}, only versions up to {} are supported", version, BinaryFormatVersion) };
+		BinarySerializer<T>::Read(reader, value);
+	}
+}
@@ -8,12 +8,24 @@
 #include <vector>
 #include <compare>
 #include <string>
+#include <string_view>
 #include <tuple>
+#include <type_traits>
+#include <array>
+#include <algorithm>
+#include <bitset>
 #if REFLECTOR_USES_JSON
 #include REFLECTOR_JSON_HEADER
+#include <atomic>
 #endif
 #if REFLECTOR_USES_GC
 #include <set>
+#include <atomic>
+#include <bit>
+#include <span>
+#endif
+#if defined(REFLECTOR_CONSTINIT_DATABASE) && REFLECTOR_CONSTINIT_DATABASE
+#include <span>
 #endif
 
 namespace Reflector
@@ -23,6 +35,19 @@ namespace Reflector
 	struct Method;
 	struct Property;
 	struct Class;
+#if defined(REFLECTOR_USES_BINARY) && REFLECTOR_USES_BINARY
+	struct BinaryWriter;
+	struct BinaryObject;
+#endif
+#if REFLECTOR_USES_JSON
+	struct JSONLoadedFields;
+#endif
+#if defined(REFLECTOR_USES_JSON_SAX) && REFLECTOR_USES_JSON_SAX
+	struct JSONSAXLoader;
+#endif
+#if defined(REFLECTOR_USES_JSON_WRITER) && REFLECTOR_USES_JSON_WRITER
+	struct JSONWriter;
+#endif
 
 	template <typename T> concept reflected_class = requires {
 		T::StaticClassFlags();
@@ -32,6 +57,42 @@ namespace Reflector
 
 	enum class AccessMode { Unspecified, Public, Private, Protected };
 
+#if defined(REFLECTOR_CONSTINIT_DATABASE) && REFLECTOR_CONSTINIT_DATABASE
+	/// In constinit mode, all reflection data lives in `constinit` arrays generated in the database file, so no reflection
+	/// data needs dynamic initialization or heap allocations
+	template <typename T> using ReflectionList = std::span<T const>;
+	using ReflectionString = std::string_view;
+
+	/// `std::type_index` cannot be constant-initialized, so we store a pointer to the `std::type_info` instead
+	struct TypeIndexType
+	{
+		constexpr TypeIndexType(std::type_info const& info) noexcept : mInfo(&info) {}
+
+		std::type_info const& Info() const noexcept { return *mInfo; }
+		std::type_index Index() const noexcept { return *mInfo; }
+		operator std::type_index() const noexcept { return *mInfo; }
+
+		bool operator==(TypeIndexType const& other) const noexcept { return *mInfo == *other.mInfo; }
+		bool operator==(std::type_info const& other) const noexcept { return *mInfo == other; }
+		bool operator==(std::type_index const& other) const noexcept { return std::type_index{ *mInfo } == other; }
+
+	private:
+
+		std::type_info const* mInfo;
+	};
+#else
+	template <typename T> using ReflectionList = std::vector<T>;
+	using ReflectionString = std::string;
+	using TypeIndexType = std::type_index;
+#endif
+
+	/// Used by the generated `GetEnumeratorFromNameIgnoreCase` functions
+	constexpr char ToLowerASCII(char c) noexcept { return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c; }
+	constexpr bool EqualsIgnoreCaseASCII(std::string_view a, std::string_view b) noexcept
+	{
+		return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char l, char r) { return ToLowerASCII(l) == ToLowerASCII(r); });
+	}
+
 	template<size_t N>
 	struct CompileTimeLiteral
 	{
@@ -41,10 +102,31 @@ namespace Reflector
 		char Value[N];
 	};
 
-	/// TODO: We could technically put attributes in here as well (at least top-level bool ones, as flags or something)
+	/// Attributes type for entities without any compile-time attributes
+	struct NoAttributes
+	{
+		static constexpr uint64_t AttributeFlagBits = 0;
+		static constexpr std::array<std::string_view, 0> AttributeNames{};
+	};
 
-	template <typename FIELD_TYPE, typename PARENT_TYPE, uint64_t FLAGS, CompileTimeLiteral NAME_CTL>
-	struct CompileTimeCommonData
+	/// The generator emits a struct for every entity with attributes, that has a `static constexpr` member for each top-level
+	/// boolean, number and string attribute (e.g. `Attributes::Required`, `Attributes::Min`), a list of the names of these attributes,
+	/// and a bitmask of the boolean attributes that are `true`, indexed by the generated `Reflector::AttributeFlag` enum.
+	template <typename ATTRIBUTES>
+	struct CompileTimeAttributeData
+	{
+		using Attributes = ATTRIBUTES;
+		static constexpr uint64_t AttributeFlags = ATTRIBUTES::AttributeFlagBits;
+
+		template <typename FLAG_TYPE>
+		static constexpr bool HasAttributeFlag(FLAG_TYPE flag_value) noexcept { return (AttributeFlags & (1ULL << uint64_t(flag_value))) != 0; }
+
+		template <CompileTimeLiteral NAME>
+		static constexpr bool HasAttribute() noexcept { return std::ranges::find(ATTRIBUTES::AttributeNames, std::string_view{ NAME.Value }) != std::ranges::end(ATTRIBUTES::AttributeNames); }
+	};
+
+	template <typename FIELD_TYPE, typename PARENT_TYPE, uint64_t FLAGS, CompileTimeLiteral NAME_CTL, typename ATTRIBUTES = NoAttributes>
+	struct CompileTimeCommonData : CompileTimeAttributeData<ATTRIBUTES>
 	{
 		using Type = std::remove_cvref_t<FIELD_TYPE>;
 		using ParentType = PARENT_TYPE;
@@ -57,13 +139,23 @@ namespace Reflector
 		template <typename TYPE>
 		static constexpr bool IsType() noexcept { return std::is_same_v<TYPE, FIELD_TYPE>; }
 	};
-	template <typename FIELD_TYPE, typename PARENT_TYPE, uint64_t FLAGS, CompileTimeLiteral NAME_CTL, typename PTR_TYPE, PTR_TYPE POINTER>
-	struct CompileTimeFieldData : CompileTimeCommonData<FIELD_TYPE, PARENT_TYPE, FLAGS, NAME_CTL>
+	template <typename FIELD_TYPE, typename PARENT_TYPE, uint64_t FLAGS, CompileTimeLiteral NAME_CTL, typename PTR_TYPE, PTR_TYPE POINTER, typename ATTRIBUTES = NoAttributes>
+	struct CompileTimeFieldData : CompileTimeCommonData<FIELD_TYPE, PARENT_TYPE, FLAGS, NAME_CTL, ATTRIBUTES>
 	{
 		using PointerType = PTR_TYPE;
 		static constexpr PTR_TYPE Pointer = POINTER;
 		static constexpr bool IsStatic = !std::is_member_object_pointer_v<PTR_TYPE>;
 
+		/// The names the field is saved under and loaded from; set by the `SaveName` and `LoadName` attributes, the field name otherwise
+		static constexpr std::string_view SaveName = [] {
+			if constexpr (requires { { ATTRIBUTES::SaveName } -> std::convertible_to<std::string_view>; }) return std::string_view{ ATTRIBUTES::SaveName };
+			else return std::string_view{ NAME_CTL.Value };
+		}();
+		static constexpr std::string_view LoadName = [] {
+			if constexpr (requires { { ATTRIBUTES::LoadName } -> std::convertible_to<std::string_view>; }) return std::string_view{ ATTRIBUTES::LoadName };
+			else return std::string_view{ NAME_CTL.Value };
+		}();
+
 		static auto Getter(PARENT_TYPE const* obj) -> FIELD_TYPE const&
 		{
 			if constexpr (IsStatic)
@@ -99,8 +191,8 @@ namespace Reflector
 		static auto VoidSetter(void* obj, void const* value) -> void { (obj->*Pointer) = static_cast<FIELD_TYPE const*>(value); }
 	};
 
-	template <typename RETURN_TYPE, typename PARAMETER_TUPLE_TYPE, typename PARENT_TYPE, uint64_t FLAGS, CompileTimeLiteral NAME_CTL, typename PTR_TYPE, PTR_TYPE POINTER, AccessMode ACCESS_MODE>
-	struct CompileTimeMethodData
+	template <typename RETURN_TYPE, typename PARAMETER_TUPLE_TYPE, typename PARENT_TYPE, uint64_t FLAGS, CompileTimeLiteral NAME_CTL, typename PTR_TYPE, PTR_TYPE POINTER, AccessMode ACCESS_MODE, typename ATTRIBUTES = NoAttributes>
+	struct CompileTimeMethodData : CompileTimeAttributeData<ATTRIBUTES>
 	{
 		static constexpr uint64_t Flags = FLAGS;
 		static constexpr std::string_view Name = NAME_CTL.Value;
@@ -173,9 +265,80 @@ namespace Reflector
 		NotScriptable,
 	};
 
+#if REFLECTOR_USES_JSON
+	/// Holds the parsed form of an entity's `Attributes` string. The string is only parsed on first access, so unused
+	/// attributes cost nothing at startup. Parsing is thread-safe: if multiple threads race to parse the same attributes,
+	/// one result is kept and the others are discarded.
+	struct LazyJSON
+	{
+		constexpr LazyJSON(std::string_view source) noexcept : mSource(source) {}
+		LazyJSON(LazyJSON const& other) noexcept : mSource(other.mSource) {}
+		LazyJSON& operator=(LazyJSON const& other) noexcept { if (this != &other) { Release(); mSource = other.mSource; } return *this; }
+		/// constexpr so that entities holding a LazyJSON can be constant-initialized (see REFLECTOR_CONSTINIT_DATABASE)
+		constexpr ~LazyJSON() noexcept { if (!std::is_constant_evaluated()) Release(); }
+
+		REFLECTOR_JSON_TYPE const& Get() const
+		{
+			if (auto const parsed = mParsed.load(std::memory_order_acquire))
+				return *parsed;
+			auto const fresh = new REFLECTOR_JSON_TYPE(mSource.empty() ? REFLECTOR_JSON_TYPE::object() : REFLECTOR_JSON_PARSE_FUNC(mSource));
+			REFLECTOR_JSON_TYPE* expected = nullptr;
+			if (mParsed.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+				return *fresh;
+			delete fresh;
+			return *expected;
+		}
+
+		REFLECTOR_JSON_TYPE const& operator*() const { return Get(); }
+		REFLECTOR_JSON_TYPE const* operator->() const { return &Get(); }
+		operator REFLECTOR_JSON_TYPE const&() const { return Get(); }
+
+		bool IsParsed() const noexcept { return mParsed.load(std::memory_order_acquire) != nullptr; }
+
+		/// Frees the parsed value; it will be parsed again on next access.
+		/// Make sure no one is holding on to a reference returned by `Get()` when calling this.
+		void Release() const noexcept { delete mParsed.exchange(nullptr, std::memory_order_acq_rel); }
+
+		std::string_view Source() const noexcept { return mSource; }
+
+	private:
+
+		std::string_view mSource;
+		mutable std::atomic<REFLECTOR_JSON_TYPE*> mParsed = nullptr;
+	};
+#endif
+
 	void* AlignedAlloc(size_t alignment, size_t size);
 	void AlignedFree(void* obj);
 
+#if defined(REFLECTOR_USES_GC) && REFLECTOR_USES_GC
+	/// Passed to the relocation constructors of `Relocatable` classes; only `RelocateFunction` can create one, so that
+	/// reflected classes don't have to be move-constructible for heap compaction to move their objects
+	class RelocationTag
+	{
+		constexpr RelocationTag() noexcept = default;
+
+		template <typename T>
+		friend void RelocateObject(void* dest, void* src) noexcept;
+	};
+
+	template <typename T>
+	void RelocateObject(void* dest, void* src) noexcept
+	{
+		new (dest) T(RelocationTag{}, std::move(*static_cast<T*>(src)));
+		static_cast<T*>(src)->~T();
+	}
+
+	/// Returns a function that moves an object of type T to uninitialized memory, by constructing it there with its relocation
+	/// constructor (`T(RelocationTag, T&&)`, which passes the tag on to the constructor of its parent) and destroying the original
+	template <typename T>
+	constexpr auto RelocateFunction() -> void(*)(void* dest, void* src)
+	{
+		static_assert(std::is_nothrow_constructible_v<T, RelocationTag, T&&> && std::is_nothrow_destructible_v<T>, "Relocatable classes must have a noexcept relocation constructor");
+		return &RelocateObject<T>;
+	}
+#endif
+
 	struct Class
 	{
 		std::string_view Name = {};
@@ -184,15 +347,20 @@ namespace Reflector
 		std::string_view BaseClassName = {};
 		std::string_view Attributes = "{}";
 #if REFLECTOR_USES_JSON
-		REFLECTOR_JSON_TYPE AttributesJSON = REFLECTOR_JSON_TYPE::object();
+		LazyJSON AttributesJSON{ Attributes }; /// Parsed on first access
 #endif
 		uint64_t ReflectionUID = 0;
-		std::string GUID = {};
+		ReflectionString GUID = {};
 		size_t Alignment{};
 		size_t Size{};
 		void (*DefaultPlacementConstructor)(void*) = {};
 		void* (*DefaultConstructor)() = {};
 		void (*Destructor)(void*) = {};
+#if defined(REFLECTOR_USES_GC) && REFLECTOR_USES_GC
+		/// Used by heap compaction to move objects (see `Heap::Compact`); only set for classes with the `Relocatable` attribute,
+		/// objects of other classes are never moved
+		void (*Relocate)(void* dest, void* src) = {};
+#endif
 
 		void* Alloc() const;
 		void Delete(void* obj) const;
@@ -213,9 +381,10 @@ namespace Reflector
 		}
 
 		/// These are vectors and not e.g. initializer_list's because you might want to create your own classes
-		std::vector<Field> Fields;
-		std::vector<Method> Methods;
-		std::vector<Property> Properties;
+		/// (unless REFLECTOR_CONSTINIT_DATABASE is set, in which case they are spans into the constinit database)
+		ReflectionList<Field> Fields;
+		ReflectionList<Method> Methods;
+		ReflectionList<Property> Properties;
 
 #if REFLECTOR_USES_JSON
 		void(*JSONLoadFieldsFunc)(void* dest_object, REFLECTOR_JSON_TYPE const& src_object);
@@ -224,10 +393,15 @@ namespace Reflector
 		template <typename T>
 		T AttributeValue(std::string_view attr_name, T&& default_value) const
 		{
-			if (!AttributesJSON.is_object())
+			auto const& attributes = AttributesJSON.Get();
+			if (!attributes.is_object())
 				return std::forward<T>(default_value);
-			return AttributesJSON.value(attr_name, std::forward<T>(default_value));
+			return attributes.value(attr_name, std::forward<T>(default_value));
 		}
+#endif
+#if defined(REFLECTOR_USES_BINARY) && REFLECTOR_USES_BINARY
+		void(*BinaryLoadFieldsFunc)(void* dest_object, BinaryObject const& src_object) = {};
+		void(*BinarySaveFieldsFunc)(void const* src_object, BinaryWriter& dest_object) = {};
 #endif
 		auto FindField(std::string_view name) const->Field const*;
 		template <typename T>
@@ -246,7 +420,7 @@ namespace Reflector
 		requires reflected_class<U>
 		auto HasBaseClass() const -> bool;
 
-		std::type_index TypeIndex = typeid(void);
+		TypeIndexType TypeIndex = typeid(void);
 
 		uint64_t Flags = 0;
 
@@ -312,12 +486,12 @@ namespace Reflector
 		std::string_view DisplayName;
 		std::string_view FieldType;
 		std::string_view Initializer;
-		std::string_view Attributes = "{}"; /// TODO: Could be given at compile-time as well
+		std::string_view Attributes = "{}"; /// Also available at compile-time, see `CompileTimeAttributeData`
 		/// TODO: std::string_view ScriptName; /// Set to ScriptName if not empty, else UniqueName if not empty, otherwise Name
 #if REFLECTOR_USES_JSON
-		REFLECTOR_JSON_TYPE AttributesJSON = REFLECTOR_JSON_TYPE::object();
+		LazyJSON AttributesJSON{ Attributes }; /// Parsed on first access
 #endif
-		std::type_index FieldTypeIndex = typeid(void);
+		TypeIndexType FieldTypeIndex = typeid(void);
 		uint64_t Flags = 0;
 
 		Class const* ParentClass = nullptr;
@@ -356,25 +530,25 @@ namespace Reflector
 	{
 		struct Parameter
 		{
-			std::string Name;
-			std::string Type;
-			std::string Initializer;
+			ReflectionString Name;
+			ReflectionString Type;
+			ReflectionString Initializer;
 		};
 
 		std::string_view Name;
 		std::string_view DisplayName;
 		std::string_view ReturnType = "void";
 		std::string_view Parameters;
-		std::vector<Parameter> ParametersSplit{}; /// TODO: Could be given at compile-time as well
-		std::string_view Attributes = "{}"; /// TODO: Could be given at compile-time as well
+		ReflectionList<Parameter> ParametersSplit{}; /// TODO: Could be given at compile-time as well
+		std::string_view Attributes = "{}"; /// Also available at compile-time, see `CompileTimeAttributeData`
 #if REFLECTOR_USES_JSON
-		REFLECTOR_JSON_TYPE AttributesJSON = REFLECTOR_JSON_TYPE::object();
+		LazyJSON AttributesJSON{ Attributes }; /// Parsed on first access
 #endif
 
 		std::string_view UniqueName; /// TODO: Could be given at compile-time as well
 		std::string_view ArtificialBody;
-		std::type_index ReturnTypeIndex = typeid(void);
-		std::vector<std::type_index> ParameterTypeIndices = {};
+		TypeIndexType ReturnTypeIndex = typeid(void);
+		ReflectionList<TypeIndexType> ParameterTypeIndices = {};
 		uint64_t Flags = 0;
 		uint64_t UID = 0;
 
@@ -402,7 +576,7 @@ namespace Reflector
 
 		std::string_view Attributes = "{}"; /// TODO: Could be given at compile-time as well
 #if REFLECTOR_USES_JSON
-		REFLECTOR_JSON_TYPE AttributesJSON = REFLECTOR_JSON_TYPE::object();
+		LazyJSON AttributesJSON{ Attributes }; /// Parsed on first access
 #endif
 	};
 
@@ -413,10 +587,10 @@ namespace Reflector
 		std::string_view FullType;
 		std::string_view Attributes = "{}"; /// TODO: Could be given at compile-time as well
 #if REFLECTOR_USES_JSON
-		REFLECTOR_JSON_TYPE AttributesJSON = REFLECTOR_JSON_TYPE::object();
+		LazyJSON AttributesJSON{ Attributes }; /// Parsed on first access
 #endif
-		std::vector<Enumerator> Enumerators;
-		std::type_index TypeIndex = typeid(void);
+		ReflectionList<Enumerator> Enumerators;
+		TypeIndexType TypeIndex = typeid(void);
 		uint64_t Flags = 0;
 		uint64_t UID = 0;
 	};
@@ -435,13 +609,13 @@ namespace Reflector
 		std::string_view Name;
 		std::string_view DisplayName;
 		std::string_view Type;
-		std::string_view Attributes = "{}"; /// TODO: Could be given at compile-time as well
+		std::string_view Attributes = "{}"; /// Also available at compile-time, see `CompileTimeAttributeData`
 #if REFLECTOR_USES_JSON
-		REFLECTOR_JSON_TYPE AttributesJSON = REFLECTOR_JSON_TYPE::object();
+		LazyJSON AttributesJSON{ Attributes }; /// Parsed on first access
 #endif
 		void(*Getter)(void const*, void*) = {};
 		void(*Setter)(void*, void const*) = {};
-		std::type_index PropertyTypeIndex = typeid(void);
+		TypeIndexType PropertyTypeIndex = typeid(void);
 		uint64_t Flags = 0;
 
 		Class const* ParentClass = nullptr;
@@ -455,6 +629,118 @@ namespace Reflector
 		Property const* Data{};
 	};
 
+#if defined(REFLECTOR_USES_GC) && REFLECTOR_USES_GC
+
+	struct Heap;
+	struct Reflectable;
+
+	/// The functions that read, write and mark the pointers in a field of a given type, shared by all the pointer map entries
+	/// of fields of that type (see `GCFieldFunctionsFor` in ReflectorGC.h)
+	struct GCFieldFunctions
+	{
+		/// Convert between the type of the pointer and `Reflectable*`, which isn't necessarily at the start of the pointed-to class
+		Reflectable const* (*LoadPointer)(void const* field) = nullptr;
+		void (*StorePointer)(void* field, Reflectable* value) = nullptr;
+		void (*MarkElements)(void const* range) = nullptr;
+		/// Replaces each element of the range with the result of `update`; used to fix up pointers to objects moved by `Heap::Compact`
+		void (*UpdateElements)(void* range, Reflectable* (*update)(Reflectable* element)) = nullptr;
+	};
+
+	/// A table of the locations of pointers to GC objects within objects of a class. The tables are built at compile time
+	/// by the generated `GCPointerFields` functions, and returned by `GCGetPointerMap`. Lets the collector mark the fields of
+	/// an object in a tight loop over the table, instead of going through the `GCMark` function of the class and the
+	/// `Reflector::GCMark` overloads of each field.
+	struct GCPointerMap
+	{
+		enum class EntryKind : uint8_t
+		{
+			/// A pointer to a reflectable object; it's read and written through `LoadPointer` and `StorePointer`
+			Pointer,
+			/// A range of pointers to reflectable objects (e.g. a `std::vector<T*>`); its elements are marked by `MarkElements`
+			Range,
+		};
+
+		struct Entry
+		{
+			uint32_t Offset = 0;
+			EntryKind Kind = EntryKind::Pointer;
+			GCFieldFunctions const* Functions = nullptr;
+		};
+
+		std::span<Entry const> Entries;
+		/// False if the class has fields the map can't describe (e.g. structs, types with user `GCMark` overloads, or static fields);
+		/// those have to be marked by calling `Reflectable::GCMarkUnmapped` on the object
+		bool Complete = true;
+	};
+
+	/// A slab of GC heap memory holding objects of a single class, in equally-sized slots that follow this header.
+	/// Pages are aligned to their size, so the page of any heap object can be found by masking its address.
+	/// Classes too large to fit in a page get a page of their own, with a single slot.
+	struct HeapPage
+	{
+		static constexpr size_t Size = 64 * 1024;
+		static constexpr size_t MaxSlots = Size / 16;
+		static constexpr size_t BitmapWords = MaxSlots / 64;
+
+		Heap* ParentHeap = nullptr;
+		Class const* Klass = nullptr;
+		size_t SlotSize = 0;
+		size_t FirstSlotOffset = 0;
+		/// The size of the whole allocation; larger than `Size` only for pages of classes that don't fit in a regular page
+		size_t AllocationSize = 0;
+		uint32_t SlotCount = 0;
+		uint32_t LiveCount = 0;
+		/// Index of this page in the heap's page list
+		uint32_t Index = 0;
+		/// Index of this page in the heap's list of pages of its class
+		uint32_t ClassIndex = 0;
+		/// Set on all pages when sweeping starts, and cleared when the page is swept
+		bool NeedsSweep = false;
+		/// Whether the page is in the list of pages with free slots for its class
+		bool Available = false;
+		/// Whether a thread allocates objects from this page (see `Heap::AttachThread`); only that thread can change its live bitmap
+		bool Owned = false;
+		/// Whether the page might hold unmarked objects; pages with only old (marked) objects are skipped by the sweep
+		bool HasYoungObjects = false;
+		/// Objects created in this page since the start of the last collection (see `Heap::GetStatistics`)
+		uint32_t AllocationCount = 0;
+
+		/// A bit is set for each slot that holds an object
+		uint64_t LiveBits[BitmapWords]{};
+		/// Mark bits can be set by multiple threads at once (see `Heap::SetMarkThreadCount`), so they're accessed atomically.
+		/// Mark bits are not cleared by the sweep: between collections, the marked objects are the old generation (see `Heap::CollectMinor`).
+		uint64_t MarkBits[BitmapWords]{};
+
+		static HeapPage* Of(void const* obj) noexcept { return reinterpret_cast<HeapPage*>(reinterpret_cast<uintptr_t>(obj) & ~uintptr_t(Size - 1)); }
+
+		void* SlotAt(size_t slot) const noexcept { return reinterpret_cast<char*>(const_cast<HeapPage*>(this)) + FirstSlotOffset + slot * SlotSize; }
+
+		bool IsLive(size_t slot) const noexcept { return (LiveBits[slot / 64] & (1ULL << (slot % 64))) != 0; }
+		bool IsMarked(size_t slot) const noexcept { return (std::atomic_ref{ const_cast<uint64_t&>(MarkBits[slot / 64]) }.load(std::memory_order_relaxed) & (1ULL << (slot % 64))) != 0; }
+		/// Returns true if the slot wasn't already marked
+		bool Mark(size_t slot) noexcept
+		{
+			const auto bit = 1ULL << (slot % 64);
+			return (std::atomic_ref{ MarkBits[slot / 64] }.fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+		}
+
+		/// Returns the first live slot at or after `slot`, or `SlotCount` if there is none
+		size_t NextLiveSlot(size_t slot) const noexcept
+		{
+			for (size_t word = slot / 64; word * 64 < SlotCount; ++word)
+			{
+				auto bits = LiveBits[word];
+				if (word == slot / 64)
+					bits &= ~0ULL << (slot % 64);
+				if (bits)
+					return std::min(word * 64 + std::countr_zero(bits), size_t(SlotCount));
+			}
+			return SlotCount;
+		}
+	};
+
+#endif
+
 	struct Reflectable
 	{
 		using Class = Class;
@@ -486,6 +772,21 @@ namespace Reflector
 
 		}
 
+#if defined(REFLECTOR_USES_GC) && REFLECTOR_USES_GC
+	protected:
+
+		/// Called by the relocation constructors of `Relocatable` classes, when heap compaction moves their objects (see `Heap::Compact`).
+		/// The new object is not on a heap until the heap puts it there.
+		Reflectable(RelocationTag, Reflectable&& other) noexcept
+			: mClass_(other.mClass_)
+			, mFlags(0)
+			, mHeapIndex(0)
+		{
+		}
+#endif
+
+	public:
+
 		virtual ~Reflectable() noexcept = default;
 
 		constexpr auto operator<=>(Reflectable const&) const noexcept = default;
@@ -497,6 +798,29 @@ namespace Reflector
 		virtual void JSONLoadFields(REFLECTOR_JSON_TYPE const& src_object) {}
 		virtual void JSONSaveFields(REFLECTOR_JSON_TYPE& src_object) const {}
 
+		/// Used by the generated `JSONLoadFields` to load all fields of the class hierarchy in a single pass over the source object;
+		/// the loadable fields of each class are indexed after those of its parent
+		static constexpr size_t JSONLoadableFieldCount = 0;
+		virtual bool JSONLoadField(uint32_t key_hash, std::string_view key, REFLECTOR_JSON_TYPE const& value, JSONLoadedFields& loaded) { return false; }
+		virtual void JSONLoadFinish(JSONLoadedFields const& loaded) {}
+
+#if defined(REFLECTOR_USES_JSON_SAX) && REFLECTOR_USES_JSON_SAX
+		/// Used by the streaming JSON loader (see ReflectorJSON.h)
+		virtual bool JSONSAXField(uint32_t key_hash, std::string_view key, JSONSAXLoader& loader, JSONLoadedFields& loaded) { return false; }
+#endif
+
+#if defined(REFLECTOR_USES_JSON_WRITER) && REFLECTOR_USES_JSON_WRITER
+		/// Used by the direct JSON writer (see ReflectorJSON.h); writes the fields of the object, without the enclosing braces
+		virtual void JSONWriteFields(JSONWriter& writer) const {}
+#endif
+
+#endif
+
+#if defined(REFLECTOR_USES_BINARY) && REFLECTOR_USES_BINARY
+
+		virtual void BinaryLoadFields(BinaryObject const& src_object) {}
+		virtual void BinarySaveFields(BinaryWriter& dest_object) const {}
+
 #endif
 
 	protected:
@@ -510,11 +834,14 @@ namespace Reflector
 		
 #if defined(REFLECTOR_USES_GC) && REFLECTOR_USES_GC
 
-		enum class Flags { Dirty, OnHeap, Marked, };
+		/// Dirty objects are old objects that were modified since the last collection, and are in the remembered set of their heap
+		enum class Flags { Dirty, OnHeap, Gray, };
 
 		friend struct Heap;
 
 		mutable uint32_t mFlags;
+		/// Index of the slot of this object in its heap page; the mark bit of the object is at this index in the page's mark bitmap
+		uint32_t mHeapIndex;
 
 	private:
 
@@ -525,11 +852,30 @@ namespace Reflector
 		virtual void GCMark() const
 		{
 			if (GC_IsOnHeap())
-				mFlags |= (1ULL << int(Flags::Marked));
+				HeapPage::Of(this)->Mark(mHeapIndex);
 		}
 
-		bool GC_IsMarked() const noexcept { return (mFlags & (1ULL << int(Flags::Marked))) != 0; }
-		bool GC_IsOnHeap() const noexcept { return (mFlags & (1ULL << int(Flags::OnHeap))) != 0; }
+		/// The pointer map of `Reflectable` itself, which has no fields to mark.
+		/// Classes that aren't generated don't override `GCGetPointerMap`, so they get this map too, and are marked by their `GCMark` instead.
+		static GCPointerMap const& GCEmptyPointerMap() noexcept
+		{
+			static constexpr GCPointerMap empty_map;
+			return empty_map;
+		}
+
+		/// Describes where the pointers to other GC objects are in this object; used by the collector to mark objects without calling `GCMark`.
+		virtual GCPointerMap const& GCGetPointerMap() const { return GCEmptyPointerMap(); }
+		/// Marks the fields of this object that are not described by its pointer map
+		virtual void GCMarkUnmapped() const {}
+
+		/// The flags are accessed atomically, as objects can be marked by multiple threads at once (see `Heap::SetMarkThreadCount`)
+		uint32_t GC_Flags() const noexcept { return std::atomic_ref{ mFlags }.load(std::memory_order_relaxed); }
+		/// The mark bits of heap objects are kept in the bitmaps of their pages
+		bool GC_IsMarked() const noexcept { return GC_IsOnHeap() && HeapPage::Of(this)->IsMarked(mHeapIndex); }
+		bool GC_IsOnHeap() const noexcept { return (GC_Flags() & (1U << int(Flags::OnHeap))) != 0; }
+		/// Gray objects are marked, but waiting to have their fields marked
+		bool GC_IsGray() const noexcept { return (GC_Flags() & (1U << int(Flags::Gray))) != 0; }
+		bool GC_IsDirty() const noexcept { return (GC_Flags() & (1U << int(Flags::Dirty))) != 0; }
 
 		template <typename T, typename... ARGS>
 		T* New(ARGS&&... args);
@@ -554,10 +900,20 @@ namespace Reflector
 	Enumerator const* GetEnumeratorReflectionData(ENUM value)
 	{
 		auto& henum = GetEnumReflectionData<ENUM>();
-		for (auto& enumerator : henum.Enumerators)
-			if (enumerator.Value == (int64_t)value)
-				return &enumerator;
-		return nullptr;
+		if constexpr (requires { { GetEnumeratorIndex(value, size_t(-1)) } -> std::convertible_to<size_t>; })
+		{
+			/// Use the generated value-to-index lookup instead of walking all enumerators
+			if (const size_t index = GetEnumeratorIndex(value, size_t(-1)); index < henum.Enumerators.size())
+				return &henum.Enumerators[index];
+			return nullptr;
+		}
+		else
+		{
+			for (auto& enumerator : henum.Enumerators)
+				if (enumerator.Value == (int64_t)value)
+					return &enumerator;
+			return nullptr;
+		}
 	}
 
 	template <typename T> concept derives_from_reflectable = (::Reflector::reflected_class<std::remove_cvref_t<T>> && std::derived_from<std::remove_cvref_t<T>, Reflectable>) 
@@ -565,4 +921,11 @@ namespace Reflector
 
 	template <typename T> concept reflected_enum = IsReflectedEnum<T>();
 
+	/// Reflected classes with the `Columnar` attribute; vectors of these are serialized column by column, see `ColumnarJSONSave`
+	template <typename T> concept columnar_class = reflected_class<T> && requires { requires bool(T::self_attributes::Columnar); };
+
+	template <typename T> constexpr bool IsColumnarVector = false;
+	template <columnar_class T, typename ALLOCATOR> constexpr bool IsColumnarVector<std::vector<T, ALLOCATOR>> = true;
+	template <typename T> concept columnar_vector = IsColumnarVector<T>;
+
 }
\ No newline at end of file
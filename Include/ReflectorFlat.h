@@ -0,0 +1,434 @@
+#pragma once
+
+#include "ReflectorUtils.h"
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+/// Zero-copy flat format for reflected classes with the `FlatView` attribute.
+///
+/// The data can be read in place (e.g. from a memory-mapped file) through the generated `T::View` classes, without deserializing it:
+/// - each object is a table of fixed-size slots, one per saved field, at offsets given by the generated `T::FlatLayout()`;
+///   the fields of base classes come first, there is no vtable pointer
+/// - arithmetic and enum fields are stored inline, little-endian and aligned to their natural alignment
+/// - strings, vectors and nested objects are stored out of line, and their slots hold a 32-bit offset relative to the slot itself
+/// - strings are stored as their length, followed by the characters and a terminating zero
+/// - vectors are stored as their element count, followed by the element slots
+/// The out-of-line data is always written after the slot that refers to it, depth-first, in field order. The verifier requires
+/// this order, so that every byte is verified at most once, and buffers can't contain cycles or shared data.
+///
+/// Buffers start with a small header (magic, version and the offset of the root object), see `FlatSave`. Untrusted buffers must
+/// be checked with `FlatVerify` before calling `FlatRoot`; the views don't do any checks themselves.
+
+namespace Reflector
+{
+	inline constexpr uint8_t FlatFormatMagic[4] = { 'R', 'F', 'L', 'T' };
+	inline constexpr uint32_t FlatFormatVersion = 1;
+	/// Magic, version, and the offset of the root object table
+	inline constexpr uint32_t FlatHeaderSize = 12;
+
+	struct FlatWriter;
+	struct FlatVerifier;
+
+	/// Specialized for each type that can be stored in the flat format. Specializations need `static constexpr uint32_t Size` and
+	/// `Alignment` of the slot of the type, and `Read(uint8_t const* slot)`, `Write(FlatWriter&, size_t slot, T const&)` and
+	/// `Verify(FlatVerifier&, size_t slot)` functions.
+	template <typename T>
+	struct FlatTraits;
+
+	template <typename T> concept flat_storable = requires { FlatTraits<T>::Size; };
+	template <typename T> concept flat_scalar = std::is_arithmetic_v<T> || std::is_enum_v<T>;
+
+	/// Classes with generated flat views (see the `FlatView` attribute)
+	template <typename T> concept flat_class = requires { typename T::View; &T::FlatVerifyFields; };
+
+	constexpr size_t FlatAlign(size_t position, size_t alignment) noexcept
+	{
+		return (position + alignment - 1) / alignment * alignment;
+	}
+
+	template <flat_scalar T>
+	void FlatStore(uint8_t* dest, T value) noexcept
+	{
+		std::memcpy(dest, &value, sizeof(T));
+		if constexpr (std::endian::native == std::endian::big)
+			std::reverse(dest, dest + sizeof(T));
+	}
+
+	template <flat_scalar T>
+	T FlatLoad(uint8_t const* src) noexcept
+	{
+		uint8_t bytes[sizeof(T)];
+		std::memcpy(bytes, src, sizeof(T));
+		if constexpr (std::endian::native == std::endian::big)
+			std::reverse(bytes, bytes + sizeof(T));
+		T value;
+		std::memcpy(&value, bytes, sizeof(T));
+		return value;
+	}
+
+	/// The target of the offset stored in `slot`
+	inline uint8_t const* FlatDereference(uint8_t const* slot) noexcept
+	{
+		return slot + FlatLoad<uint32_t>(slot);
+	}
+
+	/// ///////////////////////////////////// ///
+	/// Layout
+	/// ///////////////////////////////////// ///
+
+	/// The offsets of the slots of the fields of a class (not including its base classes), and the size and alignment of its whole table
+	template <size_t N>
+	struct FlatLayout
+	{
+		std::array<uint32_t, N> Offsets{};
+		uint32_t Size = 0;
+		uint32_t Alignment = 4;
+	};
+
+	/// Lays out the slots of the given field types in order, after the slots of the base classes
+	template <typename... FIELD_TYPES>
+	constexpr auto MakeFlatLayout(uint32_t base_size = 0, uint32_t base_alignment = 4)
+	{
+		FlatLayout<sizeof...(FIELD_TYPES)> layout{};
+		layout.Alignment = base_alignment;
+		size_t position = base_size;
+		size_t index = 0;
+		([&] {
+			position = FlatAlign(position, FlatTraits<FIELD_TYPES>::Alignment);
+			layout.Offsets[index++] = uint32_t(position);
+			position += FlatTraits<FIELD_TYPES>::Size;
+			layout.Alignment = std::max(layout.Alignment, FlatTraits<FIELD_TYPES>::Alignment);
+		}(), ...);
+		layout.Size = uint32_t(FlatAlign(position, layout.Alignment));
+		return layout;
+	}
+
+	/// Forces the offsets to be compile-time constants in the generated getters
+	template <typename T, size_t INDEX>
+	inline constexpr uint32_t FlatFieldOffset = T::FlatLayout().Offsets[INDEX];
+
+	/// ///////////////////////////////////// ///
+	/// Writing
+	/// ///////////////////////////////////// ///
+
+	struct FlatWriter
+	{
+		std::vector<uint8_t> Buffer;
+
+		/// Appends zeroed space for a value, returning its position
+		size_t Allocate(size_t size, size_t alignment)
+		{
+			const auto position = FlatAlign(Buffer.size(), alignment);
+			Buffer.resize(position + size);
+			return position;
+		}
+
+		template <flat_scalar T>
+		void Store(size_t position, T value) noexcept
+		{
+			FlatStore(Buffer.data() + position, value);
+		}
+
+		void StoreOffset(size_t slot, size_t target)
+		{
+			if (target - slot > std::numeric_limits<uint32_t>::max())
+				throw UserError{ "Flat buffer is too large for 32-bit offsets" };
+			Store(slot, uint32_t(target - slot));
+		}
+
+		/// Writes the table of the object, followed by its out-of-line data, returning the position of the table
+		template <flat_class T>
+		size_t WriteTable(T const& object)
+		{
+			constexpr auto layout = T::FlatLayout();
+			const auto table = Allocate(layout.Size, layout.Alignment);
+			object.FlatWriteFields(*this, table);
+			return table;
+		}
+	};
+
+	/// ///////////////////////////////////// ///
+	/// Verification
+	/// ///////////////////////////////////// ///
+
+	struct FlatVerifier
+	{
+		explicit FlatVerifier(std::span<uint8_t const> data, size_t max_depth = 64) noexcept : Data(data), MaxDepth(max_depth) {}
+
+		std::span<uint8_t const> Data;
+		size_t MaxDepth = 64;
+
+		bool InBounds(size_t position, size_t size) const noexcept { return position <= Data.size() && size <= Data.size() - position; }
+
+		template <flat_scalar T>
+		T Load(size_t position) const noexcept { return FlatLoad<T>(Data.data() + position); }
+
+		/// The target of the offset in `slot` (which must be in bounds); it has to be aligned, in bounds for at least `min_size` bytes,
+		/// and come after all the data verified so far
+		std::optional<size_t> Target(size_t slot, size_t alignment, size_t min_size) const noexcept
+		{
+			const auto offset = Load<uint32_t>(slot);
+			const auto target = slot + offset;
+			if (offset == 0 || target < mEnd || target % alignment != 0 || !InBounds(target, min_size))
+				return std::nullopt;
+			return target;
+		}
+
+		/// Marks the data up to `end` as verified
+		void Claim(size_t end) noexcept { mEnd = end; }
+
+		template <flat_class T>
+		bool Table(size_t table)
+		{
+			constexpr auto layout = T::FlatLayout();
+			if (!InBounds(table, layout.Size) || mDepth >= MaxDepth)
+				return false;
+			Claim(table + layout.Size);
+			++mDepth;
+			const auto valid = T::FlatVerifyFields(*this, table);
+			--mDepth;
+			return valid;
+		}
+
+	private:
+
+		size_t mEnd = FlatHeaderSize;
+		size_t mDepth = 0;
+	};
+
+	/// ///////////////////////////////////// ///
+	/// Views
+	/// ///////////////////////////////////// ///
+
+	/// Base of the generated `T::View` classes; points to the table of an object in a flat buffer
+	struct FlatViewBase
+	{
+		FlatViewBase() noexcept = default;
+		explicit FlatViewBase(uint8_t const* table) noexcept : mTable(table) {}
+
+		uint8_t const* Table() const noexcept { return mTable; }
+		explicit operator bool() const noexcept { return mTable != nullptr; }
+
+	protected:
+
+		uint8_t const* mTable = nullptr;
+	};
+
+	/// A view of a vector in a flat buffer; its elements are read on access
+	template <typename T>
+	struct FlatVector
+	{
+		using value_type = decltype(FlatTraits<T>::Read(nullptr));
+
+		FlatVector() noexcept = default;
+		FlatVector(uint8_t const* elements, size_t count) noexcept : mElements(elements), mCount(count) {}
+
+		size_t size() const noexcept { return mCount; }
+		bool empty() const noexcept { return mCount == 0; }
+		value_type operator[](size_t index) const { return FlatTraits<T>::Read(mElements + index * FlatTraits<T>::Size); }
+
+		struct iterator
+		{
+			using iterator_concept = std::random_access_iterator_tag;
+			using value_type = FlatVector::value_type;
+			using difference_type = ptrdiff_t;
+
+			FlatVector const* Vector = nullptr;
+			size_t Index = 0;
+
+			value_type operator*() const { return (*Vector)[Index]; }
+			value_type operator[](difference_type n) const { return (*Vector)[Index + n]; }
+			iterator& operator++() noexcept { ++Index; return *this; }
+			iterator operator++(int) noexcept { auto result = *this; ++Index; return result; }
+			iterator& operator--() noexcept { --Index; return *this; }
+			iterator operator--(int) noexcept { auto result = *this; --Index; return result; }
+			iterator& operator+=(difference_type n) noexcept { Index += n; return *this; }
+			iterator& operator-=(difference_type n) noexcept { Index -= n; return *this; }
+			friend iterator operator+(iterator it, difference_type n) noexcept { return it += n; }
+			friend iterator operator+(difference_type n, iterator it) noexcept { return it += n; }
+			friend iterator operator-(iterator it, difference_type n) noexcept { return it -= n; }
+			friend difference_type operator-(iterator const& a, iterator const& b) noexcept { return difference_type(a.Index) - difference_type(b.Index); }
+			friend bool operator==(iterator const& a, iterator const& b) noexcept { return a.Index == b.Index; }
+			friend auto operator<=>(iterator const& a, iterator const& b) noexcept { return a.Index <=> b.Index; }
+		};
+
+		iterator begin() const noexcept { return { this, 0 }; }
+		iterator end() const noexcept { return { this, mCount }; }
+
+	private:
+
+		uint8_t const* mElements = nullptr;
+		size_t mCount = 0;
+	};
+
+	/// ///////////////////////////////////// ///
+	/// Traits
+	/// ///////////////////////////////////// ///
+
+	template <flat_scalar T>
+	struct FlatTraits<T>
+	{
+		static constexpr uint32_t Size = sizeof(T);
+		static constexpr uint32_t Alignment = alignof(T);
+
+		static T Read(uint8_t const* slot) noexcept { return FlatLoad<T>(slot); }
+		static void Write(FlatWriter& writer, size_t slot, T const& value) { writer.Store(slot, value); }
+		static bool Verify(FlatVerifier& verifier, size_t slot) noexcept
+		{
+			if constexpr (std::same_as<T, bool>)
+				return verifier.Data[slot] <= 1;
+			else
+				return true;
+		}
+	};
+
+	template <>
+	struct FlatTraits<std::string>
+	{
+		static constexpr uint32_t Size = 4;
+		static constexpr uint32_t Alignment = 4;
+
+		static std::string_view Read(uint8_t const* slot) noexcept
+		{
+			const auto target = FlatDereference(slot);
+			return { reinterpret_cast<char const*>(target + 4), FlatLoad<uint32_t>(target) };
+		}
+
+		static void Write(FlatWriter& writer, size_t slot, std::string const& value)
+		{
+			if (value.size() > std::numeric_limits<uint32_t>::max())
+				throw UserError{ "String is too long for the flat format" };
+			const auto target = writer.Allocate(4 + value.size() + 1, 4);
+			writer.Store(target, uint32_t(value.size()));
+			std::memcpy(writer.Buffer.data() + target + 4, value.data(), value.size());
+			writer.StoreOffset(slot, target);
+		}
+
+		static bool Verify(FlatVerifier& verifier, size_t slot) noexcept
+		{
+			const auto target = verifier.Target(slot, 4, 4);
+			if (!target)
+				return false;
+			const size_t length = verifier.Load<uint32_t>(*target);
+			if (!verifier.InBounds(*target + 4, length + 1) || verifier.Data[*target + 4 + length] != 0)
+				return false;
+			verifier.Claim(*target + 4 + length + 1);
+			return true;
+		}
+	};
+
+	/// The element count is followed by the element slots, aligned to the alignment of the elements
+	template <flat_storable T, typename ALLOCATOR>
+	struct FlatTraits<std::vector<T, ALLOCATOR>>
+	{
+		static_assert(!std::same_as<T, bool>, "std::vector<bool> cannot be stored in the flat format");
+
+		static constexpr uint32_t Size = 4;
+		static constexpr uint32_t Alignment = 4;
+		static constexpr uint32_t VectorAlignment = std::max<uint32_t>(4, FlatTraits<T>::Alignment);
+		static constexpr uint32_t ElementsOffset = VectorAlignment;
+
+		static FlatVector<T> Read(uint8_t const* slot) noexcept
+		{
+			const auto target = FlatDereference(slot);
+			return { target + ElementsOffset, FlatLoad<uint32_t>(target) };
+		}
+
+		static void Write(FlatWriter& writer, size_t slot, std::vector<T, ALLOCATOR> const& value)
+		{
+			if (value.size() > std::numeric_limits<uint32_t>::max())
+				throw UserError{ "Vector is too long for the flat format" };
+			const auto target = writer.Allocate(ElementsOffset + value.size() * FlatTraits<T>::Size, VectorAlignment);
+			writer.Store(target, uint32_t(value.size()));
+			writer.StoreOffset(slot, target);
+			for (size_t i = 0; i < value.size(); ++i)
+				FlatTraits<T>::Write(writer, target + ElementsOffset + i * FlatTraits<T>::Size, value[i]);
+		}
+
+		static bool Verify(FlatVerifier& verifier, size_t slot)
+		{
+			const auto target = verifier.Target(slot, VectorAlignment, ElementsOffset);
+			if (!target)
+				return false;
+			const size_t count = verifier.Load<uint32_t>(*target);
+			const auto elements = *target + ElementsOffset;
+			if (count > (verifier.Data.size() - elements) / FlatTraits<T>::Size)
+				return false;
+			verifier.Claim(elements + count * FlatTraits<T>::Size);
+			if constexpr (!flat_scalar<T>)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					if (!FlatTraits<T>::Verify(verifier, elements + i * FlatTraits<T>::Size))
+						return false;
+				}
+			}
+			return true;
+		}
+	};
+
+	/// Nested objects are stored as their own tables
+	template <flat_class T>
+	struct FlatTraits<T>
+	{
+		static constexpr uint32_t Size = 4;
+		static constexpr uint32_t Alignment = 4;
+
+		static typename T::View Read(uint8_t const* slot) noexcept { return typename T::View{ FlatDereference(slot) }; }
+
+		static void Write(FlatWriter& writer, size_t slot, T const& value)
+		{
+			const auto table = writer.WriteTable(value);
+			writer.StoreOffset(slot, table);
+		}
+
+		static bool Verify(FlatVerifier& verifier, size_t slot)
+		{
+			const auto target = verifier.Target(slot, T::FlatLayout().Alignment, 0);
+			return target && verifier.Table<T>(*target);
+		}
+	};
+
+	/// ///////////////////////////////////// ///
+	/// Top-level
+	/// ///////////////////////////////////// ///
+
+	/// Converts the object into a flat buffer, preceded by the format header
+	template <flat_class T>
+	std::vector<uint8_t> FlatSave(T const& object)
+	{
+		FlatWriter writer;
+		writer.Allocate(FlatHeaderSize, 4);
+		std::memcpy(writer.Buffer.data(), FlatFormatMagic, sizeof(FlatFormatMagic));
+		writer.Store(4, FlatFormatVersion);
+		const auto table = writer.WriteTable(object);
+		writer.StoreOffset(8, table);
+		return std::move(writer.Buffer);
+	}
+
+	/// Checks that the buffer holds a valid flat object of type `T`, so that its view can be safely used
+	template <flat_class T>
+	bool FlatVerify(std::span<uint8_t const> data, size_t max_depth = 64)
+	{
+		if (data.size() < FlatHeaderSize || !std::ranges::equal(data.first(sizeof(FlatFormatMagic)), FlatFormatMagic))
+			return false;
+		FlatVerifier verifier{ data, max_depth };
+		if (verifier.Load<uint32_t>(4) > FlatFormatVersion)
+			return false;
+		const auto table = verifier.Target(8, T::FlatLayout().Alignment, 0);
+		return table && verifier.Table<T>(*table);
+	}
+
+	/// The view of the root object of a flat buffer; the buffer must be valid (see `FlatVerify`)
+	template <flat_class T>
+	typename T::View FlatRoot(std::span<uint8_t const> data) noexcept
+	{
+		return typename T::View{ FlatDereference(data.data() + 8) };
+	}
+}
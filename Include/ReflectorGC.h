@@ -6,23 +6,80 @@
 #include <unordered_set>
 #include <ranges>
 #include <variant>
+#include <iosfwd>
+#include <chrono>
+#include <limits>
+#include <span>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cassert>
+#include <utility>
+#include <cstddef>
+
+/// Reflected classes are not standard-layout, so compilers warn about `offsetof` being used on them, even though they support it
+/// (as long as there are no virtual bases); the generated `GCPointerFields` functions are put between these
+#if defined(__GNUC__) || defined(__clang__)
+#define REFLECTOR_GC_OFFSETOF_BEGIN _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")
+#define REFLECTOR_GC_OFFSETOF_END _Pragma("GCC diagnostic pop")
+#else
+#define REFLECTOR_GC_OFFSETOF_BEGIN
+#define REFLECTOR_GC_OFFSETOF_END
+#endif
 
 namespace Reflector
 {
 	template <typename T>
-	struct could_be_marked
+	concept has_mark_func = requires (T const& val) { val.GCMark(); };
+
+	/// Whether values of the type can hold pointers to GC objects, and so have to be marked (and need write barriers):
+	/// pointers to classes, types with a `GCMark` function (e.g. reflectables), and ranges, tuples, pairs and variants of those
+	template <typename T>
+	struct could_be_marked : std::bool_constant<has_mark_func<T>>
 	{
-		static constexpr bool value = std::is_class_v<std::remove_cvref_t<T>> || std::is_array_v<std::remove_cvref_t<T>>;
 	};
 
 	template <typename T>
-	requires std::is_pointer_v<std::remove_cvref_t<T>>
-	struct could_be_marked<T> : could_be_marked<std::remove_pointer_t<std::remove_cvref_t<T>>>
+	requires (!std::same_as<T, std::remove_cvref_t<T>>)
+	struct could_be_marked<T> : could_be_marked<std::remove_cvref_t<T>>
 	{
 	};
 
 	template <typename T>
-	concept has_mark_func = requires (T const& val) { val.GCMark(); };
+	struct could_be_marked<T*> : std::is_class<std::remove_cv_t<T>>
+	{
+	};
+
+	/// Ranges of themselves (like `std::filesystem::path`) can't hold anything else
+	template <typename T>
+	requires (std::same_as<T, std::remove_cvref_t<T>> && !has_mark_func<T> && std::ranges::range<T const>
+		&& !std::same_as<std::remove_cvref_t<std::ranges::range_value_t<T const>>, T>)
+	struct could_be_marked<T> : could_be_marked<std::ranges::range_value_t<T const>>
+	{
+	};
+
+	template <typename... ELS>
+	struct could_be_marked<std::tuple<ELS...>> : std::disjunction<could_be_marked<ELS>...>
+	{
+	};
+
+	template <typename F, typename S>
+	struct could_be_marked<std::pair<F, S>> : std::disjunction<could_be_marked<F>, could_be_marked<S>>
+	{
+	};
+
+	template <typename... TYPES>
+	struct could_be_marked<std::variant<TYPES...>> : std::disjunction<could_be_marked<TYPES>...>
+	{
+	};
+
+	template <typename CLASS_TYPE, typename POINTER_TYPE, typename... TAGS>
+	struct could_be_marked<PathReference<CLASS_TYPE, POINTER_TYPE, TAGS...>> : std::true_type
+	{
+	};
 
 	/// This overload catches everything that we don't know how to mark
 	template <typename T, typename PT = std::remove_cvref_t<T>>
@@ -34,7 +91,7 @@ namespace Reflector
 	void GCMark(T&&)
 	{
 		/// Don't mark stuff that isn't an aggregate
-		static_assert(!could_be_marked<T>::value, "Type is an aggregate but cannot be marked. Make sure you overload the Reflector::GCMark(T&) function.");
+		static_assert(!std::is_class_v<PT> && !std::is_array_v<PT>, "Type is an aggregate but cannot be marked. Make sure you overload the Reflector::GCMark(T&) function.");
 	}
 	
 	template <typename T> void GCMark(std::basic_string<T> const&) {}
@@ -60,11 +117,8 @@ namespace Reflector
 		val.GCMark();
 	}
 
-	inline void GCMark(Reflectable const* r)
-	{
-		if (r && r->GC_IsOnHeap() && !r->GC_IsMarked())
-			r->GCMark();
-	}
+	/// Marks the object gray; its fields will be marked later, by the collector (so marking doesn't recurse)
+	inline void GCMark(Reflectable const* r);
 
 	/// We don't know how to mark this type, so we let the user overload the function
 	template <typename T>
@@ -80,23 +134,270 @@ namespace Reflector
 		}
 	}
 
-	/// Represents a heap of GC-enabled objects.
-	/// Only a single global heap is supported at this time.
-	/// NOTE: This class is NOT thread-safe.
+	/// How a field of a given type is described by a `GCPointerMap`
+	enum class GCFieldKind
+	{
+		/// The field can't hold pointers to GC objects
+		NotMarked,
+		Pointer,
+		Range,
+		/// The field has to be marked by its `GCMark` function (e.g. structs, or types with user `GCMark` overloads)
+		Unmapped,
+	};
+
+	template <typename T>
+	consteval GCFieldKind GCFieldKindOf()
+	{
+		using type = std::remove_cvref_t<T>;
+		if constexpr (std::is_pointer_v<type> && derives_from_reflectable<std::remove_pointer_t<type>>)
+			return GCFieldKind::Pointer;
+		else if constexpr (!std::is_pointer_v<type> && !has_mark_func<type> && std::ranges::range<type const>)
+		{
+			using element_type = std::remove_cvref_t<std::ranges::range_value_t<type const>>;
+			if constexpr (!could_be_marked<element_type>::value)
+				return GCFieldKind::NotMarked;
+			/// The elements must be assignable (e.g. not in a `std::set`), so that they can be updated when objects move
+			else if constexpr (std::is_pointer_v<element_type> && derives_from_reflectable<std::remove_pointer_t<element_type>>
+				&& std::is_assignable_v<std::ranges::range_reference_t<type>, element_type>)
+				return GCFieldKind::Range;
+			else
+				return GCFieldKind::Unmapped;
+		}
+		else if constexpr (could_be_marked<type>::value)
+			return GCFieldKind::Unmapped;
+		else
+			return GCFieldKind::NotMarked;
+	}
+
+	/// The functions used by the pointer map entries of fields of type T
+	template <typename T>
+	inline constexpr GCFieldFunctions GCFieldFunctionsFor = [] {
+		using type = std::remove_cvref_t<T>;
+		if constexpr (GCFieldKindOf<T>() == GCFieldKind::Pointer)
+		{
+			return GCFieldFunctions{ .LoadPointer = [](void const* pointer) -> Reflectable const* {
+				return *static_cast<type const*>(pointer);
+			}, .StorePointer = [](void* pointer, Reflectable* value) {
+				*static_cast<type*>(pointer) = static_cast<type>(value);
+			}, .MarkElements = nullptr, .UpdateElements = nullptr };
+		}
+		else
+		{
+			static_assert(GCFieldKindOf<T>() == GCFieldKind::Range, "only pointer and range fields are in pointer maps");
+			return GCFieldFunctions{ .LoadPointer = nullptr, .StorePointer = nullptr, .MarkElements = [](void const* range) {
+				for (auto element : *static_cast<type const*>(range))
+					GCMark(static_cast<Reflectable const*>(element));
+			}, .UpdateElements = [](void* range, Reflectable* (*update)(Reflectable* element)) {
+				using element_type = std::remove_cvref_t<std::ranges::range_value_t<type>>;
+				for (auto& element : *static_cast<type*>(range))
+				{
+					if (element)
+						element = static_cast<element_type>(update(const_cast<Reflectable*>(static_cast<Reflectable const*>(element))));
+				}
+			} };
+		}
+	}();
+
+	/// A field of a class, as passed to `GCPointerFields`
+	struct GCFieldEntry
+	{
+		GCFieldKind Kind = GCFieldKind::NotMarked;
+		uint32_t Offset = 0;
+		GCFieldFunctions const* Functions = nullptr;
+	};
+
+	/// Describes a non-static field of type T, at the given offset within its class
+	template <typename T>
+	constexpr GCFieldEntry GCMemberField(size_t offset)
+	{
+		constexpr auto kind = GCFieldKindOf<T>();
+		if constexpr (kind == GCFieldKind::Pointer || kind == GCFieldKind::Range)
+			return { kind, uint32_t(offset), &GCFieldFunctionsFor<T> };
+		else
+			return { kind, uint32_t(offset), nullptr };
+	}
+
+	/// Static fields aren't part of the object, so they're never in the map; `GCMarkIfUnmapped` marks them instead
+	template <typename T>
+	constexpr GCFieldEntry GCStaticField()
+	{
+		return { GCFieldKindOf<T>() == GCFieldKind::NotMarked ? GCFieldKind::NotMarked : GCFieldKind::Unmapped, 0, nullptr };
+	}
+
+	template <typename... FIELDS>
+	constexpr auto GCFieldEntries(FIELDS const&... fields)
+	{
+		return std::array<GCFieldEntry, sizeof...(FIELDS)>{ fields... };
+	}
+
+	/// The pointer map entries of a class, as built by its generated `GCPointerFields` function
+	template <size_t N>
+	struct GCPointerFieldList
+	{
+		std::array<GCPointerMap::Entry, N> Entries{};
+		bool Complete = true;
+	};
+
+	/// Builds the pointer map entries of a class at compile time, from the entries of its parent and the fields returned by
+	/// `OWN_FIELDS` (a lambda returning the `GCFieldEntries` of the class). The parent is the first base of the class,
+	/// so its fields are at the same offsets in both.
+	template <size_t PARENT_COUNT, typename OWN_FIELDS>
+	constexpr auto GCPointerFields(GCPointerFieldList<PARENT_COUNT> const& parent, OWN_FIELDS)
+	{
+		constexpr auto own = OWN_FIELDS{}();
+		constexpr auto mapped_count = size_t(std::ranges::count_if(own, [](GCFieldEntry const& field) {
+			return field.Kind == GCFieldKind::Pointer || field.Kind == GCFieldKind::Range;
+		}));
+
+		GCPointerFieldList<PARENT_COUNT + mapped_count> result;
+		std::ranges::copy(parent.Entries, result.Entries.begin());
+		result.Complete = parent.Complete;
+		auto next = result.Entries.begin() + PARENT_COUNT;
+		for (auto const& field : own)
+		{
+			if (field.Kind == GCFieldKind::Pointer)
+				*next++ = { field.Offset, GCPointerMap::EntryKind::Pointer, field.Functions };
+			else if (field.Kind == GCFieldKind::Range)
+				*next++ = { field.Offset, GCPointerMap::EntryKind::Range, field.Functions };
+			else if (field.Kind == GCFieldKind::Unmapped)
+				result.Complete = false;
+		}
+		return result;
+	}
+
+	/// Used by the generated `GCMarkUnmapped` functions to mark the fields that pointer maps can't describe, including static fields
+	template <typename OBJECT, typename FIELD_DATA>
+	void GCMarkIfUnmapped(OBJECT const* object, FIELD_DATA const& field_data)
+	{
+		constexpr auto kind = GCFieldKindOf<decltype(field_data.Getter(object))>();
+		if constexpr (FIELD_DATA::IsStatic ? kind != GCFieldKind::NotMarked : kind == GCFieldKind::Unmapped)
+			GCMark(field_data.Getter(object));
+	}
+
+	/// Information about a single collection of a heap, see `Heap::LastCollection()`
+	struct CollectionStatistics
+	{
+		/// Whether this was a minor collection (see `Heap::CollectMinor`)
+		bool Minor = false;
+
+		/// Time spent marking and sweeping; for incremental collections, this is the sum of the time spent in all steps
+		std::chrono::nanoseconds MarkTime{};
+		std::chrono::nanoseconds SweepTime{};
+
+		/// Objects created between the start of the previous collection and the start of this one, and the bytes they took
+		size_t ObjectsAllocated = 0;
+		size_t BytesAllocated = 0;
+
+		size_t ObjectsFreed = 0;
+		size_t BytesFreed = 0;
+		size_t Survivors = 0;
+
+		struct ClassStatistics
+		{
+			size_t Survivors = 0;
+			size_t Freed = 0;
+		};
+		/// Survivors and freed objects of each class that has objects on the heap
+		std::unordered_map<Class const*, ClassStatistics> Classes;
+
+		std::chrono::nanoseconds TotalTime() const noexcept { return MarkTime + SweepTime; }
+	};
+
+	/// Information about the current state of a heap, see `Heap::GetStatistics()`
+	struct HeapStatistics
+	{
+		size_t PageCount = 0;
+		/// Bytes allocated for heap pages (see `Heap::AllocatedBytes`)
+		size_t AllocatedBytes = 0;
+		size_t ObjectCount = 0;
+		/// Bytes taken by the slots of live objects, and by the free slots in pages
+		size_t LiveBytes = 0;
+		size_t FreeBytes = 0;
+
+		/// Objects created since the start of the last collection, and the bytes they took, whether they're still alive or not;
+		/// can be used to decide when to collect
+		size_t ObjectsAllocatedSinceCollection = 0;
+		size_t BytesAllocatedSinceCollection = 0;
+		size_t RememberedObjectCount = 0;
+
+		uint64_t Collections = 0;
+		uint64_t MinorCollections = 0;
+		uint64_t TotalObjectsFreed = 0;
+		/// Objects moved by `Heap::Compact`
+		uint64_t TotalObjectsMoved = 0;
+
+		/// When a thread runs out of room in the page it allocates from, it reuses a page with free slots if there is one,
+		/// and creates a new one otherwise
+		uint64_t PagesReused = 0;
+		uint64_t PagesCreated = 0;
+
+		double PageReuseRate() const noexcept
+		{
+			const auto total = PagesReused + PagesCreated;
+			return total ? double(PagesReused) / double(total) : 0.0;
+		}
+	};
+
+	/// Represents a heap of GC-enabled objects. Each heap has its own roots and objects, and is collected independently of
+	/// the others; pointers between objects on different heaps are not followed when marking, so objects referenced from
+	/// another heap must be kept alive by their own heap (e.g. by being roots).
+	/// A default heap is always available via `Default()`.
+	/// NOTE: Only creating objects, managing roots and write barriers are thread-safe; everything else (collection, serialization,
+	/// iterating over objects) must be done while no other thread is using the heap, e.g. by stopping the world (see `StopTheWorld`).
+	/// 
+	/// The collector is a tri-color mark-and-sweep collector: marked objects are either gray (waiting in a worklist to have their
+	/// fields marked) or black (done). Collection can be done all at once via `Collect`, or incrementally, in bounded slices of work,
+	/// via `Step`. While an incremental collection is marking, objects that get modified must be passed to `WriteBarrier`
+	/// (generated setters do this automatically), and objects that are only referenced from outside the heap and its roots
+	/// are not safe to keep across `Step` calls.
+	/// 
+	/// The collector is also generational: objects that survive a collection stay marked, and become old. `CollectMinor` only
+	/// collects the young objects, tracing from the roots and from the old objects modified since the last collection
+	/// (which `WriteBarrier` keeps in a remembered set).
 	struct Heap
 	{
+		Heap();
+		/// Destroys all objects on the heap
+		~Heap();
+
+		Heap(Heap const&) = delete;
+		Heap& operator=(Heap const&) = delete;
+
+		/// The heap that exists for the whole lifetime of the program
+		static Heap& Default();
+
+		/// The heap `Reflector::New` creates objects on; `Default()` unless changed for the calling thread by a `CurrentScope`
+		static Heap& Current();
+
+		/// Makes a heap current for the calling thread, for the lifetime of the scope
+		struct CurrentScope
+		{
+			explicit CurrentScope(Heap& heap);
+			~CurrentScope();
+			CurrentScope(CurrentScope const&) = delete;
+			CurrentScope& operator=(CurrentScope const&) = delete;
+
+		private:
+
+			Heap* mPrevious;
+		};
+
+		/// Returns the heap the object was created on, or nullptr if it's not on a heap
+		static Heap* Of(Reflectable const* obj) noexcept { return (obj && obj->GC_IsOnHeap()) ? HeapPage::Of(obj)->ParentHeap : nullptr; }
+
 		/// ///////////////////////////////// ///
 		/// Roots
 		/// ///////////////////////////////// ///
 		
-		static std::map<std::string, Reflectable*, std::less<>> const& Roots();
-		static bool SetRoot(std::string_view key, Reflectable* r);
-		static bool RemoveRoot(std::string_view key);
-		static Reflectable* GetRoot(std::string_view key);
-		static void ClearRoots();
+		std::map<std::string, Reflectable*, std::less<>> const& Roots() const { return mRoots; }
+		/// Returns false if the object is on another heap, as it cannot be a root of this one
+		bool SetRoot(std::string_view key, Reflectable* r);
+		bool RemoveRoot(std::string_view key);
+		Reflectable* GetRoot(std::string_view key);
+		void ClearRoots();
 
 		template <derives_from_reflectable T>
-		static T* GetRoot(std::string_view key)
+		T* GetRoot(std::string_view key)
 		{
 			const auto ptr = GetRoot(key);
 			return ptr ? ptr->As<T>() : nullptr;
@@ -106,19 +407,90 @@ namespace Reflector
 		/// Objects
 		/// ///////////////////////////////// ///
 
-		static std::unordered_set<Reflectable*> const& Objects();
+		/// Iterates over the live objects on the heap, page by page
+		struct ObjectIterator
+		{
+			using value_type = Reflectable*;
+			using difference_type = ptrdiff_t;
+
+			ObjectIterator() noexcept = default;
+			explicit ObjectIterator(std::span<HeapPage* const> pages) noexcept : mPages(pages) { SkipToLive(); }
+
+			Reflectable* operator*() const noexcept { return static_cast<Reflectable*>(mPages[mPageIndex]->SlotAt(mSlotIndex)); }
+			ObjectIterator& operator++() noexcept { ++mSlotIndex; SkipToLive(); return *this; }
+			ObjectIterator operator++(int) noexcept { auto result = *this; ++*this; return result; }
+
+			bool operator==(ObjectIterator const& other) const noexcept { return mPageIndex == other.mPageIndex && mSlotIndex == other.mSlotIndex; }
+			bool operator==(std::default_sentinel_t) const noexcept { return mPageIndex >= mPages.size(); }
+
+		private:
+
+			std::span<HeapPage* const> mPages;
+			size_t mPageIndex = 0;
+			size_t mSlotIndex = 0;
+
+			void SkipToLive() noexcept
+			{
+				for (; mPageIndex < mPages.size(); ++mPageIndex, mSlotIndex = 0)
+				{
+					mSlotIndex = mPages[mPageIndex]->NextLiveSlot(mSlotIndex);
+					if (mSlotIndex < mPages[mPageIndex]->SlotCount)
+						return;
+				}
+				mSlotIndex = 0;
+			}
+		};
+
+		struct ObjectRange : std::ranges::view_interface<ObjectRange>
+		{
+			ObjectRange() noexcept = default;
+			explicit ObjectRange(std::span<HeapPage* const> pages) noexcept : mPages(pages) {}
+
+			ObjectIterator begin() const noexcept { return ObjectIterator{ mPages }; }
+			std::default_sentinel_t end() const noexcept { return {}; }
+
+		private:
+
+			std::span<HeapPage* const> mPages;
+		};
 
+		/// NOTE: Creating or collecting objects while iterating over the range invalidates it
+		ObjectRange Objects() const { return ObjectRange{ Pages() }; }
+		size_t ObjectCount() const;
+
+		/// All objects are allocated from pages of objects of the same class
+		std::span<HeapPage* const> Pages() const { return mPages; }
+		/// The pages holding objects of exactly the given class
+		std::span<HeapPage* const> PagesOf(Class const* klass) const;
+
+		/// Iterates over the objects of type T and its subclasses; only the pages of those classes are visited.
+		/// NOTE: Creating or collecting objects while iterating over the range invalidates it
 		template <typename T>
-		static auto ObjectsOfType()
+		auto ObjectsOfType() const
 		{
 			static_assert(derives_from_reflectable<T>, "Only reflectable classes can be iterated on");
 
-			return Objects() | std::views::filter([](auto* ptr) { return ptr->template Is<T>(); }) | std::views::transform([](auto* ptr) { return (T*)ptr; });
+			if constexpr (std::same_as<T, Reflectable>)
+				return Objects();
+			else
+			{
+				/// The reflection database doesn't change at runtime, so the subclasses of T only need to be found once
+				static const auto classes = [] {
+					std::vector<Class const*> result{ &T::StaticGetReflectionData() };
+					ForEachClass([&](Class const* klass) { result.push_back(klass); }, T::StaticGetReflectionData());
+					return result;
+				}();
+
+				return classes
+					| std::views::transform([this](Class const* klass) { return ObjectRange{ PagesOf(klass) }; })
+					| std::views::join
+					| std::views::transform([](Reflectable* ptr) { return static_cast<T*>(ptr); });
+			}
 		}
 
 		/// Creates a new object of type T, and adds it to the GC heap.
 		template <typename T, typename... ARGS>
-		static T* New(ARGS&&... args)
+		T* New(ARGS&&... args)
 		{
 			static_assert(derives_from_reflectable<T>, "Only reflectable classes can be New()ed");
 
@@ -130,63 +502,375 @@ namespace Reflector
 
 		/// Creates a new object of type T, and sets it as a root with the given name.
 		template <typename T>
-		static T* NewRoot(std::string_view name)
+		T* NewRoot(std::string_view name)
 		{
 			auto ptr = New<T>();
 			SetRoot(name, ptr);
 			return ptr;
 		}
 
+		/// Destroys all objects and frees all pages.
+		/// If `run_destructors` is false, the objects are dropped without being destroyed, which takes time proportional to the
+		/// number of pages rather than objects; only do this if the objects don't own anything outside of the heap.
+		void Clear(bool run_destructors = true);
+
 		/// ///////////////////////////////// ///
 		/// Collection
 		/// ///////////////////////////////// ///
 
 		/// Frees all memory allocated by the GC that can be reclaimed.
 		/// Specifically, will NOT destroy any living objects.
-		static void MinimizeMemory();
+		/// Pages that become empty are freed by the sweep, except those that threads allocate from; this frees the ones of the calling thread.
+		void MinimizeMemory();
+
+		/// The number of bytes allocated for heap pages
+		size_t AllocatedBytes() const;
 
 		/// Collects garbage
 		/// Marks all roots (both given as arguments, and those in Roots()), 
 		/// then marks all objects reachable from the roots, then sweeps all unmarked objects.
 		template <typename... ROOTS>
-		static void Collect(ROOTS&... roots)
+		void Collect(ROOTS&... roots)
+		{
+			MarkingScope marking{ *this };
+
+			/// Finish the incremental collection in progress, if any
+			if (mPhase == Phase::Mark)
+				(Reflector::GCMark(roots), ...);
+			while (mPhase != Phase::Idle)
+				Step(std::numeric_limits<size_t>::max());
+
+			StartCycle();
+			(Reflector::GCMark(roots), ...);
+			MarkAll();
+			Step(std::numeric_limits<size_t>::max());
+		}
+
+		/// Collects garbage among the young objects only, i.e. those created since the last collection; old objects are only
+		/// freed by `Collect` (or `Step`), which should still be called once in a while.
+		/// Most objects die young, so this is usually much faster than `Collect`, but requires that all pointers to heap objects
+		/// stored in heap objects are followed by a `WriteBarrier` call (generated setters do this automatically).
+		/// If an incremental collection is in progress, it's finished instead.
+		template <typename... ROOTS>
+		void CollectMinor(ROOTS&... roots)
 		{
+			MarkingScope marking{ *this };
+
+			if (mPhase != Phase::Idle)
+			{
+				if (mPhase == Phase::Mark)
+					(Reflector::GCMark(roots), ...);
+				while (mPhase != Phase::Idle)
+					Step(std::numeric_limits<size_t>::max());
+				return;
+			}
+
+			StartMinorCycle();
 			(Reflector::GCMark(roots), ...);
-			Mark();
-			Sweep();
+			MarkAll();
+			Step(std::numeric_limits<size_t>::max());
 		}
 
+		/// Sets the number of threads `Collect` uses to mark objects; 1 (the default) marks on the calling thread only.
+		/// Incremental collection (`Step`) always marks on the calling thread.
+		/// NOTE: With more than one thread, the `GCMark` functions of all classes (including user overloads) will be called
+		/// from multiple threads at once, so they must not modify anything but the mark flags.
+		void SetMarkThreadCount(size_t count);
+		size_t MarkThreadCount() const;
+
 		static void GCMark(auto) noexcept {}
 
+		/// ///////////////////////////////// ///
+		/// Threads
+		/// ///////////////////////////////// ///
+
+		/// Each thread allocates objects from pages (one per class) that it owns, so creating objects only takes a lock when
+		/// a thread runs out of room in its page.
+		/// Threads that use heap objects while another thread might be collecting must be attached to the heap, and must call
+		/// `Safepoint` regularly; a collecting thread waits until all attached threads are parked in a safepoint or a safe region.
+		/// NOTE: As with `Step`, objects that are only referenced from outside the heap and its roots are not safe to keep
+		/// across safepoints.
+		void AttachThread();
+		/// Also gives back the pages the thread allocates from
+		void DetachThread();
+
+		/// Parks the calling thread while another thread has the world stopped
+		void Safepoint()
+		{
+			if (mStopRequested.load(std::memory_order_acquire))
+				ParkAtSafepoint();
+		}
+
+		/// While in a safe region, the thread counts as parked, so it must not touch any heap objects;
+		/// meant for blocking operations, like waiting for jobs
+		void EnterSafeRegion();
+		/// Waits until the world is resumed, if it's stopped
+		void LeaveSafeRegion();
+
+		struct SafeRegion
+		{
+			explicit SafeRegion(Heap& heap) : mHeap(heap) { mHeap.EnterSafeRegion(); }
+			~SafeRegion() { mHeap.LeaveSafeRegion(); }
+			SafeRegion(SafeRegion const&) = delete;
+			SafeRegion& operator=(SafeRegion const&) = delete;
+
+		private:
+
+			Heap& mHeap;
+		};
+
+		/// Waits until all attached threads (other than the calling one) are parked, and keeps them parked until `ResumeTheWorld`
+		void StopTheWorld();
+		void ResumeTheWorld();
+
+		struct StoppedWorld
+		{
+			explicit StoppedWorld(Heap& heap) : mHeap(heap) { mHeap.StopTheWorld(); }
+			~StoppedWorld() { mHeap.ResumeTheWorld(); }
+			StoppedWorld(StoppedWorld const&) = delete;
+			StoppedWorld& operator=(StoppedWorld const&) = delete;
+
+		private:
+
+			Heap& mHeap;
+		};
+
+		/// Like `Collect`, but stops the world while collecting
+		template <typename... ROOTS>
+		void CollectAtSafepoint(ROOTS&... roots)
+		{
+			StoppedWorld stopped{ *this };
+			Collect(roots...);
+		}
+
+		/// Like `CollectMinor`, but stops the world while collecting
+		template <typename... ROOTS>
+		void CollectMinorAtSafepoint(ROOTS&... roots)
+		{
+			StoppedWorld stopped{ *this };
+			CollectMinor(roots...);
+		}
+
+		enum class Phase { Idle, Mark, Sweep };
+
+		Phase CurrentPhase() const noexcept { return mPhase; }
+
+		/// Advances the incremental collection by at most `work_budget` units of work (marking the fields of,
+		/// or sweeping, a single object), starting a new collection if none is in progress.
+		/// As pages are swept whole, a step may go over the budget by at most a page's worth of objects.
+		/// Returns true if the collection was finished by this call.
+		bool Step(size_t work_budget);
+
+		/// Like `Step(size_t)`, but works until the time budget runs out
+		bool Step(std::chrono::nanoseconds time_budget);
+
+		/// Must be called after a pointer to a heap object is stored in `obj` (or any of its subobjects), if an incremental
+		/// collection might be in progress, or minor collections are used. Generated setters call this automatically.
+		static void WriteBarrier(Reflectable const* obj) noexcept
+		{
+			const auto heap = Of(obj);
+			if (!heap || !obj->GC_IsMarked())
+				return;
+
+			/// Black objects that are modified while marking are marked gray again, so that their fields are marked again
+			if (heap->mPhase == Phase::Mark)
+			{
+				if (!obj->GC_IsGray())
+					ShadeFromMutator(obj);
+			}
+			/// Otherwise, marked objects are old, and once modified might point to young objects
+			else if (!obj->GC_IsDirty())
+				RememberFromMutator(obj);
+		}
+
+		/// The number of old objects modified since the last collection
+		size_t RememberedObjectCount() const;
+
+		/// Marks the object and puts it into the gray worklist of its heap, if that heap is being marked by the calling thread;
+		/// used by `GCMark`
+		static void Shade(Reflectable const* obj);
+
+		/// ///////////////////////////////// ///
+		/// Compaction
+		/// ///////////////////////////////// ///
+
+		/// Collects garbage, then moves objects out of pages that are at most `max_occupancy` full into fuller pages of
+		/// the same class, and frees the pages that are left empty. Returns the number of objects moved.
+		/// Pointers to moved objects are updated in the roots and in the fields described by the pointer maps of the objects
+		/// (see `GCPointerMap`); objects pointed to by fields the maps can't describe are not moved, and only objects of classes
+		/// with the `Relocatable` attribute are moved at all (see `Class::Relocate`).
+		/// NOTE: Pointers to heap objects held outside of the heap are NOT updated; objects whose address escapes
+		/// (e.g. to native code) must be pinned (see `Pin`). Must be called while no other thread is using the heap.
+		size_t Compact(double max_occupancy = 0.5);
+
+		/// Like `Compact`, but stops the world while compacting
+		size_t CompactAtSafepoint(double max_occupancy = 0.5)
+		{
+			StoppedWorld stopped{ *this };
+			return Compact(max_occupancy);
+		}
+
+		/// Pinned objects are never moved by `Compact`. Pins are counted, so an object stays pinned until it's unpinned
+		/// as many times as it was pinned.
+		void Pin(Reflectable const* obj);
+		void Unpin(Reflectable const* obj);
+		bool IsPinned(Reflectable const* obj) const;
+
+		/// ///////////////////////////////// ///
+		/// Statistics
+		/// ///////////////////////////////// ///
+
+		/// Walks all pages of the heap, so don't call it while other threads are creating objects
+		HeapStatistics GetStatistics() const;
+
+		/// The statistics of the last finished collection
+		CollectionStatistics const& LastCollection() const noexcept { return mLastCollection; }
+
+		/// Sets the function called at the end of each collection, on the thread that finished it.
+		/// NOTE: The callback must not create objects on, or collect, the heap.
+		void SetCollectionCallback(std::function<void(Heap&, CollectionStatistics const&)> callback);
+
 		/// ///////////////////////////////// ///
 		/// Serialization
 		/// ///////////////////////////////// ///
 
 #if REFLECTOR_USES_JSON && defined(NLOHMANN_JSON_NAMESPACE_BEGIN)
+		/// Resolves a serialized pointer to a heap object: while a heap is being loaded by the calling thread (see `FromJson`),
+		/// in the heap being loaded, otherwise in the current heap (see `Current`)
 		template <derives_from_reflectable T>
 		static void ResolveHeapObject(T*& p, std::string_view obj_type, intptr_t obj_id)
 		{
 			Reflectable const* r = p;
-			ResolveHeapObject(&T::StaticGetReflectionData(), r, obj_type, obj_id);
+			(mLoadingHeap ? *mLoadingHeap : Current()).ResolveObject(&T::StaticGetReflectionData(), r, obj_type, obj_id);
 			p = const_cast<T*>(static_cast<T const*>(r));
 		}
 
-		static REFLECTOR_JSON_TYPE ToJson();
-		static void FromJson(REFLECTOR_JSON_TYPE const&);
+		REFLECTOR_JSON_TYPE ToJson() const;
+		void FromJson(REFLECTOR_JSON_TYPE const&);
 #endif
 
-	private:
+#if defined(REFLECTOR_USES_BINARY) && REFLECTOR_USES_BINARY
+		/// Writes all heap objects and the root set into `out`, in the compact binary format (see `ReflectorBinary.h`).
+		/// Objects are grouped by class and refer to each other by their dense index in the snapshot, which is computed from their slot.
+		/// The same heap always gives the same snapshot.
+		/// Each object is written to the stream as soon as it's serialized, so no in-memory copy of the whole heap is built.
+		void SaveSnapshot(std::ostream& out);
+		/// Replaces the objects and root set of the heap with those written by `SaveSnapshot`.
+		/// All objects are created before any is loaded, so pointers are resolved by a simple lookup in an array.
+		/// If the snapshot is invalid, throws a `DataError` and leaves the heap as it was.
+		void LoadSnapshot(std::istream& in);
+
+		/// Used by the binary serializer of pointers to heap objects, while a snapshot is being saved/loaded by the calling thread
+		static uint64_t SnapshotIndexOf(Reflectable const* obj);
+		static Reflectable* SnapshotObjectAt(uint64_t index);
+#endif
 
-		static void ResolveHeapObject(Class const* type, Reflectable const*& p, std::string_view obj_type, intptr_t obj_id);
+	private:
 
-		static void Clear();
+		/// Unique for each heap, and changed whenever the heap is cleared, so threads know their allocation pages are gone
+		uint64_t mEpoch = 0;
+		/// Unique for each heap, so threads can tell a destroyed heap from a new one at the same address
+		uint64_t mID = 0;
+
+		/// Each page knows its index in this list (`HeapPage::Index`), so it can be removed from it in constant time
+		std::vector<HeapPage*> mPages;
+		/// Pages with free slots, by class
+		std::unordered_map<Class const*, std::vector<HeapPage*>> mAvailablePages;
+		/// All pages, by class; each page knows its index in the list of its class (`HeapPage::ClassIndex`)
+		std::unordered_map<Class const*, std::vector<HeapPage*>> mClassPages;
+		size_t mAllocatedBytes = 0;
+		/// TODO: Force RootSet items to always be in Objects, as serializing depends on it
+		std::map<std::string, Reflectable*, std::less<>> mRoots;
+		/// Guards the page lists and the roots, and serializes write barriers
+		mutable std::mutex mHeapMutex;
+
+		Phase mPhase = Phase::Idle;
+		/// Marked objects whose fields have not yet been marked
+		std::vector<Reflectable const*> mGrayObjects;
+		/// Old (dirty) objects modified since the last collection; minor collections mark their fields, as they might point to young objects
+		std::vector<Reflectable const*> mRememberedObjects;
+		/// While sweeping, all pages at and after this index have already been swept (or were created during the sweep)
+		size_t mSweepCursor = 0;
+		size_t mMarkThreadCount = 1;
+		/// The heap being marked by the calling thread; objects on other heaps are not shaded
+		static inline thread_local Heap* mMarkingHeap = nullptr;
+
+		/// Makes the heap the one being marked by the calling thread, until the end of the scope (even if marking throws)
+		struct MarkingScope
+		{
+			explicit MarkingScope(Heap& heap) noexcept : mPrevious(std::exchange(mMarkingHeap, &heap)) {}
+			~MarkingScope() { mMarkingHeap = mPrevious; }
+			MarkingScope(MarkingScope const&) = delete;
+			MarkingScope& operator=(MarkingScope const&) = delete;
+		private:
+			Heap* mPrevious;
+		};
+
+		CollectionStatistics mCurrentCollection;
+		CollectionStatistics mLastCollection;
+		std::function<void(Heap&, CollectionStatistics const&)> mCollectionCallback;
+		/// Objects created since the start of the last collection in pages that were freed since
+		size_t mFreedPagesAllocationCount = 0;
+		size_t mFreedPagesAllocationBytes = 0;
+		uint64_t mCollectionCount = 0;
+		uint64_t mMinorCollectionCount = 0;
+		uint64_t mTotalObjectsFreed = 0;
+		uint64_t mPagesReused = 0;
+		uint64_t mPagesCreated = 0;
+		uint64_t mTotalObjectsMoved = 0;
+
+		/// Pin counts of pinned objects
+		std::unordered_map<Reflectable const*, size_t> mPinnedObjects;
+
+		std::atomic<bool> mStopRequested = false;
+		std::mutex mSafepointMutex;
+		std::condition_variable mSafepointCondition;
+		size_t mAttachedThreads = 0;
+		/// Attached threads that are in a safepoint or safe region, or are stopping the world
+		size_t mParkedThreads = 0;
 
-		static Reflectable* Add(Reflectable* obj);
-		static void Mark();
-		static void Sweep();
-		static Reflectable* Alloc(Class const* klass_data);
+#if REFLECTOR_USES_JSON && defined(NLOHMANN_JSON_NAMESPACE_BEGIN)
+		std::unordered_map<intptr_t, std::pair<Reflectable*, Class const*>> mLoadingMapping;
+		void ResolveObject(Class const* type, Reflectable const*& p, std::string_view obj_type, intptr_t obj_id);
+#endif
+		/// The heap being loaded by the calling thread, if any
+		static inline thread_local Heap* mLoadingHeap = nullptr;
+
+		void ParkAtSafepoint();
+		static void ShadeFromMutator(Reflectable const* obj);
+		void ShadeObject(Reflectable const* obj);
+		static void RememberFromMutator(Reflectable const* obj);
+		void ForgetRememberedObjects();
+
+		Reflectable* Add(Reflectable* obj);
+		void StartCycle();
+		void StartMinorCycle();
+		void StartCollectionStatistics(bool minor);
+		void FinishCollectionStatistics();
+		void MarkAll();
+		void ParallelMark(size_t thread_count);
+		bool MarkStep(size_t& work_budget);
+		/// Marks the objects the given (gray) object points to
+		static void MarkFields(Reflectable const* obj);
+		bool SweepStep(size_t& work_budget);
+		HeapPage* NewPage(Class const* klass_data);
+		HeapPage* TakeAllocationPage(Class const* klass_data, HeapPage* full_page);
+		struct AllocationBuffer;
+		struct ThreadAllocationBuffers;
+		static thread_local ThreadAllocationBuffers mThreadBuffers;
+		AllocationBuffer& ThreadBuffer();
+		void ReleaseAllocationPages(AllocationBuffer& buffer);
+		void Detach(AllocationBuffer& buffer);
+		void FreePage(HeapPage* page);
+		/// Moves the pages and roots of `other` into this heap, which must be empty; no other thread may be using `other`
+		void TakeContents(Heap& other);
+		void SweepPage(HeapPage* page);
+		std::unordered_set<Reflectable const*> FindUnmovableObjects();
+		void CompactClass(Class const* klass, std::unordered_set<Reflectable const*> const& unmovable, double max_occupancy, std::unordered_map<Reflectable const*, Reflectable*>& moved);
+		void UpdateMovedPointers(std::unordered_map<Reflectable const*, Reflectable*> const& moved);
+		Reflectable* Alloc(Class const* klass_data);
 		template <derives_from_reflectable T>
-		static T* Alloc()
+		T* Alloc()
 		{
 			return (T*)Alloc(&T::StaticGetReflectionData());
 		}
@@ -196,20 +880,32 @@ namespace Reflector
 		friend struct GCRootPointer;
 	};
 
-	/// Creates a new object of type T, and adds it to the global GC heap.
+	inline void GCMark(Reflectable const* r)
+	{
+		if (r && r->GC_IsOnHeap() && !r->GC_IsMarked())
+			Heap::Shade(r);
+	}
+
+	/// Creates a new object of type T, and adds it to the current GC heap (see `Heap::Current`).
 	template <reflected_class T, typename... ARGS>
 	T* New(ARGS&&... args)
 	{
 		if constexpr (derives_from_reflectable<T>)
-			return Heap::New<T>(std::forward<ARGS>(args)...);
+			return Heap::Current().New<T>(std::forward<ARGS>(args)...);
 		else
 			return nullptr;
 	}
 
+	/// Creates the object on the same heap as this object, or on the current heap if this object is not on a heap
 	template <typename T, typename... ARGS>
 	T* Reflectable::New(ARGS&&... args)
 	{
 		static_assert(reflected_class<T>, "Only reflected classes can be created using New<T>()");
+		if constexpr (derives_from_reflectable<T>)
+		{
+			if (const auto heap = Heap::Of(this))
+				return heap->New<T>(std::forward<ARGS>(args)...);
+		}
 		return ::Reflector::New<T>(std::forward<ARGS>(args)...);
 	}
 }
@@ -0,0 +1,793 @@
+#pragma once
+
+#if !(defined(REFLECTOR_USES_JSON_SAX) && REFLECTOR_USES_JSON_SAX) && !(defined(REFLECTOR_USES_JSON_WRITER) && REFLECTOR_USES_JSON_WRITER)
+#error "ReflectorJSON.h requires streaming JSON methods to be generated; include the generated Reflector.h first"
+#endif
+
+#include "ReflectorUtils.h"
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <ostream>
+#include <ranges>
+#include <string>
+#include <vector>
+
+/// Streaming loading and saving of reflected classes from and to JSON, without building a DOM of the whole document.
+///
+/// Loading (`JSONStreamLoad`):
+/// Only available if `JSONOptions::GenerateStreamingLoadMethods` is set, i.e. the generated Reflector.h defines `REFLECTOR_USES_JSON_SAX`.
+///
+/// The loader keeps a stack of sinks, each of which receives the events of a single JSON value:
+/// - reflected classes dispatch their keys to the generated `JSONSAXField` methods, which push the sink for the matching field,
+///   and handle missing fields in the generated `JSONLoadFinish` methods
+/// - sequence containers and string-keyed maps stream their elements
+/// - `std::unique_ptr`s to reflectable classes stream the object if its type field (`$type` or `$guid`) comes before the other fields,
+///   which is always the case for the default `nlohmann::json` (its keys are sorted); otherwise the object is buffered and loaded
+///   through `from_json`
+/// - any other value is buffered into a (small) `REFLECTOR_JSON_TYPE` and converted with `get_to`
+///
+/// Note that if `JSONOptions::IgnoreInvalidObjectFields` is set, only the conversion of buffered values is guarded, errors in
+/// streamed objects and containers still propagate.
+///
+/// Saving (`JSONStreamSave`):
+/// Only available if `JSONOptions::GenerateStreamingSaveMethods` is set, i.e. the generated Reflector.h defines `REFLECTOR_USES_JSON_WRITER`.
+/// The `JSONWriter` writes JSON text directly into a string or a stream. Reflected classes write their fields through the generated
+/// `JSONWriteFields` methods, reflectable objects write their type field (and GUID field) first, so they can be streamed back in.
+/// Arithmetic types, strings, ranges and string-keyed maps are written directly; any other value is converted to a (small)
+/// `REFLECTOR_JSON_TYPE` and dumped.
+/// Unlike with the DOM, fields are written in declaration order instead of being sorted.
+
+#ifndef REFLECTOR_JSON_OBJECT_TYPE_FIELD_NAME
+#define REFLECTOR_JSON_OBJECT_TYPE_FIELD_NAME "$type"
+#endif
+#ifndef REFLECTOR_JSON_OBJECT_GUID_FIELD_NAME
+#define REFLECTOR_JSON_OBJECT_GUID_FIELD_NAME "$guid"
+#endif
+
+namespace Reflector
+{
+	struct JSONSAXLoader;
+	struct JSONWriter;
+
+	/// `std::unique_ptr`s to reflectable classes, which are loaded and saved polymorphically
+	template <typename T>
+	concept json_sax_polymorphic_pointer = requires { typename T::element_type; }
+		&& std::same_as<T, std::unique_ptr<typename T::element_type>>
+		&& derives_from_reflectable<typename T::element_type>;
+
+#if defined(REFLECTOR_USES_JSON_SAX) && REFLECTOR_USES_JSON_SAX
+
+	/// Receives the events of a single JSON value (and for objects and arrays, of its contents).
+	/// `Scalar`, `EndObject` and `EndArray` return true when the value is complete, and the sink can be popped off the stack.
+	struct JSONSAXSink
+	{
+		using json_type = REFLECTOR_JSON_TYPE;
+		using string_type = typename json_type::string_t;
+
+		virtual ~JSONSAXSink() noexcept = default;
+
+		/// Called at the start of each value (scalar, object or array) while this sink is at the top of the stack;
+		/// containers push the sink of their next element here
+		virtual void BeginValue(JSONSAXLoader& loader) {}
+
+		virtual bool Scalar(JSONSAXLoader& loader, json_type&& value) { throw DataError{ "Unexpected JSON value" }; }
+		virtual void StartObject(JSONSAXLoader& loader) { throw DataError{ "Unexpected JSON object" }; }
+		/// Must push the sink for the value of the key
+		virtual void Key(JSONSAXLoader& loader, string_type& key) { throw DataError{ "Unexpected JSON object key" }; }
+		virtual bool EndObject(JSONSAXLoader& loader) { return true; }
+		virtual void StartArray(JSONSAXLoader& loader) { throw DataError{ "Unexpected JSON array" }; }
+		virtual bool EndArray(JSONSAXLoader& loader) { return true; }
+	};
+
+	template <typename T>
+	concept json_sax_loadable_class = requires (T& object, std::string_view key, JSONSAXLoader& loader, JSONLoadedFields& loaded) {
+		{ object.JSONSAXField(uint32_t{}, key, loader, loaded) } -> std::same_as<bool>;
+		object.JSONLoadFinish(loaded);
+	};
+
+	/// Implements the nlohmann SAX interface (see `REFLECTOR_JSON_TYPE::sax_parse`), forwarding the events to the sink at the top of its stack.
+	/// Sinks are allocated from a pool, so a loader can stream any number of values without allocating a sink for each one.
+	struct JSONSAXLoader
+	{
+		using json_type = REFLECTOR_JSON_TYPE;
+		using number_integer_t = typename json_type::number_integer_t;
+		using number_unsigned_t = typename json_type::number_unsigned_t;
+		using number_float_t = typename json_type::number_float_t;
+		using string_t = typename json_type::string_t;
+		using binary_t = typename json_type::binary_t;
+
+		JSONSAXLoader() = default;
+		JSONSAXLoader(JSONSAXLoader const&) = delete;
+		JSONSAXLoader& operator=(JSONSAXLoader const&) = delete;
+		~JSONSAXLoader() noexcept
+		{
+			while (!mSinks.empty())
+				Pop();
+		}
+
+		/// Pushes the sink that will load the next value into `target`
+		template <typename T>
+		void Load(T& target);
+
+		/// Like `Load`, but calls `on_error` instead of propagating errors while converting a buffered value
+		template <typename T, typename ON_ERROR>
+		void Load(T& target, ON_ERROR on_error);
+
+		/// Skips the next value
+		void Skip();
+
+		template <typename SINK, typename... ARGS>
+		SINK& Push(ARGS&&... args)
+		{
+			std::pmr::polymorphic_allocator<> allocator{ &mSinkMemory };
+			const auto sink = allocator.new_object<SINK>(std::forward<ARGS>(args)...);
+			mSinks.push_back({ sink, [](std::pmr::memory_resource& memory, JSONSAXSink* sink) {
+				std::pmr::polymorphic_allocator<>{ &memory }.delete_object(static_cast<SINK*>(sink));
+			} });
+			return *sink;
+		}
+
+		/// True if all pushed values were loaded
+		bool Done() const noexcept { return mSinks.empty(); }
+
+		/// SAX interface
+
+		bool null() { return Value(nullptr); }
+		bool boolean(bool val) { return Value(val); }
+		bool number_integer(number_integer_t val) { return Value(val); }
+		bool number_unsigned(number_unsigned_t val) { return Value(val); }
+		bool number_float(number_float_t val, string_t const&) { return Value(val); }
+		bool string(string_t& val) { return Value(std::move(val)); }
+		bool binary(binary_t&) { throw DataError{ "Binary JSON values are not supported" }; }
+
+		bool start_object(size_t)
+		{
+			BeginValue().StartObject(*this);
+			return true;
+		}
+
+		bool key(string_t& val)
+		{
+			Top().Key(*this, val);
+			return true;
+		}
+
+		bool end_object()
+		{
+			if (Top().EndObject(*this))
+				Pop();
+			return true;
+		}
+
+		bool start_array(size_t)
+		{
+			BeginValue().StartArray(*this);
+			return true;
+		}
+
+		bool end_array()
+		{
+			if (Top().EndArray(*this))
+				Pop();
+			return true;
+		}
+
+		template <typename EXCEPTION>
+		bool parse_error(size_t position, std::string const& last_token, EXCEPTION const& ex)
+		{
+			throw DataError{ std::format("{} (at byte {}, near '{}')", ex.what(), position, last_token) };
+		}
+
+	private:
+
+		struct Frame
+		{
+			JSONSAXSink* Sink;
+			void(*Delete)(std::pmr::memory_resource&, JSONSAXSink*);
+		};
+
+		std::pmr::unsynchronized_pool_resource mSinkMemory;
+		std::vector<Frame> mSinks;
+
+		JSONSAXSink& Top()
+		{
+			if (mSinks.empty())
+				throw DataError{ "Unexpected JSON data after the end of the loaded value" };
+			return *mSinks.back().Sink;
+		}
+
+		JSONSAXSink& BeginValue()
+		{
+			Top().BeginValue(*this);
+			return Top();
+		}
+
+		void Pop() noexcept
+		{
+			const auto frame = mSinks.back();
+			mSinks.pop_back();
+			frame.Delete(mSinkMemory, frame.Sink);
+		}
+
+		bool Value(json_type value)
+		{
+			if (BeginValue().Scalar(*this, std::move(value)))
+				Pop();
+			return true;
+		}
+	};
+
+	/// Skips a value and all its contents
+	struct JSONSAXSkipSink : JSONSAXSink
+	{
+		bool Scalar(JSONSAXLoader&, json_type&&) override { return mDepth == 0; }
+		void StartObject(JSONSAXLoader&) override { ++mDepth; }
+		void Key(JSONSAXLoader&, string_type&) override {}
+		bool EndObject(JSONSAXLoader&) override { return --mDepth == 0; }
+		void StartArray(JSONSAXLoader&) override { ++mDepth; }
+		bool EndArray(JSONSAXLoader&) override { return --mDepth == 0; }
+
+	private:
+
+		size_t mDepth = 0;
+	};
+
+	/// Builds a `REFLECTOR_JSON_TYPE` out of a value
+	struct JSONSAXDOMSink : JSONSAXSink
+	{
+		explicit JSONSAXDOMSink(json_type& target) noexcept : mTarget(target) {}
+
+		bool Scalar(JSONSAXLoader&, json_type&& value) override
+		{
+			Add(std::move(value));
+			return mStack.empty();
+		}
+		void StartObject(JSONSAXLoader&) override { mStack.push_back(Add(json_type::object())); }
+		void Key(JSONSAXLoader&, string_type& key) override { mKey = std::move(key); }
+		bool EndObject(JSONSAXLoader&) override
+		{
+			mStack.pop_back();
+			return mStack.empty();
+		}
+		void StartArray(JSONSAXLoader&) override { mStack.push_back(Add(json_type::array())); }
+		bool EndArray(JSONSAXLoader&) override
+		{
+			mStack.pop_back();
+			return mStack.empty();
+		}
+
+	private:
+
+		json_type& mTarget;
+		/// Only holds the objects and arrays we are in, so adding elements to them can't invalidate it
+		std::vector<json_type*> mStack;
+		string_type mKey;
+
+		json_type* Add(json_type&& value)
+		{
+			if (mStack.empty())
+			{
+				mTarget = std::move(value);
+				return &mTarget;
+			}
+			auto& parent = *mStack.back();
+			if (parent.is_object())
+				return &(parent[mKey] = std::move(value));
+			parent.push_back(std::move(value));
+			return &parent.back();
+		}
+	};
+
+	/// Buffers a value and converts it to `T` with `get_to`
+	template <typename T, typename ON_ERROR = std::nullptr_t>
+	struct JSONSAXValueSink : JSONSAXDOMSink
+	{
+		explicit JSONSAXValueSink(T& target, ON_ERROR on_error = {}) : JSONSAXDOMSink(mValue), mTarget(target), mOnError(std::move(on_error)) {}
+
+		bool Scalar(JSONSAXLoader& loader, json_type&& value) override { return JSONSAXDOMSink::Scalar(loader, std::move(value)) && Convert(); }
+		bool EndObject(JSONSAXLoader& loader) override { return JSONSAXDOMSink::EndObject(loader) && Convert(); }
+		bool EndArray(JSONSAXLoader& loader) override { return JSONSAXDOMSink::EndArray(loader) && Convert(); }
+
+	private:
+
+		T& mTarget;
+		ON_ERROR mOnError;
+		json_type mValue;
+
+		bool Convert()
+		{
+			if constexpr (std::same_as<ON_ERROR, std::nullptr_t>)
+				mValue.get_to(mTarget);
+			else
+			{
+				try { mValue.get_to(mTarget); }
+				catch (...) { mOnError(); }
+			}
+			return true;
+		}
+	};
+
+	/// Dispatches the keys of an object to the generated `JSONSAXField` method of a reflected class
+	template <json_sax_loadable_class T>
+	struct JSONSAXObjectSink : JSONSAXSink
+	{
+		explicit JSONSAXObjectSink(T& target) noexcept : mTarget(target) {}
+
+		bool Scalar(JSONSAXLoader&, json_type&&) override { throw DataError{ "JSON source is not an object" }; }
+		void StartObject(JSONSAXLoader&) override {}
+		void Key(JSONSAXLoader& loader, string_type& key) override
+		{
+			if (!mTarget.JSONSAXField(FieldNameHash(key), key, loader, mLoaded))
+				loader.Skip();
+		}
+		bool EndObject(JSONSAXLoader&) override
+		{
+			mTarget.JSONLoadFinish(mLoaded);
+			return true;
+		}
+		void StartArray(JSONSAXLoader&) override { throw DataError{ "JSON source is not an object" }; }
+
+	private:
+
+		T& mTarget;
+		JSONLoadedFields mLoaded;
+	};
+
+	template <typename T>
+	concept json_sax_sequence = !columnar_vector<T> && requires (T& container) {
+		{ container.emplace_back() } -> std::same_as<typename T::value_type&>;
+		container.clear();
+	};
+
+	/// Streams the elements of an array into a sequence container
+	template <json_sax_sequence T>
+	struct JSONSAXSequenceSink : JSONSAXSink
+	{
+		explicit JSONSAXSequenceSink(T& target) noexcept : mTarget(target) {}
+
+		void BeginValue(JSONSAXLoader& loader) override
+		{
+			if (mStarted)
+				loader.Load(mTarget.emplace_back());
+		}
+		bool Scalar(JSONSAXLoader&, json_type&&) override { throw DataError{ "JSON source is not an array" }; }
+		void StartObject(JSONSAXLoader&) override { throw DataError{ "JSON source is not an array" }; }
+		void StartArray(JSONSAXLoader&) override
+		{
+			mTarget.clear();
+			mStarted = true;
+		}
+
+	private:
+
+		T& mTarget;
+		bool mStarted = false;
+	};
+
+	template <typename T>
+	concept json_sax_string_map = std::constructible_from<typename T::key_type, std::string&&> && requires (T& map, typename T::key_type&& key) {
+		{ map[std::move(key)] } -> std::same_as<typename T::mapped_type&>;
+		map.clear();
+	};
+
+	/// Streams the values of an object into a string-keyed map
+	template <json_sax_string_map T>
+	struct JSONSAXMapSink : JSONSAXSink
+	{
+		explicit JSONSAXMapSink(T& target) noexcept : mTarget(target) {}
+
+		bool Scalar(JSONSAXLoader&, json_type&&) override { throw DataError{ "JSON source is not an object" }; }
+		void StartObject(JSONSAXLoader&) override { mTarget.clear(); }
+		void Key(JSONSAXLoader& loader, string_type& key) override { loader.Load(mTarget[typename T::key_type(std::move(key))]); }
+		void StartArray(JSONSAXLoader&) override { throw DataError{ "JSON source is not an object" }; }
+
+	private:
+
+		T& mTarget;
+	};
+
+	/// Loads a polymorphic object; streams its fields if the type field comes first, otherwise buffers it and uses `from_json`
+	template <typename T>
+	requires derives_from_reflectable<T>
+	struct JSONSAXPolymorphicSink : JSONSAXSink
+	{
+		explicit JSONSAXPolymorphicSink(std::unique_ptr<T>& target) noexcept : mTarget(target) {}
+
+		bool Scalar(JSONSAXLoader& loader, json_type&& value) override
+		{
+			if (mBuffer)
+				return mBuffer->Scalar(loader, std::move(value)) && FinishBuffered();
+			if (!value.is_null())
+				throw DataError{ "JSON source is not an object" };
+			mTarget.reset();
+			return true;
+		}
+
+		void StartObject(JSONSAXLoader& loader) override
+		{
+			if (mBuffer)
+				mBuffer->StartObject(loader);
+		}
+
+		void Key(JSONSAXLoader& loader, string_type& key) override
+		{
+			if (mBuffer)
+				return mBuffer->Key(loader, key);
+
+			if (!mStreaming)
+			{
+				if (key == REFLECTOR_JSON_OBJECT_TYPE_FIELD_NAME)
+					return loader.Load(mType);
+				if (key == REFLECTOR_JSON_OBJECT_GUID_FIELD_NAME)
+					return loader.Load(mGUID);
+
+				if (mType.empty() && mGUID.empty())
+				{
+					/// The type comes after other fields, so we don't know where to put them yet
+					mBuffer.emplace(mBuffered);
+					mBuffer->StartObject(loader);
+					return mBuffer->Key(loader, key);
+				}
+
+				Construct();
+			}
+
+			if (!mTarget->JSONSAXField(FieldNameHash(key), key, loader, mLoaded))
+				loader.Skip();
+		}
+
+		bool EndObject(JSONSAXLoader& loader) override
+		{
+			if (mBuffer)
+				return mBuffer->EndObject(loader) && FinishBuffered();
+
+			if (!mStreaming)
+				Construct();
+			mTarget->JSONLoadFinish(mLoaded);
+			return true;
+		}
+
+		void StartArray(JSONSAXLoader& loader) override
+		{
+			if (!mBuffer)
+				throw DataError{ "JSON source is not an object" };
+			mBuffer->StartArray(loader);
+		}
+
+		bool EndArray(JSONSAXLoader& loader) override
+		{
+			return mBuffer->EndArray(loader) && FinishBuffered();
+		}
+
+	private:
+
+		std::unique_ptr<T>& mTarget;
+		std::string mType;
+		std::string mGUID;
+		bool mStreaming = false;
+		JSONLoadedFields mLoaded;
+		json_type mBuffered;
+		std::optional<JSONSAXDOMSink> mBuffer;
+
+		/// Creates the object the same way `adl_serializer<std::unique_ptr<T>>::from_json` does
+		void Construct()
+		{
+			mStreaming = true;
+
+			Class const* klass = mType.empty() ? nullptr : FindClassByFullType(mType);
+			if (!klass && !mGUID.empty())
+				klass = FindClassByGUID(mGUID);
+			if (!klass)
+			{
+				if (mType.empty())
+					throw DataError{ std::format("JSON source does not contain a '{}' field", REFLECTOR_JSON_OBJECT_TYPE_FIELD_NAME) };
+				throw DataError{ std::format("Unknown reflectable type '{}'", mType) };
+			}
+
+			if (mTarget && &mTarget->GetReflectionData() == klass)
+				return;
+
+			mTarget.reset();
+			/// Using `New` so that the object can be freed by `std::unique_ptr`
+			const auto ptr = static_cast<Reflectable*>(klass->New());
+			if (!ptr)
+				throw UserError{ std::format("Could not construct object of type '{}' - type has no default constructor", klass->FullType) };
+			mTarget = std::unique_ptr<T>{ dynamic_cast<T*>(ptr) };
+			if (!mTarget)
+				throw UserError{ std::format("Could not pass constructed object of type '{}' to pointer of type '{}'", klass->FullType, T::StaticGetReflectionData().Name) };
+		}
+
+		bool FinishBuffered()
+		{
+			mBuffered.get_to(mTarget);
+			return true;
+		}
+	};
+
+	template <typename T>
+	void JSONSAXLoader::Load(T& target)
+	{
+		if constexpr (std::same_as<T, json_type>)
+			Push<JSONSAXDOMSink>(target);
+		else if constexpr (json_sax_loadable_class<T>)
+			Push<JSONSAXObjectSink<T>>(target);
+		else if constexpr (json_sax_polymorphic_pointer<T>)
+			Push<JSONSAXPolymorphicSink<typename T::element_type>>(target);
+		else if constexpr (json_sax_sequence<T>)
+			Push<JSONSAXSequenceSink<T>>(target);
+		else if constexpr (json_sax_string_map<T>)
+			Push<JSONSAXMapSink<T>>(target);
+		else
+			Push<JSONSAXValueSink<T>>(target);
+	}
+
+	template <typename T, typename ON_ERROR>
+	void JSONSAXLoader::Load(T& target, ON_ERROR on_error)
+	{
+		if constexpr (std::same_as<T, json_type> || json_sax_loadable_class<T> || json_sax_sequence<T> || json_sax_string_map<T>)
+			Load(target);
+		else if constexpr (json_sax_polymorphic_pointer<T>)
+			Load(target);
+		else
+			Push<JSONSAXValueSink<T, ON_ERROR>>(target, std::move(on_error));
+	}
+
+	inline void JSONSAXLoader::Skip()
+	{
+		Push<JSONSAXSkipSink>();
+	}
+
+	/// Loads `object` from `input` (anything `REFLECTOR_JSON_TYPE::sax_parse` accepts, e.g. a string or an `std::istream`), without building a DOM
+	template <typename T, typename INPUT>
+	void JSONStreamLoad(INPUT&& input, T& object)
+	{
+		JSONSAXLoader loader;
+		loader.Load(object);
+		REFLECTOR_JSON_TYPE::sax_parse(std::forward<INPUT>(input), &loader);
+		if (!loader.Done())
+			throw DataError{ "Unexpected end of JSON data" };
+	}
+
+#endif
+
+#if defined(REFLECTOR_USES_JSON_WRITER) && REFLECTOR_USES_JSON_WRITER
+
+	template <typename T>
+	concept json_writable_class = requires (T const& object, JSONWriter& writer) {
+		object.JSONWriteFields(writer);
+	};
+
+	template <typename T>
+	concept json_writable_string = std::convertible_to<T const&, std::string_view> && !std::same_as<T, std::nullptr_t>;
+
+	template <typename T>
+	concept json_writable_string_map = std::ranges::input_range<T const> && requires {
+		typename T::key_type;
+		typename T::mapped_type;
+	} && json_writable_string<typename T::key_type>;
+
+	/// Excludes types that are ranges of themselves, like `std::filesystem::path`, and columnar vectors, which are written through their `adl_serializer`
+	template <typename T>
+	concept json_writable_range = std::ranges::input_range<T const> && !std::same_as<std::ranges::range_value_t<T const>, T> && !columnar_vector<T>;
+
+	/// Writes JSON text directly into a string (or a stream, through an internal buffer), without building a DOM
+	struct JSONWriter
+	{
+		explicit JSONWriter(std::string& output) noexcept : mOutput(output) {}
+		explicit JSONWriter(std::ostream& stream) noexcept : mOutput(mBuffer), mStream(&stream) {}
+		JSONWriter(JSONWriter const&) = delete;
+		JSONWriter& operator=(JSONWriter const&) = delete;
+		~JSONWriter() { Flush(); }
+
+		void BeginObject() { BeginValue(); mOutput += '{'; mNeedsComma = false; }
+		void EndObject() { mOutput += '}'; EndValue(); }
+		void BeginArray() { BeginValue(); mOutput += '['; mNeedsComma = false; }
+		void EndArray() { mOutput += ']'; EndValue(); }
+
+		void Key(std::string_view key)
+		{
+			BeginValue();
+			WriteString(key);
+			mOutput += ':';
+			mAfterKey = true;
+		}
+
+		void Null() { BeginValue(); mOutput += "null"; EndValue(); }
+		void Bool(bool value) { BeginValue(); mOutput += value ? "true" : "false"; EndValue(); }
+		void String(std::string_view value) { BeginValue(); WriteString(value); EndValue(); }
+
+		template <typename T>
+		requires std::integral<T> && (!std::same_as<T, bool>)
+		void Integer(T value)
+		{
+			BeginValue();
+			char buffer[24];
+			const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			mOutput.append(buffer, end);
+			EndValue();
+		}
+
+		/// Like `REFLECTOR_JSON_TYPE::dump`, non-finite numbers are written as `null`, and integral numbers get a `.0`
+		void Float(double value)
+		{
+			if (!std::isfinite(value))
+				return Null();
+			BeginValue();
+			char buffer[32];
+			const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			mOutput.append(buffer, end);
+			if (std::string_view{ buffer, end }.find_first_of(".eE") == std::string_view::npos)
+				mOutput += ".0";
+			EndValue();
+		}
+
+		/// Writes an already serialized JSON value
+		void Raw(std::string_view json)
+		{
+			BeginValue();
+			mOutput += json;
+			EndValue();
+		}
+
+		template <typename T>
+		void Field(std::string_view key, T const& value)
+		{
+			Key(key);
+			Value(value);
+		}
+
+		template <json_writable_class T>
+		void Object(T const& object)
+		{
+			BeginObject();
+			if constexpr (derives_from_reflectable<T>)
+			{
+				auto const& klass = object.GetReflectionData();
+				Field(REFLECTOR_JSON_OBJECT_TYPE_FIELD_NAME, std::string_view{ klass.FullType });
+				if (!std::string_view{ klass.GUID }.empty())
+					Field(REFLECTOR_JSON_OBJECT_GUID_FIELD_NAME, std::string_view{ klass.GUID });
+			}
+			object.JSONWriteFields(*this);
+			EndObject();
+		}
+
+		template <typename T>
+		void Value(T const& value);
+
+		/// Writes the buffered text to the stream, if writing to a stream
+		void Flush()
+		{
+			if (mStream && !mBuffer.empty())
+			{
+				mStream->write(mBuffer.data(), std::streamsize(mBuffer.size()));
+				mBuffer.clear();
+			}
+		}
+
+	private:
+
+		static constexpr size_t StreamBufferSize = 64 * 1024;
+
+		std::string mBuffer;
+		std::string& mOutput;
+		std::ostream* mStream = nullptr;
+		bool mNeedsComma = false;
+		bool mAfterKey = false;
+
+		void BeginValue()
+		{
+			if (mAfterKey)
+				mAfterKey = false;
+			else if (mNeedsComma)
+				mOutput += ',';
+		}
+
+		void EndValue()
+		{
+			mNeedsComma = true;
+			if (mStream && mBuffer.size() >= StreamBufferSize)
+				Flush();
+		}
+
+		void WriteString(std::string_view str)
+		{
+			static constexpr char hex_digits[] = "0123456789abcdef";
+			mOutput += '"';
+			size_t run_start = 0;
+			for (size_t i = 0; i < str.size(); ++i)
+			{
+				const auto c = static_cast<unsigned char>(str[i]);
+				if (c >= 0x20 && c != '"' && c != '\\')
+					continue;
+				mOutput.append(str.substr(run_start, i - run_start));
+				run_start = i + 1;
+				switch (c)
+				{
+				case '"': mOutput += "\\\""; break;
+				case '\\': mOutput += "\\\\"; break;
+				case '\b': mOutput += "\\b"; break;
+				case '\f': mOutput += "\\f"; break;
+				case '\n': mOutput += "\\n"; break;
+				case '\r': mOutput += "\\r"; break;
+				case '\t': mOutput += "\\t"; break;
+				default:
+					mOutput += "\\u00";
+					mOutput += hex_digits[c >> 4];
+					mOutput += hex_digits[c & 0xF];
+				}
+			}
+			mOutput.append(str.substr(run_start));
+			mOutput += '"';
+		}
+	};
+
+	template <typename T>
+	void JSONWriter::Value(T const& value)
+	{
+		if constexpr (std::same_as<T, REFLECTOR_JSON_TYPE>)
+			Raw(value.dump());
+		else if constexpr (json_writable_class<T>)
+			Object(value);
+		else if constexpr (json_sax_polymorphic_pointer<T>)
+		{
+			if (value)
+				Object(*value);
+			else
+				Null();
+		}
+		else if constexpr (std::same_as<T, bool>)
+			Bool(value);
+		else if constexpr (std::integral<T>)
+			Integer(value);
+		else if constexpr (std::floating_point<T>)
+			Float(double(value));
+		else if constexpr (json_writable_string<T>)
+			String(std::string_view{ value });
+		else if constexpr (json_writable_string_map<T>)
+		{
+			BeginObject();
+			for (auto const& [key, element] : value)
+				Field(std::string_view{ key }, element);
+			EndObject();
+		}
+		else if constexpr (json_writable_range<T>)
+		{
+			BeginArray();
+			for (auto&& element : value)
+				Value(static_cast<std::ranges::range_value_t<T const> const&>(element));
+			EndArray();
+		}
+		else
+			Raw(REFLECTOR_JSON_TYPE(value).dump());
+	}
+
+	/// Saves `object` as JSON text into `output`, without building a DOM
+	template <typename T>
+	void JSONStreamSave(std::string& output, T const& object)
+	{
+		JSONWriter writer{ output };
+		writer.Value(object);
+	}
+
+	template <typename T>
+	std::string JSONStreamSave(T const& object)
+	{
+		std::string result;
+		JSONStreamSave(result, object);
+		return result;
+	}
+
+	template <typename T>
+	void JSONStreamSave(std::ostream& output, T const& object)
+	{
+		JSONWriter writer{ output };
+		writer.Value(object);
+	}
+
+#endif
+}
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "ReflectorClasses.h"
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <span>
 
 namespace Reflector
 {
@@ -22,6 +26,50 @@ namespace Reflector
 	extern Class const* Classes[];
 	extern Enum const* Enums[];
 
+#if REFLECTOR_USES_JSON
+	/// Frees the parsed `AttributesJSON` values of all reflected entities; they will be parsed again when next accessed.
+	/// Make sure no one is holding on to references to them.
+	void ReleaseParsedAttributes();
+#endif
+
+	/// Information about the size of the reflection database and the time it took to initialize, see `GetDatabaseStatistics()`
+	struct DatabaseStatistics
+	{
+		size_t ClassCount = 0;
+		size_t FieldCount = 0;
+		size_t MethodCount = 0;
+		size_t PropertyCount = 0;
+		size_t EnumCount = 0;
+		size_t EnumeratorCount = 0;
+
+		/// Bytes taken by the reflection structures themselves, including the storage of their lists
+		size_t DataBytes = 0;
+		/// Bytes of heap-allocated strings owned by reflection data (GUIDs, method parameters)
+		size_t OwnedStringBytes = 0;
+		/// Bytes of the string literals referenced by reflection data (names, types, attribute sources, etc.); these live in static storage
+		size_t StaticStringBytes = 0;
+		/// Number of `AttributesJSON` values that are currently parsed, and an estimate of the bytes their DOMs take
+		size_t ParsedAttributeCount = 0;
+		size_t ParsedAttributeBytes = 0;
+
+		/// Time spent initializing `Classes` and `Enums` (i.e. creating the reflection data of all types) during static initialization
+		std::chrono::nanoseconds StaticInitializationTime{};
+		/// Time spent in the last call to `InitializeDatabase()`
+		std::chrono::nanoseconds EagerInitializationTime{};
+
+		size_t TotalHeapBytes() const noexcept { return DataBytes + OwnedStringBytes + ParsedAttributeBytes; }
+	};
+
+	/// Walks the whole reflection database; this is not free, so don't call it every frame
+	DatabaseStatistics GetDatabaseStatistics();
+
+	/// Initializes all reflection data on the calling thread (parsing all attributes as well if `parse_attributes` is set),
+	/// so that the cost of first access is not paid wherever the data happens to be used first. Returns the time it took.
+	std::chrono::nanoseconds InitializeDatabase(bool parse_attributes = true);
+
+	/// Called by the generated database file
+	void RecordDatabaseStaticInitializationTime(std::chrono::nanoseconds time) noexcept;
+
 	template <typename FUNC>
 	void ForEachClass(FUNC&& func)
 	{
@@ -134,7 +182,7 @@ namespace Reflector
 	{
 		static const std::vector<std::type_index> parameter_ids = { std::type_index{typeid(ARGS)}... };
 		for (auto& method : Methods)
-			if (method.Name == name && method.ParameterTypeIndices == parameter_ids) return &method;
+			if (method.Name == name && std::ranges::equal(method.ParameterTypeIndices, parameter_ids)) return &method;
 		return nullptr;
 	}
 
@@ -277,13 +325,19 @@ namespace Reflector
 		mutable PointerType mPointer{};
 	};
 
-}
-
-
-#if REFLECTOR_USES_JSON && defined(NLOHMANN_JSON_NAMESPACE_BEGIN)
+	/// FNV-1a hash of a field's save/load name; used by the generated serialization methods to dispatch fields with a single `switch`
+	constexpr uint32_t FieldNameHash(std::string_view name) noexcept
+	{
+		uint32_t hash = 0x811c9dc5u;
+		for (const char c : name)
+		{
+			hash ^= uint8_t(c);
+			hash *= 0x01000193u;
+		}
+		return hash;
+	}
 
-namespace Reflector
-{
+	/// Thrown by the generated deserialization functions when the serialized data is invalid
 	struct DataError
 	{
 		std::string Message;
@@ -294,6 +348,146 @@ namespace Reflector
 	{
 		std::string Message;
 	};
+
+	/// ///////////////////////////////////// ///
+	/// Columnar serialization
+	/// ///////////////////////////////////// ///
+
+	/// The type of a column of a serialized columnar vector. Arithmetic (and enum) fields are written as packed little-endian arrays,
+	/// all other fields as a sequence of values.
+	enum class ColumnarType : uint8_t { Values, I8, U8, I16, U16, I32, U32, I64, U64, F32, F64 };
+	inline constexpr std::array<std::string_view, 11> ColumnarTypeNames = { "values", "i8", "u8", "i16", "u16", "i32", "u32", "i64", "u64", "f32", "f64" };
+
+	template <typename T>
+	constexpr ColumnarType ColumnarTypeOf() noexcept
+	{
+		using enum ColumnarType;
+		if constexpr (std::is_enum_v<T>)
+			return ColumnarTypeOf<std::underlying_type_t<T>>();
+		else if constexpr (std::floating_point<T>)
+			return sizeof(T) == 4 ? F32 : sizeof(T) == 8 ? F64 : Values;
+		else if constexpr (std::integral<T> && !std::same_as<T, bool>)
+		{
+			constexpr ColumnarType types[2][4] = { { U8, U16, U32, U64 }, { I8, I16, I32, I64 } };
+			return sizeof(T) > 8 ? Values : types[std::is_signed_v<T>][std::bit_width(sizeof(T)) - 1];
+		}
+		else
+			return Values;
+	}
+
+	template <typename T> concept columnar_packed = ColumnarTypeOf<T>() != ColumnarType::Values;
+
+	template <columnar_packed T>
+	void ColumnarStore(uint8_t* dest, T value) noexcept
+	{
+		std::memcpy(dest, &value, sizeof(T));
+		if constexpr (std::endian::native == std::endian::big)
+			std::reverse(dest, dest + sizeof(T));
+	}
+
+	template <columnar_packed T>
+	T ColumnarLoad(uint8_t const* src) noexcept
+	{
+		uint8_t bytes[sizeof(T)];
+		std::memcpy(bytes, src, sizeof(T));
+		if constexpr (std::endian::native == std::endian::big)
+			std::reverse(bytes, bytes + sizeof(T));
+		T value;
+		std::memcpy(&value, bytes, sizeof(T));
+		return value;
+	}
+
+	/// Calls `func(properties)` with the compile-time data of each (non-static) field of `T` that is saved (or loaded), in visitor order
+	template <columnar_class T, typename FUNC>
+	void ForEachColumn(bool saving, FUNC&& func)
+	{
+		T::ForEachField([&]<typename PROPERTIES>(PROPERTIES properties) {
+			if constexpr (!PROPERTIES::HasFlag(FieldFlags::Static))
+			{
+				if (!PROPERTIES::HasFlag(saving ? FieldFlags::NoSave : FieldFlags::NoLoad))
+					func(properties);
+			}
+		});
+	}
+
+	inline std::string Base64Encode(std::span<uint8_t const> data)
+	{
+		static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string result;
+		result.reserve((data.size() + 2) / 3 * 4);
+		size_t i = 0;
+		for (; i + 2 < data.size(); i += 3)
+		{
+			const uint32_t triple = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+			result += alphabet[(triple >> 18) & 63];
+			result += alphabet[(triple >> 12) & 63];
+			result += alphabet[(triple >> 6) & 63];
+			result += alphabet[triple & 63];
+		}
+		if (const auto rest = data.size() - i; rest > 0)
+		{
+			const uint32_t triple = (uint32_t(data[i]) << 16) | (rest > 1 ? uint32_t(data[i + 1]) << 8 : 0);
+			result += alphabet[(triple >> 18) & 63];
+			result += alphabet[(triple >> 12) & 63];
+			result += rest > 1 ? alphabet[(triple >> 6) & 63] : '=';
+			result += '=';
+		}
+		return result;
+	}
+
+	/// Returns false if `text` is not valid (padded) base64
+	inline bool Base64Decode(std::string_view text, std::vector<uint8_t>& result)
+	{
+		static constexpr auto values = [] {
+			std::array<int8_t, 256> table{};
+			table.fill(-1);
+			constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			for (size_t i = 0; i < alphabet.size(); ++i)
+				table[uint8_t(alphabet[i])] = int8_t(i);
+			return table;
+		}();
+
+		if (text.size() % 4 != 0)
+			return false;
+		const auto padding = text.ends_with("==") ? 2 : text.ends_with('=') ? 1 : 0;
+		result.clear();
+		result.reserve(text.size() / 4 * 3);
+		for (size_t i = 0; i < text.size(); i += 4)
+		{
+			const auto last = i + 4 == text.size();
+			uint32_t quad = 0;
+			for (size_t j = 0; j < 4; ++j)
+			{
+				const auto value = values[uint8_t(text[i + j])];
+				if (value < 0 && !(last && j >= 4 - size_t(padding)))
+					return false;
+				quad = (quad << 6) | uint32_t(std::max<int8_t>(value, 0));
+			}
+			result.push_back(uint8_t(quad >> 16));
+			if (!last || padding < 2) result.push_back(uint8_t(quad >> 8));
+			if (!last || padding < 1) result.push_back(uint8_t(quad));
+		}
+		return true;
+	}
+
+	/// The number of bytes `Base64Decode` decodes from `text`, if it's valid
+	inline size_t Base64DecodedSize(std::string_view text) noexcept
+	{
+		const auto padding = text.ends_with("==") ? 2 : text.ends_with('=') ? 1 : 0;
+		return text.size() / 4 * 3 - std::min<size_t>(padding, text.size() / 4 * 3);
+	}
+
+}
+
+
+#if REFLECTOR_USES_JSON && defined(NLOHMANN_JSON_NAMESPACE_BEGIN)
+
+namespace Reflector
+{
+	template <columnar_class T, typename ALLOCATOR>
+	void ColumnarJSONSave(REFLECTOR_JSON_TYPE& dest_object, std::vector<T, ALLOCATOR> const& rows);
+	template <columnar_class T, typename ALLOCATOR>
+	void ColumnarJSONLoad(REFLECTOR_JSON_TYPE const& src_object, std::vector<T, ALLOCATOR>& rows);
 }
 
 NLOHMANN_JSON_NAMESPACE_BEGIN
@@ -340,14 +534,14 @@ struct adl_serializer<std::unique_ptr<SERIALIZABLE>>
 		if (!j["$type"].is_string())
 			throw ::Reflector::DataError{ "JSON source '$type' field is not a string" };
 
-		auto type = std::string_view{ j["$type"] };
+		std::string_view type = j["$type"].template get_ref<typename REFLECTOR_JSON_TYPE::string_t const&>();
 		if (!p || p->GetRuntimeClass()->FullType != type)
 		{
 			p.reset();
 
 			auto klass = Reflector::FindClassByFullType(type);
 			if (!klass && j.contains("$guid") && j.at("$guid").is_string())
-				klass = Reflector::FindClassByGUID(j.at("$guid"));
+				klass = Reflector::FindClassByGUID(j.at("$guid").template get_ref<typename REFLECTOR_JSON_TYPE::string_t const&>());
 			if (!klass)
 				throw ::Reflector::DataError{ std::format("Unknown reflectable type '{}'", type) };
 			/// NOTE: Not using aligned_alloc because MS doesn't handle it properly
@@ -376,6 +570,237 @@ struct adl_serializer<SERIALIZABLE>
 		if (j.is_string()) p = GetEnumeratorFromName(p, j); else p = (SERIALIZABLE)(std::underlying_type_t<SERIALIZABLE>)j;
 	}
 };
+
+template <::Reflector::columnar_class SERIALIZABLE, typename ALLOCATOR>
+struct adl_serializer<std::vector<SERIALIZABLE, ALLOCATOR>>
+{
+	static void to_json(REFLECTOR_JSON_TYPE& j, const std::vector<SERIALIZABLE, ALLOCATOR>& p)
+	{
+		::Reflector::ColumnarJSONSave(j, p);
+	}
+
+	static void from_json(const REFLECTOR_JSON_TYPE& j, std::vector<SERIALIZABLE, ALLOCATOR>& p)
+	{
+		::Reflector::ColumnarJSONLoad(j, p);
+	}
+};
 NLOHMANN_JSON_NAMESPACE_END
 
+namespace Reflector
+{
+	/// The set of loadable fields of an object that were present in the loaded JSON object, used by the generated `JSONLoadFinish`
+	/// methods to reset missing fields (or report missing required ones).
+	/// The fields of each class are indexed after the fields of its parent class (see the generated `JSONLoadableFieldCount`).
+	struct JSONLoadedFields
+	{
+		void Set(size_t index)
+		{
+			const auto word = index / 64;
+			if (word < mInline.size())
+				mInline[word] |= 1ULL << (index % 64);
+			else
+			{
+				const auto overflow_word = word - mInline.size();
+				if (overflow_word >= mOverflow.size())
+					mOverflow.resize(overflow_word + 1);
+				mOverflow[overflow_word] |= 1ULL << (index % 64);
+			}
+		}
+
+		bool Test(size_t index) const noexcept
+		{
+			const auto word = index / 64;
+			if (word < mInline.size())
+				return (mInline[word] >> (index % 64)) & 1;
+			const auto overflow_word = word - mInline.size();
+			return overflow_word < mOverflow.size() && ((mOverflow[overflow_word] >> (index % 64)) & 1);
+		}
+
+	private:
+
+		std::array<uint64_t, 2> mInline{};
+		std::vector<uint64_t> mOverflow;
+	};
+
+	/// Like `json.get_to(value)`, but returns false instead of throwing if the JSON value is of the wrong type.
+	/// Used by the generated `JSONLoadFields` methods when `IgnoreInvalidObjectFields` is set; only types that aren't
+	/// checked here (or that fail in ways that can't be checked up front) fall back to catching the exception.
+	template <typename T>
+	bool TryGetJSON(REFLECTOR_JSON_TYPE const& json, T& value)
+	{
+		if constexpr (std::same_as<T, REFLECTOR_JSON_TYPE>)
+			value = json;
+		else if constexpr (std::same_as<T, bool>)
+		{
+			if (!json.is_boolean())
+				return false;
+			value = json.template get<bool>();
+		}
+		else if constexpr (std::is_arithmetic_v<T>)
+		{
+			if (!json.is_number() && !json.is_boolean())
+				return false;
+			json.get_to(value);
+		}
+		else if constexpr (std::same_as<T, typename REFLECTOR_JSON_TYPE::string_t>)
+		{
+			if (!json.is_string())
+				return false;
+			value = json.template get_ref<typename REFLECTOR_JSON_TYPE::string_t const&>();
+		}
+		else if constexpr (reflected_enum<T>)
+		{
+			if (!json.is_string() && !json.is_number())
+				return false;
+			json.get_to(value);
+		}
+		else if constexpr (!columnar_vector<T> && requires (T& container) { { container.emplace_back() } -> std::same_as<typename T::value_type&>; container.clear(); })
+		{
+			if (!json.is_array())
+				return false;
+			value.clear();
+			for (auto const& element : json)
+			{
+				if (!TryGetJSON(element, value.emplace_back()))
+					return false;
+			}
+		}
+		else
+		{
+			try
+			{
+				json.get_to(value);
+			}
+			catch (...)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// Saves the vector as an object with a column for each saved field, instead of an array of objects:
+	/// `{ "$count": 2, "$columns": { "X": "f32", "Name": "values" }, "X": "AACAPwAAAEA=", "Name": ["a", "b"] }`
+	/// The `$columns` header holds the `ColumnarType` of each column; packed columns are base64-encoded, the others are arrays of values.
+	template <columnar_class T, typename ALLOCATOR>
+	void ColumnarJSONSave(REFLECTOR_JSON_TYPE& dest_object, std::vector<T, ALLOCATOR> const& rows)
+	{
+		dest_object = REFLECTOR_JSON_TYPE::object();
+		dest_object["$count"] = rows.size();
+		auto& columns = dest_object["$columns"] = REFLECTOR_JSON_TYPE::object();
+		ForEachColumn<T>(true, [&]<typename PROPERTIES>(PROPERTIES) {
+			using field_type = typename PROPERTIES::Type;
+			constexpr auto type = ColumnarTypeOf<field_type>();
+			const auto name = std::string{ PROPERTIES::SaveName };
+			columns[name] = ColumnarTypeNames[size_t(type)];
+			if constexpr (type != ColumnarType::Values)
+			{
+				std::vector<uint8_t> bytes(rows.size() * sizeof(field_type));
+				for (size_t i = 0; i < rows.size(); ++i)
+					ColumnarStore(bytes.data() + i * sizeof(field_type), PROPERTIES::Getter(&rows[i]));
+				dest_object[name] = Base64Encode(bytes);
+			}
+			else
+			{
+				auto& column = dest_object[name] = REFLECTOR_JSON_TYPE::array();
+				for (auto const& row : rows)
+					column.push_back(REFLECTOR_JSON_TYPE(PROPERTIES::Getter(&row)));
+			}
+		});
+	}
+
+	/// Loads a vector saved by `ColumnarJSONSave`, filling it column by column. Packed columns can also be given as arrays of values.
+	/// Missing columns leave the fields default-initialized, unless they are `Required`.
+	/// All columns are checked against `$count` before anything is allocated, and `rows` is only replaced once everything is loaded.
+	template <columnar_class T, typename ALLOCATOR>
+	void ColumnarJSONLoad(REFLECTOR_JSON_TYPE const& src_object, std::vector<T, ALLOCATOR>& rows)
+	{
+		using string_type = typename REFLECTOR_JSON_TYPE::string_t;
+
+		if (!src_object.is_object())
+			throw DataError{ "Columnar JSON source is not an object" };
+		const auto count_it = src_object.find("$count");
+		if (count_it == src_object.end() || !count_it->is_number_unsigned())
+			throw DataError{ "Columnar JSON source does not contain a valid '$count' field" };
+		const auto count = count_it->template get<size_t>();
+		const auto columns_it = src_object.find("$columns");
+		const auto columns = columns_it != src_object.end() && columns_it->is_object() ? &*columns_it : nullptr;
+
+		bool has_columns = false;
+		ForEachColumn<T>(false, [&]<typename PROPERTIES>(PROPERTIES) {
+			using field_type = typename PROPERTIES::Type;
+			constexpr auto type = ColumnarTypeOf<field_type>();
+			const auto name = std::string{ PROPERTIES::LoadName };
+			const auto column = src_object.find(name);
+			if (column == src_object.end())
+			{
+				if (PROPERTIES::HasFlag(FieldFlags::Required))
+					throw DataError{ std::format("Missing column '{}'", name) };
+				return;
+			}
+			has_columns = true;
+
+			if constexpr (type != ColumnarType::Values)
+			{
+				if (column->is_string())
+				{
+					if (columns)
+					{
+						const auto declared = columns->find(name);
+						if (declared != columns->end() && (!declared->is_string() || declared->template get_ref<string_type const&>() != ColumnarTypeNames[size_t(type)]))
+							throw DataError{ std::format("Column '{}' has type {}, expected '{}'", name, declared->dump(), ColumnarTypeNames[size_t(type)]) };
+					}
+					const auto size = Base64DecodedSize(column->template get_ref<string_type const&>());
+					if (size % sizeof(field_type) != 0 || size / sizeof(field_type) != count)
+						throw DataError{ std::format("Column '{}' has {} bytes, expected {} values of {} bytes", name, size, count, sizeof(field_type)) };
+					return;
+				}
+			}
+
+			if (!column->is_array() || column->size() != count)
+				throw DataError{ std::format("Column '{}' is not an array of {} values", name, count) };
+		});
+		/// Without any columns, nothing bounds the count
+		if (!has_columns && count != 0)
+			throw DataError{ std::format("Columnar JSON source has {} elements, but no columns", count) };
+
+		std::vector<T, ALLOCATOR> loaded(count, rows.get_allocator());
+		std::vector<uint8_t> bytes;
+		ForEachColumn<T>(false, [&]<typename PROPERTIES>(PROPERTIES) {
+			using field_type = typename PROPERTIES::Type;
+			constexpr auto type = ColumnarTypeOf<field_type>();
+			const auto name = std::string{ PROPERTIES::LoadName };
+			const auto column = src_object.find(name);
+			if (column == src_object.end())
+				return;
+
+			if constexpr (type != ColumnarType::Values)
+			{
+				if (column->is_string())
+				{
+					if (!Base64Decode(column->template get_ref<string_type const&>(), bytes) || bytes.size() != count * sizeof(field_type))
+						throw DataError{ std::format("Column '{}' is not valid base64", name) };
+					for (size_t i = 0; i < count; ++i)
+						PROPERTIES::Getter(&loaded[i]) = ColumnarLoad<field_type>(bytes.data() + i * sizeof(field_type));
+					return;
+				}
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				try
+				{
+					(*column)[i].get_to(PROPERTIES::Getter(&loaded[i]));
+				}
+				catch (DataError& e)
+				{
+					e.File += std::format("/{}/{}", name, i);
+					throw;
+				}
+			}
+		});
+		rows = std::move(loaded);
+	}
+}
+
 #endif
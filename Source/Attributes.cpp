@@ -311,6 +311,34 @@ const BoolAttributeProperties Attribute::Singleton {
 	false
 };
 
+const BoolAttributeProperties Attribute::TrackChanges {
+	"TrackChanges",
+	"Tracks which fields of each object of this class (and its subclasses) were changed via setter functions; adds 'SaveDelta' and 'LoadDelta' methods that only serialize the changed fields",
+	Targets::Classes,
+	false
+};
+
+const BoolAttributeProperties Attribute::Columnar {
+	"Columnar",
+	"Vectors of objects of this class are serialized column by column (an array per field, with arithmetic fields packed), instead of as arrays of objects",
+	Targets::Classes,
+	false
+};
+
+const BoolAttributeProperties Attribute::FlatView {
+	"FlatView",
+	"If the 'GenerateFlatViews' option is set, creates a flat layout and a 'View' accessor class for this class (and its subclasses), for reading objects in place from flat buffers",
+	Targets::Classes,
+	false
+};
+
+const BoolAttributeProperties Attribute::Relocatable {
+	"Relocatable",
+	"If GC functionality is enabled, lets heap compaction move objects of this class (but not its subclasses) to other addresses; the class must have a noexcept relocation constructor ('T(Reflector::RelocationTag tag, T&& other)', passing the tag to the constructor of its parent), and objects whose addresses are held outside of the heap must be pinned",
+	Targets::Classes,
+	false
+};
+
 const AttributeProperties Attribute::DefaultFieldAttributes {
 	"DefaultFieldAttributes",
 	"These attributes will be added as default to every reflected field of this class",
@@ -18,7 +18,9 @@
 ///
 /// You can query the attributes (as a JSON string/value) at runtime, using the `Attributes` and `AttributesJSON` fields of the
 /// reflection structs (not that the parsed JSON value is only available if the JSON option is enabled).
-/// Access to the attributes at compile time is currently not supported, but could be added if requested.
+/// `AttributesJSON` is parsed on first access, and can be freed again with `Reflector::ReleaseParsedAttributes()`.
+/// Top-level boolean, number and string attributes of fields, methods and properties are also available at compile time,
+/// via the `Attributes` type and `HasAttributeFlag`/`HasAttribute` functions of the compile-time data given to visitors.
 ///
 /// Some attributes will be set implicitly based on the code itself, for ease of parsing. In general, you
 /// should never use these attributes manually, and the tool will warn you of that.
@@ -271,6 +273,10 @@ struct Attribute
 
 	static const BoolAttributeProperties Abstract;
 	static const BoolAttributeProperties Singleton;
+	static const BoolAttributeProperties TrackChanges;
+	static const BoolAttributeProperties Columnar;
+	static const BoolAttributeProperties FlatView;
+	static const BoolAttributeProperties Relocatable;
 
 	static const AttributeProperties DefaultFieldAttributes;
 	static const AttributeProperties DefaultMethodAttributes;
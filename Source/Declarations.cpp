@@ -167,17 +167,32 @@ void Field::CreateArtificialMethodsAndDocument(Options const& options)
 			property_for_field->Getter = getter;
 	}
 
+	/// If the changes to this object are tracked, all the setters mark the bit of this field in the changed fields set
+	std::string mark_changed;
+	if (ParentType->TracksChanges())
+	{
+		const auto field_index = std::ranges::find_if(ParentType->Fields, [this](auto const& field) { return field.get() == this; }) - ParentType->Fields.begin();
+		mark_changed = format("this->mChangedFields_.set({}); ", field_index);
+	}
+
+	/// Setters of fields of heap objects that might hold pointers to other heap objects notify the collector (see `Heap::WriteBarrier`)
+	std::string write_barrier;
+	if (options.AddGCFunctionality && !ParentType->Flags.contain(ClassFlags::Struct))
+		write_barrier = format("if constexpr (::Reflector::could_be_marked<decltype(this->{})>::value) ::Reflector::Heap::WriteBarrier(this); ", Name);
+
 	if (!Flags.is_set(FieldFlags::NoSetter))
 	{
 		auto on_change = Attribute::OnChange(*this);
 		auto setter = AddArtificialMethod("Setter", "void", options.Names.SetterPrefix + CleanName, Type + " const& value",
-			"static_assert(std::is_copy_assignable_v<decltype(this->" + Name + ")>, \"err\"); this->" + Name + " = value; " + on_change + ";",
+			"static_assert(std::is_copy_assignable_v<decltype(this->" + Name + ")>, \"err\"); this->" + Name + " = value; " + write_barrier + mark_changed + on_change + ";",
 			{ "Sets " + field_comments }, {});
 		if (Flags.is_set(FieldFlags::NoScript))
 			setter->Flags += MethodFlags::NoScript;
 		AddDocNote("Setter", "The value of this field is set by the {} method.", setter->MakeLink());
 		if (!on_change.empty())
 			AddDocNote("On Change", "When this field is changed (via its setter and other such functions), the following code will be executed: `{}`", Escaped(on_change));
+		if (!mark_changed.empty())
+			AddDocNote("Tracked", "Changes to this field made via its setter and other such functions are tracked, and saved by the `SaveDelta` method of {}.", ParentType->MakeLink());
 
 		if (property_for_field)
 			property_for_field->Setter = setter;
@@ -282,37 +297,37 @@ void Field::CreateArtificialMethodsAndDocument(Options const& options)
 			for (auto& enumerator : henum->Enumerators)
 			{
 				AddArtificialMethod(format("FlagSetter.{}.{}", henum->FullName(), enumerator->Name), "void", options.Names.SetterPrefix + enumerator->Name, "",
-					std::format("this->{} |= {}{{{}}}; {};", Name, Type, 1ULL << enumerator->Value, on_change),
+					std::format("this->{} |= {}{{{}}}; {}{};", Name, Type, 1ULL << enumerator->Value, mark_changed, on_change),
 					{ "Sets the " + enumerator->MakeLink() + " flag in " + MakeLink() }, enum_setter_flags)->Access = setter_access;
 				AddArtificialMethod(format("FlagSetterTo.{}.{}", henum->FullName(), enumerator->Name), "void", options.Names.SetterPrefix + enumerator->Name, "bool val",
-					std::format("val ? (this->{0} |= {1}{{{2}}}) : (this->{0} &= ~{1}{{{2}}}); {3};", Name, Type, 1ULL << enumerator->Value, on_change),
+					std::format("val ? (this->{0} |= {1}{{{2}}}) : (this->{0} &= ~{1}{{{2}}}); {3}{4};", Name, Type, 1ULL << enumerator->Value, mark_changed, on_change),
 					{ "Sets or unsets the " + enumerator->MakeLink() + " flag in " + MakeLink() + " depending on the given value" }, enum_setter_flags)->Access = setter_access;
 
 				if (auto opposite = Attribute::Opposite.SafeGet(*enumerator))
 				{
 					AddArtificialMethod(format("FlagOppositeSetter.{}.{}", henum->FullName(), enumerator->Name), "void", options.Names.SetterPrefix + *opposite, "",
-						std::format("this->{} &= ~{}{{{}}}; {};", Name, Type, 1ULL << enumerator->Value, on_change),
+						std::format("this->{} &= ~{}{{{}}}; {}{};", Name, Type, 1ULL << enumerator->Value, mark_changed, on_change),
 						{ "Clears the " + enumerator->MakeLink() + " flag in " + MakeLink() }, enum_setter_flags)->Access = setter_access;
 
 				}
 				else if (flag_nots)
 				{
 					AddArtificialMethod(format("FlagOppositeSetter.{}.{}", henum->FullName(), enumerator->Name), "void", options.Names.SetNotPrefix + enumerator->Name, "",
-						std::format("this->{} &= ~{}{{{}}}; {};", Name, Type, 1ULL << enumerator->Value, on_change),
+						std::format("this->{} &= ~{}{{{}}}; {}{};", Name, Type, 1ULL << enumerator->Value, mark_changed, on_change),
 						{ "Clears the " + enumerator->MakeLink() + " flag in " + MakeLink() }, enum_setter_flags)->Access = setter_access;
 				}
 			}
 			for (auto& enumerator : henum->Enumerators)
 			{
 				AddArtificialMethod(format("FlagUnsetter.{}.{}", henum->FullName(), enumerator->Name), "void", options.Names.UnsetPrefix + enumerator->Name, "",
-					std::format("this->{} &= ~{}{{{}}}; {};", Name, Type, 1ULL << enumerator->Value, on_change),
+					std::format("this->{} &= ~{}{{{}}}; {}{};", Name, Type, 1ULL << enumerator->Value, mark_changed, on_change),
 					{ "Clears the " + enumerator->MakeLink() + " flag in " + MakeLink() }, enum_setter_flags)->Access = setter_access;
 
 
 				if (auto opposite = Attribute::Opposite.SafeGet(*enumerator))
 				{
 					AddArtificialMethod(format("FlagOppositeUnsetter.{}.{}", henum->FullName(), enumerator->Name), "void", options.Names.UnsetPrefix + *opposite, "",
-						std::format("this->{} |= {}{{{}}}; {};", Name, Type, 1ULL << enumerator->Value, on_change),
+						std::format("this->{} |= {}{{{}}}; {}{};", Name, Type, 1ULL << enumerator->Value, mark_changed, on_change),
 						{ "Sets the " + enumerator->MakeLink() + " flag in " + MakeLink() }, enum_setter_flags)->Access = setter_access;
 
 				}
@@ -320,13 +335,13 @@ void Field::CreateArtificialMethodsAndDocument(Options const& options)
 			for (auto& enumerator : henum->Enumerators)
 			{
 				AddArtificialMethod(format("FlagToggler.{}.{}", henum->FullName(), enumerator->Name), "void", options.Names.TogglePrefix + enumerator->Name, "",
-					std::format("this->{} ^= {}{{{}}}; {};", Name, Type, 1ULL << enumerator->Value, on_change),
+					std::format("this->{} ^= {}{{{}}}; {}{};", Name, Type, 1ULL << enumerator->Value, mark_changed, on_change),
 					{ "Toggles the " + enumerator->MakeLink() + " flag in " + MakeLink() }, enum_setter_flags)->Access = setter_access;
 
 				if (auto opposite = Attribute::Opposite.SafeGet(*enumerator))
 				{
 					AddArtificialMethod(format("FlagOppositeToggler.{}.{}", henum->FullName(), enumerator->Name), "void", options.Names.TogglePrefix + *opposite, "",
-						std::format("this->{} ^= {}{{{}}}; {};", Name, Type, 1ULL << enumerator->Value, on_change),
+						std::format("this->{} ^= {}{{{}}}; {}{};", Name, Type, 1ULL << enumerator->Value, mark_changed, on_change),
 						{ "Toggles the " + enumerator->MakeLink() + " flag in " + MakeLink() }, enum_setter_flags)->Access = setter_access;
 				}
 			}
@@ -556,6 +571,13 @@ Method* Class::AddArtificialMethod(Declaration& for_decl, std::string function_t
 	return &method;
 }
 
+bool Class::TracksChanges() const
+{
+	if (Attribute::TrackChanges(*this))
+		return true;
+	return std::ranges::any_of(GetInheritanceList(), [](Class const* klass) { return Attribute::TrackChanges(*klass); });
+}
+
 void Class::CreateArtificialMethodsAndDocument(Options const& options)
 {
 	Declaration::CreateArtificialMethodsAndDocument(options);
@@ -593,6 +615,26 @@ void Class::CreateArtificialMethodsAndDocument(Options const& options)
 		AddDocNote("Abstract", "This class is not constructible via the reflection system.");
 	}
 
+	if (Attribute::Columnar(*this))
+	{
+		AddDocNote("Columnar", "Vectors of objects of this class are serialized column by column: the JSON object (or binary value) has a column for each field, and the arithmetic columns are stored as packed arrays.");
+	}
+
+	if (options.GenerateFlatViews && Attribute::FlatView(*this))
+	{
+		AddDocNote("Flat View", "Objects of this class (and its subclasses) can be written to flat buffers with `Reflector::FlatSave`, and read in place through the `View` class nested in this class.");
+	}
+
+	if (options.AddGCFunctionality && Attribute::Relocatable(*this))
+	{
+		AddDocNote("Relocatable", "Heap compaction can move objects of this class to other addresses; pointers to them held outside of the heap must be pinned with `Heap::Pin`.");
+	}
+
+	if (TracksChanges())
+	{
+		AddDocNote("Tracks Changes", "The fields of this class that were changed via setter functions are tracked per object; `SaveDelta` saves only the changed fields and clears them, and `LoadDelta` loads them.");
+	}
+
 	/// TODO: Find duplicates and other issues like:
 	/// - field with the same name as a type (will cause issues in DB)
 	/// Also find a good/better place to put this duplicate checker
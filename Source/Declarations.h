@@ -408,6 +408,9 @@ struct Class final : TypeDeclaration
 		return result;
 	}
 
+	/// Whether this class or any of its (reflected) base classes has the `TrackChanges` attribute
+	bool TracksChanges() const;
+
 	virtual ::DeclarationType DeclarationType() const override { return DeclarationType::Class; }
 
 private:
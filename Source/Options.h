@@ -58,6 +58,18 @@ struct JSONOptions
 	RField();
 	bool GenerateSerializationMethods = true;
 
+	/// Toggles generation of the methods used by the streaming JSON loader (`Reflector::JSONStreamLoad`), which loads
+	/// objects directly from a SAX parser, without building a DOM of the whole document.
+	/// Requires the `ReflectorJSON.h` header, which will be put into the artifact directory.
+	RField();
+	bool GenerateStreamingLoadMethods = false;
+
+	/// Toggles generation of the methods used by the direct JSON writer (`Reflector::JSONStreamSave`), which writes
+	/// objects as JSON text straight into a string or a stream, without building a DOM.
+	/// Requires the `ReflectorJSON.h` header, which will be put into the artifact directory.
+	RField();
+	bool GenerateStreamingSaveMethods = false;
+
 	/// The name of the field that holds the type name of the object stored
 	/// when storing a polymorphic object
 	RField();
@@ -68,9 +80,23 @@ struct JSONOptions
 	RField();
 	std::string ObjectGUIDFieldName = "$guid";
 
-	/// TODO: This
+	/// Toggles generation of a JSON Schema for each serializable class (into the `Schemas` subdirectory of the artifact directory),
+	/// built from the field types, `Required` flags and load names. Each class also gets a `JSONSchemaHash` constant;
+	/// objects tagged with that hash (see `SchemaHashFieldName`) are assumed to have been validated against the schema,
+	/// and are loaded through a faster path that does not track loaded fields or handle per-field errors.
+	/// Objects without the tag, or with a different hash, are loaded normally.
+	/// Off by default, as it changes the output for every class.
+	RField();
+	bool AllowSchemaGenerationPerClass = false;
+
+	/// The name of the field that holds the schema hash of the object stored
+	RField();
+	std::string SchemaHashFieldName = "$schema_hash";
+
+	/// If true, `JSONSaveFields` will tag saved objects with the hash of their class schema, so that they are loaded through
+	/// the validated path. Only enable this if the saved documents are not going to be edited without being validated again.
 	RField();
-	bool AllowSchemaGenerationPerClass = true;
+	bool SaveSchemaHash = false;
 
 	/// If true, errors while deserializing non-required object fields will be silently ignored, the fields will be reset,
 	/// and deserialization will continue. If false, errors (exceptions) will be propagated.
@@ -78,6 +104,26 @@ struct JSONOptions
 	bool IgnoreInvalidObjectFields = false;
 };
 
+RClass(DefaultFieldAttributes = { Setter = false, Getter = false });
+struct BinaryOptions
+{
+	RBody();
+
+	/// Whether or not to generate compact binary serialization methods (`BinarySaveFields`/`BinaryLoadFields`) for reflected classes.
+	/// Requires the `ReflectorBinary.h` header, which will be put into the artifact directory.
+	RField();
+	bool Use = false;
+
+	/// Like `JSONOptions::AlwaysSaveAllFields`; if false, fields equal to their initializers are not saved.
+	RField();
+	bool AlwaysSaveAllFields = false;
+
+	/// Like `JSONOptions::IgnoreInvalidObjectFields`; if true, errors while deserializing non-required object fields will be
+	/// silently ignored and the fields will be reset.
+	RField();
+	bool IgnoreInvalidObjectFields = false;
+};
+
 RClass(DefaultFieldAttributes = { Setter = false, Getter = false });
 struct DocumentationOptions
 {
@@ -322,6 +368,17 @@ struct Options
 	RField();
 	bool AddGCFunctionality = false;
 
+	/// Whether to put all the reflection data in `constinit` arrays (referenced via `std::span`s) instead of function-local statics holding `std::vector`s.
+	/// The reflection database will then be ready at load time, without any dynamic initialization, guard checks or heap allocations,
+	/// but the `Fields`, `Methods`, etc. lists of reflection entities will not be modifiable at runtime.
+	RField();
+	bool ConstantInitializedDatabase = false;
+
+	/// Whether to generate flat layouts and `View` accessor classes for reflected classes with the `FlatView` attribute, for reading them
+	/// in place from memory-mapped data. Requires the `ReflectorFlat.h` header, which will be put into the artifact directory.
+	RField();
+	bool GenerateFlatViews = false;
+
 	/// Whether to output forward declarations of reflected classes
 	RField();
 	bool ForwardDeclare = true;
@@ -348,6 +405,10 @@ struct Options
 	RField();
 	JSONOptions JSON = {};
 
+	/// Binary serialization options
+	RField();
+	BinaryOptions Binary = {};
+
 	/// Options regarding names, both in your source code as well as generated ones
 	RField();
 	NameOptions Names = {};
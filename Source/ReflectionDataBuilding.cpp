@@ -8,6 +8,8 @@
 #include "Declarations.h"
 #include <charconv>
 #include <fstream>
+#include <map>
+#include <set>
 
 struct OutputContext
 {
@@ -19,6 +21,11 @@ struct OutputContext
 
 	void BuildStaticReflectionData(const Enum& henum);
 	void BuildStaticReflectionData(const Class& klass);
+	void BuildJSONStreamingLoadMethods(const Class& klass);
+	void BuildJSONStreamingSaveMethods(const Class& klass);
+	void BuildBinarySerializationMethods(const Class& klass);
+	void BuildChangeTrackingMethods(const Class& klass);
+	void BuildFlatViewMethods(const Class& klass);
 };
 
 struct FileMirrorOutputContext : OutputContext
@@ -36,6 +43,8 @@ struct FileMirrorOutputContext : OutputContext
 
 	bool BuildClassEntry(const Class& klass);
 	bool BuildEnumEntry(const Enum& henum);
+
+	std::string WriteCompileTimeAttributes(const Declaration& decl, std::string_view attributes_namespace, std::string_view struct_name);
 };
 
 
@@ -44,6 +53,107 @@ static path RelativePath(path const& writing_file, path const& referenced_file)
 	return referenced_file.lexically_relative(writing_file.parent_path());
 }
 
+/// The statement that resets a field to its initial value, used when the field is missing from the loaded data
+static std::string FieldResetLine(const Field& field)
+{
+	if (field.InitializingExpression.empty())
+		return format("this->{0} = decltype(this->{0}){{}};", field.Name);
+	if (field.Flags.contain(FieldFlags::BraceInitialized))
+		return format("this->{} = {}{};", field.Name, field.Type, field.InitializingExpression);
+	return format("this->{} = {};", field.Name, field.InitializingExpression);
+}
+
+/// Classes get flat views if they or any of their base classes have the `FlatView` attribute
+static bool HasFlatView(Options const& options, Class const& klass)
+{
+	if (!options.GenerateFlatViews)
+		return false;
+	if (Attribute::FlatView(klass))
+		return true;
+	return std::ranges::any_of(klass.GetInheritanceList(), [](Class const* base) { return Attribute::FlatView(*base); });
+}
+
+/// The fields that get a slot in the flat layout of their class, in slot order
+static std::vector<Field const*> FlatFields(Class const& klass)
+{
+	std::vector<Field const*> result;
+	for (auto& field : klass.Fields)
+	{
+		if (!field->Flags.contain(FieldFlags::Static) && !field->Flags.contain(FieldFlags::NoSave))
+			result.push_back(field.get());
+	}
+	return result;
+}
+
+/// Must match `Reflector::FieldNameHash` in ReflectorUtils.h
+static uint32_t FieldNameHash(std::string_view name)
+{
+	uint32_t hash = 0x811c9dc5u;
+	for (const char c : name)
+	{
+		hash ^= uint8_t(c);
+		hash *= 0x01000193u;
+	}
+	return hash;
+}
+
+/// Top-level attributes that can be given at compile-time, as `static constexpr` members of a struct
+static bool IsCompileTimeAttribute(std::string const& name, json const& value)
+{
+	static const std::set<std::string, std::less<>> reserved_names = {
+		"AttributeFlagBits", "AttributeNames",
+		"auto", "bool", "break", "case", "catch", "char", "class", "const", "constexpr", "continue", "default", "delete", "do", "double",
+		"else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable",
+		"namespace", "new", "noexcept", "nullptr", "operator", "private", "protected", "public", "register", "return", "short", "signed",
+		"sizeof", "static", "struct", "switch", "template", "this", "throw", "true", "try", "typedef", "typename", "union", "unsigned",
+		"using", "virtual", "void", "volatile", "while",
+	};
+	return (value.is_boolean() || value.is_number() || value.is_string()) && ascii::is_identifier(name) && !reserved_names.contains(name);
+}
+
+static bool HasCompileTimeAttributes(Declaration const& decl)
+{
+	for (auto const& attribute : decl.Attributes.items())
+		if (IsCompileTimeAttribute(attribute.key(), attribute.value()))
+			return true;
+	return false;
+}
+
+/// The boolean attributes used anywhere in the reflected code get a bit in the `Reflector::AttributeFlag` enum
+static std::vector<std::string> const& AttributeFlagNames()
+{
+	static const auto names = [] {
+		std::set<std::string> result;
+		const auto add = [&](Declaration const& decl) {
+			for (auto const& attribute : decl.Attributes.items())
+				if (attribute.value().is_boolean() && IsCompileTimeAttribute(attribute.key(), attribute.value()))
+					result.insert(attribute.key());
+		};
+		for (auto const& mirror : GetMirrors())
+		{
+			for (auto& klass : mirror->Classes)
+			{
+				add(*klass);
+				for (auto& field : klass->Fields)
+					add(*field);
+				for (auto& method : klass->Methods)
+					add(*method);
+				for (auto& property : klass->Properties | std::views::values)
+					add(property);
+			}
+		}
+
+		std::vector<std::string> list{ result.begin(), result.end() };
+		if (list.size() > 64)
+		{
+			PrintLine("Warning: {} different boolean attributes are used, only the first 64 will have attribute flags", list.size());
+			list.resize(64);
+		}
+		return list;
+	}();
+	return names;
+}
+
 /// Compares the generation time of the target artifact (acquired from its first line), with
 /// the last write time of the source file. If they differ, the artifact needs to be regenerated.
 /// The executable change time, if it is newer, always takes precedence over the source file's last write time.
@@ -84,6 +194,179 @@ bool CreateJSONDBArtifact(ArtifactArgs args)
 	return true;
 }
 
+bool GeneratesJSONSchema(Options const& options, Class const& klass)
+{
+	return options.JSON.Use && options.JSON.GenerateSerializationMethods && options.JSON.AllowSchemaGenerationPerClass && Attribute::Serialize.GetOr(klass, true) != false;
+}
+
+std::string JSONSchemaFileName(Class const& klass)
+{
+	return klass.FullName(".") + ".schema.json";
+}
+
+/// Splits a template type like `std::map<K, std::vector<V>>` into its template name and top-level arguments
+static bool SplitTemplateType(std::string_view type, std::string_view& template_name, std::vector<std::string_view>& arguments)
+{
+	const auto open = type.find('<');
+	if (open == std::string_view::npos || !type.ends_with('>'))
+		return false;
+
+	template_name = trimmed_whitespace(type.substr(0, open));
+	const auto inner = type.substr(open + 1, type.size() - open - 2);
+	int depth = 0;
+	size_t start = 0;
+	for (size_t i = 0; i < inner.size(); ++i)
+	{
+		if (inner[i] == '<' || inner[i] == '(')
+			++depth;
+		else if (inner[i] == '>' || inner[i] == ')')
+			--depth;
+		else if (inner[i] == ',' && depth == 0)
+		{
+			arguments.push_back(trimmed_whitespace(inner.substr(start, i - start)));
+			start = i + 1;
+		}
+	}
+	arguments.push_back(trimmed_whitespace(inner.substr(start)));
+	return true;
+}
+
+/// Returns the schema of the JSON value that a field of type `type` is serialized to by `adl_serializer`s.
+/// Types we don't know how to describe accept any value.
+static json JSONSchemaForType(std::string_view type, Class const& context)
+{
+	static const std::set<std::string_view, std::less<>> integer_types = {
+		"char", "signed char", "unsigned char", "short", "unsigned short", "int", "unsigned", "unsigned int", "long", "unsigned long",
+		"long long", "unsigned long long", "int8_t", "uint8_t", "int16_t", "uint16_t", "int32_t", "uint32_t", "int64_t", "uint64_t",
+		"size_t", "ptrdiff_t", "intptr_t", "uintptr_t",
+	};
+	static const std::set<std::string_view, std::less<>> array_templates = {
+		"vector", "deque", "list", "array", "set", "multiset", "unordered_set", "unordered_multiset",
+	};
+
+	type = trimmed_whitespace(type);
+	consume(type, "const ");
+	consume(type, "::");
+
+	std::string_view template_name;
+	std::vector<std::string_view> arguments;
+	if (SplitTemplateType(type, template_name, arguments))
+	{
+		consume(template_name, "::");
+		consume(template_name, "std::");
+		if (array_templates.contains(template_name))
+			return { { "type", "array" }, { "items", JSONSchemaForType(arguments[0], context) } };
+		if ((template_name == "map" || template_name == "unordered_map") && arguments.size() >= 2)
+		{
+			auto key = JSONSchemaForType(arguments[0], context);
+			auto value = JSONSchemaForType(arguments[1], context);
+			/// Maps with string keys are serialized as objects, all others as arrays of key-value pairs
+			if (key.value("type", "") == "string")
+				return { { "type", "object" }, { "additionalProperties", std::move(value) } };
+			return { { "type", "array" }, { "items", { { "type", "array" }, { "prefixItems", json::array({ std::move(key), std::move(value) }) }, { "minItems", 2 }, { "maxItems", 2 } } } };
+		}
+		if (template_name == "optional" || template_name == "unique_ptr" || template_name == "shared_ptr")
+			return { { "anyOf", json::array({ JSONSchemaForType(arguments[0], context), json{ { "type", "null" } } }) } };
+		if (template_name == "pair" || template_name == "tuple")
+		{
+			json items = json::array();
+			for (auto argument : arguments)
+				items.push_back(JSONSchemaForType(argument, context));
+			return { { "type", "array" }, { "prefixItems", std::move(items) }, { "minItems", arguments.size() }, { "maxItems", arguments.size() } };
+		}
+		return json::object();
+	}
+
+	if (type == "bool")
+		return { { "type", "boolean" } };
+	if (type == "float" || type == "double" || type == "long double")
+		return { { "type", "number" } };
+
+	auto unqualified_type = type;
+	consume(unqualified_type, "std::");
+	if (integer_types.contains(unqualified_type))
+		return { { "type", "integer" } };
+	if (unqualified_type == "string" || unqualified_type == "filesystem::path")
+		return { { "type", "string" } };
+
+	/// Enums are saved as their underlying values, but can also be loaded from enumerator names
+	if (auto henum = FindEnum(type))
+	{
+		json values = json::array();
+		json names = json::array();
+		for (auto& enumerator : henum->Enumerators)
+		{
+			values.push_back(enumerator->Value);
+			names.push_back(enumerator->Name);
+		}
+		return { { "anyOf", json::array({ json{ { "enum", std::move(values) } }, json{ { "enum", std::move(names) } } }) } };
+	}
+
+	if (auto klass = Class::FindClassByPossiblyQualifiedName(type, &context))
+		return { { "$ref", JSONSchemaFileName(*klass) } };
+
+	return json::object();
+}
+
+/// Builds the JSON Schema of the objects of `klass`, including the fields of its base classes.
+/// The schema without descriptions is what the schema hash is calculated from, so that documentation changes do not change it.
+static json BuildJSONSchema(Options const& options, Class const& klass, bool with_descriptions)
+{
+	json properties = json::object();
+	json required = json::array();
+
+	auto classes = klass.GetInheritanceList();
+	std::ranges::reverse(classes);
+	classes.push_back(&klass);
+	for (auto owner : classes)
+	{
+		for (auto& field : owner->Fields)
+		{
+			if (field->Flags.contain(FieldFlags::NoLoad))
+				continue;
+
+			auto& property = properties[field->LoadName] = JSONSchemaForType(field->Type, *owner);
+			if (with_descriptions && !field->Comments.empty())
+				property["description"] = join(field->Comments, "\n");
+			if (field->Flags.contain(FieldFlags::Required))
+				required.push_back(field->LoadName);
+		}
+	}
+	if (!klass.BaseClass.empty())
+		properties[options.JSON.ObjectTypeFieldName] = { { "type", "string" } };
+
+	json schema = {
+		{ "$schema", "https://json-schema.org/draft/2020-12/schema" },
+		{ "$id", JSONSchemaFileName(klass) },
+		{ "title", klass.FullType() },
+		{ "type", "object" },
+		{ "properties", std::move(properties) },
+	};
+	if (!required.empty())
+		schema["required"] = std::move(required);
+	if (with_descriptions && !klass.Comments.empty())
+		schema["description"] = join(klass.Comments, "\n");
+	return schema;
+}
+
+/// 64-bit FNV-1a of the canonical (key-sorted, compact) dump of the class schema
+static uint64_t JSONSchemaHash(Options const& options, Class const& klass)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (const char c : BuildJSONSchema(options, klass, false).dump())
+	{
+		hash ^= uint8_t(c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+bool CreateJSONSchemaArtifact(ArtifactArgs args, Class const& klass)
+{
+	*args.Output << BuildJSONSchema(args.Options, klass, true).dump(1, '\t');
+	return true;
+}
+
 bool CreateReflectorDatabaseArtifact(ArtifactArgs args)
 {
 	auto const& [_, final_path, opts, factory] = args;
@@ -93,6 +376,10 @@ bool CreateReflectorDatabaseArtifact(ArtifactArgs args)
 	database_file.WriteLine("#include <iostream>");
 	database_file.WriteLine("#include \"Reflector.h\"");
 	database_file.WriteLine("#include \"ReflectorUtils.h\"");
+	if (opts.Binary.Use)
+		database_file.WriteLine("#include \"ReflectorBinary.h\"");
+	if (opts.JSON.Use && (opts.JSON.GenerateStreamingLoadMethods || opts.JSON.GenerateStreamingSaveMethods))
+		database_file.WriteLine("#include \"ReflectorJSON.h\"");
 
 	database_file.WriteLine("#include \"Includes.reflect.h\"");
 
@@ -106,27 +393,34 @@ bool CreateReflectorDatabaseArtifact(ArtifactArgs args)
 			return false;
 	}
 
+	/// In constinit mode, the lists can point directly at the constant-initialized data
+	const auto list_storage = opts.ConstantInitializedDatabase ? "constinit " : "";
+	const auto data_reference_format = opts.ConstantInitializedDatabase ? "&ReflectionData_{}::Data," : "&StaticGetReflectionData_For_{}(),";
+
 	database_file.StartBlock("namespace Reflector {{");
-	database_file.StartBlock("::Reflector::Class const* Classes[] = {{");
+	/// Dynamic initialization within a translation unit happens in order of definition, so this measures the initialization of the lists below
+	database_file.WriteLine("static const auto database_initialization_start = ::std::chrono::steady_clock::now();");
+	database_file.StartBlock("{}::Reflector::Class const* Classes[] = {{", list_storage);
 	for (const auto& mirror : GetMirrors())
 	{
 		for (auto& klass : mirror->Classes)
 		{
-			database_file.WriteLine("&StaticGetReflectionData_For_{}(),", klass->GeneratedUniqueName());
+			database_file.WriteLine(data_reference_format, klass->GeneratedUniqueName());
 		}
 	}
 	database_file.WriteLine("nullptr");
 	database_file.EndBlock("}};");
-	database_file.StartBlock("::Reflector::Enum const* Enums[] = {{");
+	database_file.StartBlock("{}::Reflector::Enum const* Enums[] = {{", list_storage);
 	for (const auto& mirror : GetMirrors())
 	{
 		for (auto& henum : mirror->Enums)
 		{
-			database_file.WriteLine("&StaticGetReflectionData_For_{}(),", henum->GeneratedUniqueName());
+			database_file.WriteLine(data_reference_format, henum->GeneratedUniqueName());
 		}
 	}
 	database_file.WriteLine("nullptr");
 	database_file.EndBlock("}};");
+	database_file.WriteLine("static const bool database_initialization_recorded = (::Reflector::RecordDatabaseStaticInitializationTime(::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now() - database_initialization_start)), true);");
 	database_file.EndBlock("}};");
 
 	return true;
@@ -151,9 +445,28 @@ bool CreateReflectorHeaderArtifact(ArtifactArgs args)
 	}
 	if (options.AddGCFunctionality)
 		reflect_file.WriteLine("#define REFLECTOR_USES_GC 1", options.MacroPrefix);
+	if (options.ConstantInitializedDatabase)
+		reflect_file.WriteLine("#define REFLECTOR_CONSTINIT_DATABASE 1");
+	if (options.Binary.Use)
+		reflect_file.WriteLine("#define REFLECTOR_USES_BINARY 1");
+	if (options.JSON.Use && options.JSON.GenerateStreamingLoadMethods)
+		reflect_file.WriteLine("#define REFLECTOR_USES_JSON_SAX 1");
+	if (options.JSON.Use && options.JSON.GenerateStreamingSaveMethods)
+		reflect_file.WriteLine("#define REFLECTOR_USES_JSON_WRITER 1");
+	if (options.JSON.Use && (options.JSON.GenerateStreamingLoadMethods || options.JSON.GenerateStreamingSaveMethods))
+	{
+		reflect_file.WriteLine("#define REFLECTOR_JSON_OBJECT_TYPE_FIELD_NAME {}", BuildCompileTimeLiteral(options.JSON.ObjectTypeFieldName));
+		reflect_file.WriteLine("#define REFLECTOR_JSON_OBJECT_GUID_FIELD_NAME {}", BuildCompileTimeLiteral(options.JSON.ObjectGUIDFieldName));
+	}
 	reflect_file.WriteLine("#include \"{}\"", reflector_classes_relative_path.string());
+	reflect_file.StartBlock("namespace Reflector {{");
+	reflect_file.WriteLine("/// All boolean attributes used in the reflected code; `CompileTimeAttributeData::AttributeFlags` has a bit set for each one that is `true`");
+	reflect_file.WriteLine("enum class AttributeFlag {{ {} }};", join(AttributeFlagNames(), ", "));
+	reflect_file.EndBlock("}}");
 	if (options.AddGCFunctionality)
 		reflect_file.WriteLine("#include \"{}\"", reflector_gc_relative_path.string());
+	if (options.GenerateFlatViews)
+		reflect_file.WriteLine("#include \"{}\"", RelativePath(final_path, options.ArtifactPath / "ReflectorFlat.h").string());
 	reflect_file.WriteLine("#define REFLECTOR_TOKENPASTE3_IMPL(x, y, z) x ## y ## z");
 	reflect_file.WriteLine("#define REFLECTOR_TOKENPASTE3(x, y, z) REFLECTOR_TOKENPASTE3_IMPL(x, y, z)");
 	reflect_file.WriteLine("#define REFLECTOR_TOKENPASTE2_IMPL(x, y) x ## y");
@@ -208,6 +521,172 @@ std::string DebuggingComment(const Options& options, std::string_view content)
 	return options.DebuggingComments ? std::format("/* {} */ ", content) : std::string{};
 }
 
+static std::string BuildCharLiteral(char c)
+{
+	if (c >= ' ' && c <= '~' && c != '\'' && c != '\\')
+		return std::format("'{}'", c);
+	return std::format("'\\x{:02x}'", static_cast<unsigned char>(c));
+}
+
+static char LowercaseASCII(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+struct StringSwitchCase
+{
+	std::string Key;
+	std::string Action;
+};
+
+/// Writes a lookup of the string `var` against a set of keys, that does at most one full string comparison:
+/// the keys are bucketed by length, each bucket is split by the character position that discriminates
+/// its keys best, and only then the whole string is compared. Compilers turn the switches into jump tables,
+/// so this is a lot faster than a chain of `if (name == "...")` for larger key sets.
+/// If `case_insensitive` is set, keys are compared with `::Reflector::EqualsIgnoreCaseASCII`.
+/// When keys collide (e.g. case-insensitively), the first one wins.
+static void WriteStringSwitch(FileWriter& output, std::string_view var, std::vector<StringSwitchCase> const& cases, bool case_insensitive)
+{
+	std::map<size_t, std::vector<StringSwitchCase const*>> buckets;
+	std::set<std::string> seen_keys;
+	for (auto& switch_case : cases)
+	{
+		auto key = switch_case.Key;
+		if (case_insensitive)
+			std::ranges::transform(key, key.begin(), LowercaseASCII);
+		if (seen_keys.insert(key).second)
+			buckets[key.size()].push_back(&switch_case);
+	}
+
+	if (buckets.empty())
+		return;
+
+	const auto compare = [&](std::string_view key) {
+		return case_insensitive
+			? std::format("::Reflector::EqualsIgnoreCaseASCII({}, {})", var, BuildCompileTimeLiteral(key))
+			: std::format("{} == {}", var, BuildCompileTimeLiteral(key));
+	};
+	const auto char_at = [&](size_t pos) {
+		return case_insensitive
+			? std::format("::Reflector::ToLowerASCII({}[{}])", var, pos)
+			: std::format("{}[{}]", var, pos);
+	};
+	const auto key_char = [&](StringSwitchCase const* switch_case, size_t pos) {
+		return case_insensitive ? LowercaseASCII(switch_case->Key[pos]) : switch_case->Key[pos];
+	};
+
+	output.WriteLine("switch ({}.size()) {{", var);
+	for (auto& [length, bucket] : buckets)
+	{
+		output.WriteLine("case {}:", length);
+		auto indent = output.Indent();
+
+		if (bucket.size() == 1)
+		{
+			output.WriteLine("if ({}) {}", compare(bucket[0]->Key), bucket[0]->Action);
+			output.WriteLine("break;");
+			continue;
+		}
+
+		/// Find the position at which the keys differ the most
+		size_t best_position = 0;
+		size_t best_distinct = 0;
+		for (size_t pos = 0; pos < length; ++pos)
+		{
+			std::set<char> distinct;
+			for (auto switch_case : bucket)
+				distinct.insert(key_char(switch_case, pos));
+			if (distinct.size() > best_distinct)
+			{
+				best_distinct = distinct.size();
+				best_position = pos;
+			}
+		}
+
+		std::map<char, std::vector<StringSwitchCase const*>> by_char;
+		for (auto switch_case : bucket)
+			by_char[key_char(switch_case, best_position)].push_back(switch_case);
+
+		output.WriteLine("switch ({}) {{", char_at(best_position));
+		for (auto& [c, char_bucket] : by_char)
+		{
+			output.WriteLine("case {}:", BuildCharLiteral(c));
+			auto char_indent = output.Indent();
+			for (auto switch_case : char_bucket)
+				output.WriteLine("if ({}) {}", compare(switch_case->Key), switch_case->Action);
+			output.WriteLine("break;");
+		}
+		output.WriteLine("}}");
+		output.WriteLine("break;");
+	}
+	output.WriteLine("}}");
+}
+
+/// Writes a lookup of the field name `key_var` (whose `FieldNameHash` is in `hash_var`) against a set of field names,
+/// as a single `switch` on the hash, followed by a full comparison of the name. Each action should end with a `return`.
+static void WriteFieldNameHashSwitch(FileWriter& output, std::string_view hash_var, std::string_view key_var, std::vector<StringSwitchCase> const& cases)
+{
+	std::map<uint32_t, std::vector<StringSwitchCase const*>> buckets;
+	for (auto& switch_case : cases)
+		buckets[FieldNameHash(switch_case.Key)].push_back(&switch_case);
+
+	if (buckets.empty())
+		return;
+
+	output.WriteLine("switch ({}) {{", hash_var);
+	for (auto& [hash, bucket] : buckets)
+	{
+		output.WriteLine("case 0x{:08x}u:", hash);
+		auto indent = output.Indent();
+		for (auto switch_case : bucket)
+			output.WriteLine("if ({} == {}) {}", key_var, BuildCompileTimeLiteral(switch_case->Key), switch_case->Action);
+		output.WriteLine("break;");
+	}
+	output.WriteLine("}}");
+}
+
+/// Returns the fully-qualified name of the written struct, or an empty string if the declaration has no compile-time attributes
+std::string FileMirrorOutputContext::WriteCompileTimeAttributes(const Declaration& decl, std::string_view attributes_namespace, std::string_view struct_name)
+{
+	std::vector<std::pair<std::string, json const*>> attributes;
+	for (auto const& attribute : decl.Attributes.items())
+		if (IsCompileTimeAttribute(attribute.key(), attribute.value()))
+			attributes.emplace_back(attribute.key(), &attribute.value());
+
+	if (attributes.empty())
+		return {};
+
+	auto const& flag_names = AttributeFlagNames();
+	std::vector<std::string> flag_bits;
+	for (auto& [name, value] : attributes)
+	{
+		if (value->is_boolean() && value->get<bool>() && std::ranges::find(flag_names, name) != flag_names.end())
+			flag_bits.push_back(std::format("(1ULL << uint64_t(::Reflector::AttributeFlag::{}))", name));
+	}
+
+	output.StartBlock("struct {} {{", struct_name);
+	output.WriteLine("static constexpr uint64_t AttributeFlagBits = {};", flag_bits.empty() ? "0" : join(flag_bits, " | "));
+	output.WriteLine("static constexpr std::array<std::string_view, {}> AttributeNames = {{ {} }};", attributes.size(), join(attributes, ", ", [](auto const& attribute) {
+		return BuildCompileTimeLiteral(attribute.first);
+	}));
+	for (auto& [name, value] : attributes)
+	{
+		if (value->is_boolean())
+			output.WriteLine("static constexpr bool {} = {};", name, value->get<bool>());
+		else if (value->is_number_float())
+			output.WriteLine("static constexpr double {} = {};", name, value->get<double>());
+		else if (value->is_number_unsigned() && value->get<uint64_t>() > uint64_t(std::numeric_limits<int64_t>::max()))
+			output.WriteLine("static constexpr uint64_t {} = {}ULL;", name, value->get<uint64_t>());
+		else if (value->is_number())
+			output.WriteLine("static constexpr int64_t {} = {};", name, value->get<int64_t>());
+		else
+			output.WriteLine("static constexpr std::string_view {} = {};", name, BuildCompileTimeLiteral(value->get_ref<std::string const&>()));
+	}
+	output.EndBlock("}};");
+
+	return std::format("::{}::{}", attributes_namespace, struct_name);
+}
+
 bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 {
 	output.WriteLine("/// From class: {}", klass.FullType());
@@ -225,6 +704,36 @@ bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 	//output.WriteLine("constexpr ::std::string_view GetClassName(::std::type_identity<{}>) noexcept {{ return \"{}\"; }}", klass.FullType(), klass.Name);
 	//output.WriteLine("constexpr ::std::string_view GetFullClassName(::std::type_identity<{}>) noexcept {{ return \"{}\"; }}", klass.FullType(), klass.FullName());
 
+	/// ///////////////////////////////////// ///
+	/// Compile-time attributes
+	/// ///////////////////////////////////// ///
+
+	std::string class_attributes;
+	std::vector<std::string> field_attributes(klass.Fields.size());
+	std::vector<std::string> method_attributes(klass.Methods.size());
+	std::vector<std::string> property_attributes(klass.Properties.size());
+	if (HasCompileTimeAttributes(klass)
+		|| std::ranges::any_of(klass.Fields, [](auto const& field) { return HasCompileTimeAttributes(*field); })
+		|| std::ranges::any_of(klass.Methods, [](auto const& method) { return HasCompileTimeAttributes(*method); })
+		|| std::ranges::any_of(klass.Properties | std::views::values, HasCompileTimeAttributes))
+	{
+		const auto attributes_namespace = std::format("{}_Attributes_{}", options.MacroPrefix, klass.GeneratedUniqueName());
+		output.StartBlock("namespace {} {{", attributes_namespace);
+		class_attributes = WriteCompileTimeAttributes(klass, attributes_namespace, "Class");
+		for (size_t i = 0; i < klass.Fields.size(); i++)
+			field_attributes[i] = WriteCompileTimeAttributes(*klass.Fields[i], attributes_namespace, std::format("Field{}", i));
+		for (size_t i = 0; i < klass.Methods.size(); i++)
+			method_attributes[i] = WriteCompileTimeAttributes(*klass.Methods[i], attributes_namespace, std::format("Method{}", i));
+		size_t property_index = 0;
+		for (const auto& property : klass.Properties | std::views::values)
+		{
+			property_attributes[property_index] = WriteCompileTimeAttributes(property, attributes_namespace, std::format("Property{}", property_index));
+			++property_index;
+		}
+		output.EndBlock("}}");
+	}
+	const auto attributes_parameter = [](std::string const& attributes) { return attributes.empty() ? std::string{} : ", " + attributes; };
+
 	/// ///////////////////////////////////// ///
 	/// Visitor macros
 	/// ///////////////////////////////////// ///
@@ -235,7 +744,7 @@ bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 	{
 		const auto& field = klass.Fields[i];
 		const auto ptr_str = "&" + klass.FullType() + "::" + field->Name;
-		output.WriteLine("{0}{1}_VISITOR(::Reflector::FieldVisitorData<::Reflector::CompileTimeFieldData<{2}, {3}, {4}, {5}, decltype({6}), {6}>>{{ &{3}::StaticGetReflectionData().Fields[{7}] }});",
+		output.WriteLine("{0}{1}_VISITOR(::Reflector::FieldVisitorData<::Reflector::CompileTimeFieldData<{2}, {3}, {4}, {5}, decltype({6}), {6}{8}>>{{ &{3}::StaticGetReflectionData().Fields[{7}] }});",
 			DebuggingComment(options, field->Name),
 			options.MacroPrefix, 
 			field->Type, /// 2
@@ -243,7 +752,8 @@ bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 			field->Flags.bits, /// 4
 			BuildCompileTimeLiteral(field->Name), /// 5
 			ptr_str, /// 6
-			i /// 7
+			i, /// 7
+			attributes_parameter(field_attributes[i]) /// 8
 		);
 	}
 	output.EndDefine("");
@@ -257,8 +767,8 @@ bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 		
 		const auto method_pointer = std::format("({})&{}::{}", method->GetSignature(klass), klass_full_type, method->Name);
 		const auto parameter_tuple = std::format("::std::tuple<{}>", method->ParametersTypesOnly);
-		const auto compile_time_method_data = std::format("::Reflector::CompileTimeMethodData<{0}, {1}, {2}, {3}, {4}, decltype({5}), {5}, ::Reflector::AccessMode::{6}>", 
-			method->Return.Name, parameter_tuple, klass_full_type, method->Flags.bits, BuildCompileTimeLiteral(method->Name), method_pointer, magic_enum::enum_name(method->Access)
+		const auto compile_time_method_data = std::format("::Reflector::CompileTimeMethodData<{0}, {1}, {2}, {3}, {4}, decltype({5}), {5}, ::Reflector::AccessMode::{6}{7}>", 
+			method->Return.Name, parameter_tuple, klass_full_type, method->Flags.bits, BuildCompileTimeLiteral(method->Name), method_pointer, magic_enum::enum_name(method->Access), attributes_parameter(method_attributes[i])
 		);
 
 		const auto debugging_comment_prefix = options.DebuggingComments ? std::format("/* {} */ ", method->Name) : std::string{};
@@ -304,8 +814,8 @@ bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 		const auto compile_time_method_data = std::format("::Reflector::CompileTimeMethodData<{0}, {1}, {2}, {3}, {4}, decltype({5}), {5}, ::Reflector::AccessMode::{6}>",
 			method->Return.Name, parameter_tuple, klass_full_type, method->Flags.bits, BuildCompileTimeLiteral(method->Name), method_pointer, magic_enum::enum_name(method->Access)
 		);*/
-		const auto compile_time_property_data = std::format("::Reflector::CompileTimeCommonData<{0}, {1}, {2}, {3}>",
-			property.Type, klass.FullType(), property.Flags.bits, BuildCompileTimeLiteral(property.Name));
+		const auto compile_time_property_data = std::format("::Reflector::CompileTimeCommonData<{0}, {1}, {2}, {3}{4}>",
+			property.Type, klass.FullType(), property.Flags.bits, BuildCompileTimeLiteral(property.Name), attributes_parameter(property_attributes[property_index]));
 
 		const auto debugging_comment_prefix = options.DebuggingComments ? std::format("/* {} */ ", property.Name) : std::string{};
 		output.WriteLine("{}{}_VISITOR(::Reflector::PropertyVisitorData<{}>{{ &{}::StaticGetReflectionData().Properties[{}] }});",
@@ -342,18 +852,117 @@ bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 	{
 		output.WriteLine("using parent_type = void;");
 	}
+	output.WriteLine("using self_attributes = {};", class_attributes.empty() ? "::Reflector::NoAttributes" : class_attributes);
 
-	if (options.JSON.Use && Attribute::Serialize.GetOr(klass, true) != false)
+	if (options.JSON.Use && options.JSON.GenerateSerializationMethods && Attribute::Serialize.GetOr(klass, true) != false)
 	{
+		const auto loadable_fields = std::ranges::count_if(klass.Fields, [](auto& field) { return !field->Flags.contain(FieldFlags::NoLoad); });
 		if (!klass.BaseClass.empty())
 		{
 			output.WriteLine("virtual void JSONLoadFields(REFLECTOR_JSON_TYPE const& src_object) override;", options.JSON.Type);
 			output.WriteLine("virtual void JSONSaveFields(REFLECTOR_JSON_TYPE& src_object) const override;", options.JSON.Type);
+			output.WriteLine("static constexpr size_t JSONLoadableFieldCount = parent_type::JSONLoadableFieldCount + {};", loadable_fields);
+			output.WriteLine("virtual bool JSONLoadField(uint32_t key_hash, std::string_view key, REFLECTOR_JSON_TYPE const& value, ::Reflector::JSONLoadedFields& loaded) override;");
+			output.WriteLine("virtual void JSONLoadFinish(::Reflector::JSONLoadedFields const& loaded) override;");
 		}
 		else
 		{
 			output.WriteLine("void JSONLoadFields(REFLECTOR_JSON_TYPE const& src_object);", options.JSON.Type);
 			output.WriteLine("void JSONSaveFields(REFLECTOR_JSON_TYPE& src_object) const;", options.JSON.Type);
+			output.WriteLine("static constexpr size_t JSONLoadableFieldCount = {};", loadable_fields);
+			output.WriteLine("bool JSONLoadField(uint32_t key_hash, std::string_view key, REFLECTOR_JSON_TYPE const& value, ::Reflector::JSONLoadedFields& loaded);");
+			output.WriteLine("void JSONLoadFinish(::Reflector::JSONLoadedFields const& loaded);");
+		}
+		if (GeneratesJSONSchema(options, klass))
+		{
+			output.WriteLine("static constexpr uint64_t JSONSchemaHash = 0x{:016x}ULL;", JSONSchemaHash(options, klass));
+			output.WriteLine("void JSONLoadValidatedFields(REFLECTOR_JSON_TYPE::object_t const& src_object);");
+		}
+	}
+
+	if (options.JSON.Use && options.JSON.GenerateSerializationMethods && options.JSON.GenerateStreamingLoadMethods && Attribute::Serialize.GetOr(klass, true) != false)
+	{
+		if (!klass.BaseClass.empty())
+			output.WriteLine("virtual bool JSONSAXField(uint32_t key_hash, std::string_view key, ::Reflector::JSONSAXLoader& loader, ::Reflector::JSONLoadedFields& loaded) override;");
+		else
+			output.WriteLine("bool JSONSAXField(uint32_t key_hash, std::string_view key, ::Reflector::JSONSAXLoader& loader, ::Reflector::JSONLoadedFields& loaded);");
+	}
+
+	if (options.JSON.Use && options.JSON.GenerateSerializationMethods && options.JSON.GenerateStreamingSaveMethods && Attribute::Serialize.GetOr(klass, true) != false)
+	{
+		if (!klass.BaseClass.empty())
+			output.WriteLine("virtual void JSONWriteFields(::Reflector::JSONWriter& writer) const override;");
+		else
+			output.WriteLine("void JSONWriteFields(::Reflector::JSONWriter& writer) const;");
+	}
+
+	if (options.Binary.Use && Attribute::Serialize.GetOr(klass, true) != false)
+	{
+		if (!klass.BaseClass.empty())
+		{
+			output.WriteLine("virtual void BinaryLoadFields(::Reflector::BinaryObject const& src_object) override;");
+			output.WriteLine("virtual void BinarySaveFields(::Reflector::BinaryWriter& dest_object) const override;");
+		}
+		else
+		{
+			output.WriteLine("void BinaryLoadFields(::Reflector::BinaryObject const& src_object);");
+			output.WriteLine("void BinarySaveFields(::Reflector::BinaryWriter& dest_object) const;");
+		}
+	}
+
+	/// The flat layout of the class only has slots for its own fields, placed after the slots of its base class (if it has a flat view too)
+	if (HasFlatView(options, klass))
+	{
+		const auto parent_class = Class::FindClassByPossiblyQualifiedName(klass.BaseClass, &klass);
+		const auto parent_has_flat_view = parent_class && HasFlatView(options, *parent_class);
+		const auto flat_fields = FlatFields(klass);
+
+		output.WriteLine("static constexpr auto FlatLayout() {{ return ::Reflector::MakeFlatLayout<{}>({}); }}",
+			join(flat_fields, ", ", [](Field const* field) { return field->Type; }),
+			parent_has_flat_view ? "parent_type::FlatLayout().Size, parent_type::FlatLayout().Alignment" : "");
+		output.WriteLine("void FlatWriteFields(::Reflector::FlatWriter& writer, size_t table) const;");
+		output.WriteLine("static bool FlatVerifyFields(::Reflector::FlatVerifier& verifier, size_t table);");
+		output.StartBlock("struct View : {} {{", parent_has_flat_view ? "parent_type::View" : "::Reflector::FlatViewBase");
+		output.WriteLine("using {0}::{1};", parent_has_flat_view ? "parent_type::View" : "::Reflector::FlatViewBase", parent_has_flat_view ? "View" : "FlatViewBase");
+		for (size_t i = 0; i < flat_fields.size(); ++i)
+		{
+			output.WriteLine("auto {}{}() const {{ return ::Reflector::FlatTraits<{}>::Read(this->mTable + ::Reflector::FlatFieldOffset<self_type, {}>); }}",
+				options.Names.GetterPrefix, flat_fields[i]->CleanName, flat_fields[i]->Type, i);
+		}
+		output.EndBlock("}};");
+	}
+
+	/// Each class in a change-tracking hierarchy tracks its own fields; the methods chain to the parent class if it tracks its fields too
+	if (klass.TracksChanges())
+	{
+		const auto parent_class = Class::FindClassByPossiblyQualifiedName(klass.BaseClass, &klass);
+		const auto parent_tracks_changes = parent_class && parent_class->TracksChanges();
+		const auto virtual_prefix = klass.BaseClass.empty() ? "" : "virtual ";
+		const auto override_suffix = parent_tracks_changes ? " override" : "";
+
+		output.WriteLine("::std::bitset<{}> mChangedFields_{{}};", std::max<size_t>(klass.Fields.size(), 1));
+		if (parent_tracks_changes)
+		{
+			output.WriteLine("virtual bool HasChanges() const noexcept override {{ return parent_type::HasChanges() || this->mChangedFields_.any(); }}");
+			output.WriteLine("virtual void ClearChanges() noexcept override {{ parent_type::ClearChanges(); this->mChangedFields_.reset(); }}");
+			output.WriteLine("virtual void MarkAllChanged() noexcept override {{ parent_type::MarkAllChanged(); this->mChangedFields_.set(); }}");
+		}
+		else
+		{
+			output.WriteLine("{}bool HasChanges() const noexcept {{ return this->mChangedFields_.any(); }}", virtual_prefix);
+			output.WriteLine("{}void ClearChanges() noexcept {{ this->mChangedFields_.reset(); }}", virtual_prefix);
+			output.WriteLine("{}void MarkAllChanged() noexcept {{ this->mChangedFields_.set(); }}", virtual_prefix);
+		}
+
+		if (options.JSON.Use && options.JSON.GenerateSerializationMethods && Attribute::Serialize.GetOr(klass, true) != false)
+		{
+			output.WriteLine("{}void SaveDelta(REFLECTOR_JSON_TYPE& dest_object){};", virtual_prefix, override_suffix);
+			output.WriteLine("{}void LoadDelta(REFLECTOR_JSON_TYPE const& src_object){};", virtual_prefix, override_suffix);
+		}
+		if (options.Binary.Use && Attribute::Serialize.GetOr(klass, true) != false)
+		{
+			output.WriteLine("{}void BinarySaveDelta(::Reflector::BinaryWriter& dest_object){};", virtual_prefix, override_suffix);
+			output.WriteLine("{}void BinaryLoadDelta(::Reflector::BinaryObject const& src_object){};", virtual_prefix, override_suffix);
 		}
 	}
 
@@ -411,6 +1020,48 @@ bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 			output.WriteLine("\tparent_type::GCMark();");
 		output.WriteLine("\tForEachField([this](auto&& visitor_data) {{ ::Reflector::GCMark(visitor_data.Getter(this)); }});");
 		output.WriteLine("}}");
+
+		/// - Pointer map, used by the collector instead of GCMark; structs are never on the heap, so they don't need one
+		/// Only the maps of generated parents describe their fields; other parents are marked by their `GCMark`
+		/// (except `Reflectable` itself, which has no fields to mark)
+		if (!klass.Flags.contain(ClassFlags::Struct))
+		{
+			const auto parent_is_generated = Class::FindClassByPossiblyQualifiedName(klass.BaseClass, &klass) != nullptr;
+
+			/// The entries are built at compile time, from the offsets and types of the fields
+			output.WriteLine("REFLECTOR_GC_OFFSETOF_BEGIN");
+			output.StartBlock("static constexpr auto GCPointerFields() {{");
+			if (parent_is_generated)
+				output.StartBlock("return ::Reflector::GCPointerFields(parent_type::GCPointerFields(), [] {{ return ::Reflector::GCFieldEntries(");
+			else
+				output.StartBlock("return ::Reflector::GCPointerFields(::Reflector::GCPointerFieldList<0>{{ {{}}, std::is_same_v<parent_type, ::Reflector::Reflectable> }}, [] {{ return ::Reflector::GCFieldEntries(");
+			for (size_t i = 0; i < klass.Fields.size(); i++)
+			{
+				const auto& field = klass.Fields[i];
+				const auto separator = i + 1 < klass.Fields.size() ? "," : "";
+				if (field->Flags.contain(FieldFlags::Static))
+					output.WriteLine("::Reflector::GCStaticField<{}>(){}", field->Type, separator);
+				else
+					output.WriteLine("::Reflector::GCMemberField<{}>(offsetof({}, {})){}", field->Type, klass.FullType(), field->Name, separator);
+			}
+			output.EndBlock("); }});");
+			output.EndBlock("}}");
+			output.WriteLine("REFLECTOR_GC_OFFSETOF_END");
+
+			output.StartBlock("virtual ::Reflector::GCPointerMap const& GCGetPointerMap() const override {{");
+			output.WriteLine("static constexpr auto _fields = GCPointerFields();");
+			output.WriteLine("static constexpr ::Reflector::GCPointerMap _map{{ _fields.Entries, _fields.Complete }};");
+			output.WriteLine("return _map;");
+			output.EndBlock("}}");
+
+			output.WriteLine("virtual void GCMarkUnmapped() const override {{");
+			if (parent_is_generated)
+				output.WriteLine("\tparent_type::GCMarkUnmapped();");
+			else
+				output.WriteLine("\tif constexpr (!std::is_same_v<parent_type, ::Reflector::Reflectable>) parent_type::GCMark();");
+			output.WriteLine("\tForEachField([this](auto&& visitor_data) {{ ::Reflector::GCMarkIfUnmapped(this, visitor_data); }}, true);");
+			output.WriteLine("}}");
+		}
 	}
 
 
@@ -448,7 +1099,7 @@ bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 		{
 			const auto& field = klass.Fields[i];
 			const auto ptr_str = "&T::" + field->Name;
-			output.WriteLine("static inline ::Reflector::FieldVisitorData<::Reflector::CompileTimeFieldData<{2}, {3}, {4}, {5}, decltype({6}), {6}>> {8} {{ &{3}::StaticGetReflectionData().Fields[{7}] }};",
+			output.WriteLine("static inline ::Reflector::FieldVisitorData<::Reflector::CompileTimeFieldData<{2}, {3}, {4}, {5}, decltype({6}), {6}{9}>> {8} {{ &{3}::StaticGetReflectionData().Fields[{7}] }};",
 				0, 0,
 				field->Type, /// 2
 				"T", /// 3 
@@ -456,7 +1107,8 @@ bool FileMirrorOutputContext::BuildClassEntry(const Class& klass)
 				BuildCompileTimeLiteral(field->Name), /// 5
 				ptr_str, /// 6
 				i, /// 7
-				field->Name /// 8
+				field->Name, /// 8
+				attributes_parameter(field_attributes[i]) /// 9
 			);
 		}
 
@@ -511,6 +1163,18 @@ bool FileMirrorOutputContext::BuildEnumEntry(const Enum& henum)
 	const auto has_any_enumerators = !henum.Enumerators.empty();
 	output.WriteLine("/// From enum: {}", henum.FullType());
 
+	/// Non-consecutive enums get a value-to-index table; a dense one if the values are packed closely enough,
+	/// otherwise one sorted by value, for binary search
+	int64_t min_value = 0, max_value = 0;
+	if (has_any_enumerators)
+	{
+		const auto [min_it, max_it] = std::ranges::minmax_element(henum.Enumerators, {}, [](auto const& enumerator) { return enumerator->Value; });
+		min_value = (*min_it)->Value;
+		max_value = (*max_it)->Value;
+	}
+	const auto value_span = uint64_t(max_value) - uint64_t(min_value) + 1;
+	const bool use_dense_index_table = value_span != 0 && value_span <= std::max<uint64_t>(64, 2 * henum.Enumerators.size());
+
 	WriteForwardDeclaration(henum);
 
 	/// TODO: Make the name of this function configurable
@@ -558,6 +1222,26 @@ bool FileMirrorOutputContext::BuildEnumEntry(const Enum& henum)
 
 			output.WriteLine("constexpr inline {0} First{0} = {0}{{{1}}};", henum.Name, henum.Enumerators.front()->Value);
 			output.WriteLine("constexpr inline {0} Last{0} = {0}{{{1}}};", henum.Name, henum.Enumerators.back()->Value);
+
+			if (!henum.IsConsecutive())
+			{
+				std::map<int64_t, size_t> index_by_value;
+				for (size_t i = 0; i < henum.Enumerators.size(); ++i)
+					index_by_value.try_emplace(henum.Enumerators[i]->Value, i); /// First enumerator with a given value wins
+				if (use_dense_index_table)
+				{
+					std::vector<size_t> dense(value_span, henum.Enumerators.size());
+					for (auto& [value, index] : index_by_value)
+						dense[uint64_t(value) - uint64_t(min_value)] = index;
+					output.WriteLine("constexpr inline uint32_t {}IndicesByValue[] = {{ {} }};", henum.Name, join(dense, ", ", [](size_t index) { return std::to_string(index); }));
+				}
+				else
+				{
+					output.WriteLine("constexpr inline std::pair<int64_t, uint32_t> {}IndicesBySortedValue[] = {{ {} }};", henum.Name, join(index_by_value, ", ", [](auto const& kvp) {
+						return std::format("{{ {}, {} }}", kvp.first, kvp.second);
+					}));
+				}
+			}
 		}
 	}
 
@@ -575,7 +1259,8 @@ bool FileMirrorOutputContext::BuildEnumEntry(const Enum& henum)
 		output.WriteLine("constexpr {0} GetEnumeratorValue({0}, size_t index) {{ return {{}}; }}", henum.Name);
 
 
-	output.WriteLine("constexpr size_t GetEnumeratorIndex({} v) {{", henum.Name);
+	/// Returns `if_not_found` if `v` is not a value of any enumerator
+	output.WriteLine("constexpr size_t GetEnumeratorIndex({} v, size_t if_not_found = 0) {{", henum.Name);
 	{
 		auto indent = output.Indent();
 
@@ -583,19 +1268,24 @@ bool FileMirrorOutputContext::BuildEnumEntry(const Enum& henum)
 		{
 			if (henum.IsConsecutive())
 			{
-				output.WriteLine("if (int64_t(v) >= {0} && int64_t(v) <= {1}) return size_t(v) - size_t({0});", henum.Enumerators.front()->Value, henum.Enumerators.back()->Value, henum.Name);
+				output.WriteLine("if (int64_t(v) >= {0} && int64_t(v) <= {1}) return size_t(int64_t(v) - ({0}));", henum.Enumerators.front()->Value, henum.Enumerators.back()->Value);
 			}
 			else
 			{
-				output.WriteLine("switch (int64_t(v)) {{");
-				for (auto& enumerator : henum.Enumerators)
+				if (use_dense_index_table)
+				{
+					output.WriteLine("if (int64_t(v) >= {0} && int64_t(v) <= {1}) {{", min_value, max_value);
+					output.WriteLine("\tif (const auto index = {0}IndicesByValue[uint64_t(int64_t(v)) - uint64_t({1})]; index != {0}Count) return index;", henum.Name, min_value);
+					output.WriteLine("}}");
+				}
+				else
 				{
-					output.WriteLine("case {}: return {};", enumerator->Value, enumerator->Value);
+					output.WriteLine("const auto it = std::ranges::lower_bound({0}IndicesBySortedValue, int64_t(v), {{}}, &std::pair<int64_t, uint32_t>::first);", henum.Name);
+					output.WriteLine("if (it != std::ranges::end({0}IndicesBySortedValue) && it->first == int64_t(v)) return it->second;", henum.Name);
 				}
-				output.WriteLine("}}");
 			}
 		}
-		output.WriteLine("return 0;");
+		output.WriteLine("return if_not_found;");
 	}
 	output.WriteLine("}}");
 
@@ -605,90 +1295,48 @@ bool FileMirrorOutputContext::BuildEnumEntry(const Enum& henum)
 
 		if (has_any_enumerators)
 		{
-			if (henum.IsConsecutive())
-			{
-				output.WriteLine("if (int64_t(v) >= {0} && int64_t(v) <= {1}) return display_name ? {2}DisplayNamesByIndex[int64_t(v)-({0})] : {2}NamesByIndex[int64_t(v)-({0})];", henum.Enumerators.front()->Value, henum.Enumerators.back()->Value, henum.Name);
-			}
-			else
-			{
-				output.WriteLine("switch (int64_t(v)) {{");
-				for (auto& enumerator : henum.Enumerators)
-				{
-					if (enumerator->DisplayName == enumerator->Name)
-						output.WriteLine("case {}: return \"{}\";", enumerator->Value, enumerator->Name);
-					else
-						output.WriteLine(R"(case {}: return display_name ? "{}" : "{}";)", enumerator->Value, enumerator->DisplayName, enumerator->Name);
-				}
-				output.WriteLine("}}");
-			}
+			output.WriteLine("if (const auto index = GetEnumeratorIndex(v, {0}Count); index < {0}Count) return display_name ? {0}DisplayNamesByIndex[index] : {0}NamesByIndex[index];", henum.Name);
 		}
 		output.WriteLine("return \"<Unknown>\";");
 	}
 	output.WriteLine("}}"); 
-	/// TODO: Should this return std::optional?
-	/// TODO: Implement the ones below and check performance using https://quick-bench.com/
-	/// Cases:
-	///		naive
-	///		magic_enum::enum_value("str")
-	///		mph
-	///		switch trie
-	/// TODO: EITHER: Use mph ( https://www.ibiblio.org/pub/Linux/devel/lang/c/!INDEX.short.html Q:\Code\Native\External\mph https://github.com/boost-ext/mph ) to generate a minimal perfect hash function for this
-	/// TODO: OR, generate a TRIE and then for leafs check for equality, and for non-leafs switch against the first character:
-	/*
-		constexpr auto check(TT out, char const* a, char const* b) -> TT {
-			return std::strcmp(a, b) ? ILLEGAL : out;
-		}
 
-		constexpr auto lookup(char const* kw) -> TT 
+	/// The name lookups below are generated as a switch on the name length and then on its most distinctive character
+	/// (see WriteStringSwitch), so they do a single string comparison regardless of the number of enumerators.
+	/// TODO: Should these return std::optional?
+	/// TODO: Make the name of these functions configurable
+	const bool has_distinct_display_names = std::ranges::any_of(henum.Enumerators, [](auto const& enumerator) { return enumerator->DisplayName != enumerator->Name; });
+	const auto write_name_lookup = [&](bool case_insensitive) {
+		const auto name_cases = [&](bool display_names) {
+			std::vector<StringSwitchCase> cases;
+			for (auto& enumerator : henum.Enumerators)
+				cases.push_back({ display_names ? enumerator->DisplayName : enumerator->Name, std::format("return ({}){};", henum.Name, enumerator->Value) });
+			return cases;
+		};
+		auto indent = output.Indent();
+		if (has_distinct_display_names)
 		{
-			switch (*kw++) {
-				default: return ILLEGAL;
-
-				case 'a': return check(AND,    kw, "nd");
-				case 'c': return check(CLASS,  kw, "lass");
-				case 'e': return check(ELSE,   kw, "lse");
-				case 'i': return check(IF,     kw, "f");
-				case 'n': return check(NIL,    kw, "il");
-				case 'o': return check(OR,     kw, "r");
-				case 'p': return check(PRINT,  kw, "rint");
-				case 'r': return check(RETURN, kw, "eturn");
-				case 's': return check(SUPER,  kw, "uper");
-				case 'w': return check(WHILE,  kw, "hile");
-
-				case 'f': 
-					switch (*kw++) {
-						default: return ILLEGAL;
-						case 'a': return check(FALSE, kw, "lse");
-						case 'o': return check(FOR,   kw, "r");
-						case 'u': return check(FUN,   kw, "n");
-					}
-
-				case 't': 
-					switch (*kw++) {
-						default: return ILLEGAL;
-						case 'h': return check(THIS, kw, "is");
-						case 'r': return check(TRUE, kw, "ue");
-					}
-			}
-		}
-	*/
-	/// TODO: Make the name of this function configurable
-	output.WriteLine("constexpr {0} GetEnumeratorFromName({0}, std::string_view name) {{", henum.Name);
-	{
-		auto indent = output.Indent();
-		for (auto& enumerator : henum.Enumerators)
-		{
-			output.WriteLine("if (name == \"{}\") return ({}){};", enumerator->Name, henum.Name, enumerator->Value);
+			output.StartBlock("if (display_name) {{");
+			WriteStringSwitch(output, "name", name_cases(true), case_insensitive);
+			output.WriteLine("return {{}};");
+			output.EndBlock("}}");
 		}
+		WriteStringSwitch(output, "name", name_cases(false), case_insensitive);
 		output.WriteLine("return {{}};");
-	}
+	};
+
+	output.WriteLine("constexpr {0} GetEnumeratorFromName({0}, std::string_view name, bool display_name = false) {{", henum.Name);
+	write_name_lookup(false);
+	output.WriteLine("}}");
+	output.WriteLine("constexpr {0} GetEnumeratorFromNameIgnoreCase({0}, std::string_view name, bool display_name = false) {{", henum.Name);
+	write_name_lookup(true);
 	output.WriteLine("}}");
 
 	if (has_any_enumerators && Attribute::List(henum))
 	{
 		/// TODO: Make the name of these functions configurable
-		output.WriteLine("constexpr {0} GetNext({0} v) {{ return {0}ValuesByIndex[(int64_t(v) + 1) % {0}Count]; }}", henum.Name);
-		output.WriteLine("constexpr {0} GetPrev({0} v) {{ return {0}ValuesByIndex[(int64_t(v) + ({0}Count - 1)) % {0}Count]; }}", henum.Name);
+		output.WriteLine("constexpr {0} GetNext({0} v) {{ return {0}ValuesByIndex[(GetEnumeratorIndex(v) + 1) % {0}Count]; }}", henum.Name);
+		output.WriteLine("constexpr {0} GetPrev({0} v) {{ return {0}ValuesByIndex[(GetEnumeratorIndex(v) + ({0}Count - 1)) % {0}Count]; }}", henum.Name);
 
 		/// Preincrement
 		output.WriteLine("constexpr {0}& operator++({0}& v) {{ v = GetNext(v); return v; }}", henum.Name);
@@ -823,10 +1471,39 @@ void OutputContext::WriteForwardDeclaration(const Enum& henum)
 
 void OutputContext::BuildStaticReflectionData(const Enum& henum)
 {
-	output.StartBlock("::Reflector::Enum const& StaticGetReflectionData_For_{}() {{", henum.GeneratedUniqueName());
-	if (!henum.Namespace.empty())
-		output.WriteLine("using namespace {};", henum.Namespace);
-	output.StartBlock("static const ::Reflector::Enum _data = {{");
+	const bool constinit_database = options.ConstantInitializedDatabase;
+	const auto data_namespace = std::format("ReflectionData_{}", henum.GeneratedUniqueName());
+
+	const auto write_enumerators = [&] {
+		for (auto& enumerator : henum.Enumerators)
+		{
+			if (enumerator->Attributes.empty())
+				output.WriteLine(R"({{ "{}", "{}", {}, {}, }},)", enumerator->Name, enumerator->DisplayName, enumerator->Value, enumerator->Flags.bits);
+			else
+				output.WriteLine(R"({{ "{}", "{}", {}, {}, {} }},)", enumerator->Name, enumerator->DisplayName, enumerator->Value, enumerator->Flags.bits, EscapeJSON(enumerator->Attributes));
+		}
+	};
+
+	if (constinit_database)
+	{
+		output.StartBlock("namespace {} {{", data_namespace);
+		if (!henum.Namespace.empty())
+			output.WriteLine("using namespace {};", henum.Namespace);
+		if (!henum.Enumerators.empty())
+		{
+			output.StartBlock("constinit const ::Reflector::Enumerator Enumerators[] = {{");
+			write_enumerators();
+			output.EndBlock("}};");
+		}
+		output.StartBlock("constinit const ::Reflector::Enum Data = {{");
+	}
+	else
+	{
+		output.StartBlock("::Reflector::Enum const& StaticGetReflectionData_For_{}() {{", henum.GeneratedUniqueName());
+		if (!henum.Namespace.empty())
+			output.WriteLine("using namespace {};", henum.Namespace);
+		output.StartBlock("static const ::Reflector::Enum _data = {{");
+	}
 
 	output.WriteLine(".Name = \"{}\",", henum.Name);
 	if (!henum.DisplayName.empty())
@@ -835,25 +1512,32 @@ void OutputContext::BuildStaticReflectionData(const Enum& henum)
 	if (!henum.Attributes.empty())
 	{
 		output.WriteLine(".Attributes = {},", EscapeJSON(henum.Attributes));
-		if (options.JSON.Use)
-			output.WriteLine(".AttributesJSON = {}({}),", options.JSON.ParseFunction, EscapeJSON(henum.Attributes));
 	}
-	output.StartBlock(".Enumerators = {{");
-	for (auto& enumerator : henum.Enumerators)
+	if (constinit_database)
 	{
-		if (enumerator->Attributes.empty())
-			output.WriteLine(R"({{ "{}", "{}", {}, {}, }},)", enumerator->Name, enumerator->DisplayName, enumerator->Value, enumerator->Flags.bits);
-		else if (options.JSON.Use)
-			output.WriteLine(R"({{ "{}", "{}", {}, {}, {}, {}({}) }},)", enumerator->Name, enumerator->DisplayName, enumerator->Value, enumerator->Flags.bits, EscapeJSON(enumerator->Attributes), options.JSON.ParseFunction, EscapeJSON(enumerator->Attributes));
-		else
-			output.WriteLine(R"({{ "{}", "{}", {}, {}, {} }},)", enumerator->Name, enumerator->DisplayName, enumerator->Value, enumerator->Flags.bits, EscapeJSON(enumerator->Attributes));
+		if (!henum.Enumerators.empty())
+			output.WriteLine(".Enumerators = Enumerators,");
+	}
+	else
+	{
+		output.StartBlock(".Enumerators = {{");
+		write_enumerators();
+		output.EndBlock("}},");
 	}
-	output.EndBlock("}},");
 	output.WriteLine(".TypeIndex = typeid({}),", henum.FullType());
 	if (!henum.Flags.empty())
 		output.WriteLine(".Flags = {},", henum.Flags.bits);
-	output.EndBlock("}}; return _data;");
-	output.EndBlock("}}");
+	if (constinit_database)
+	{
+		output.EndBlock("}};");
+		output.EndBlock("}}");
+		output.WriteLine("::Reflector::Enum const& StaticGetReflectionData_For_{}() {{ return {}::Data; }}", henum.GeneratedUniqueName(), data_namespace);
+	}
+	else
+	{
+		output.EndBlock("}}; return _data;");
+		output.EndBlock("}}");
+	}
 
 	output.WriteLine("std::ostream& operator<<(std::ostream& strm, {} v) {{ strm << GetEnumeratorName(v); return strm; }}", henum.FullType());
 }
@@ -882,61 +1566,113 @@ void OutputContext::BuildStaticReflectionData(const Class& klass)
 
 	if (options.JSON.Use && options.JSON.GenerateSerializationMethods && Attribute::Serialize.GetOr(klass, true) != false)
 	{
+		/// All fields of the class hierarchy are loaded in a single pass over the source object: each key is hashed once,
+		/// and dispatched by the `JSONLoadField` methods of the class and its parents
 		output.StartBlock("void {}::JSONLoadFields({} const& src_object) {{", klass.FullType(), options.JSON.Type);
-		if (!klass.BaseClass.empty())
-			output.WriteLine("{}::parent_type::JSONLoadFields(src_object);", klass.FullType());
 
 		/// TODO: call this->BeforeSerialize(src_object);, etc
 
-		output.WriteLine();
+		const bool has_schema = GeneratesJSONSchema(options, klass);
+		const auto schema_hash = has_schema ? format("{:016x}", JSONSchemaHash(options, klass)) : std::string{};
+
+		output.WriteLine("::Reflector::JSONLoadedFields loaded;");
+		output.StartBlock("if (src_object.is_object()) {{");
+		/// Objects tagged with the hash of our schema were validated against it, so we can skip the tolerant load below
+		if (has_schema)
+		{
+			output.WriteLine("auto const& object = src_object.template get_ref<{}::object_t const&>();", options.JSON.Type);
+			output.StartBlock("if (auto it = object.find(\"{}\"); it != object.end() && it->second == \"{}\") {{", options.JSON.SchemaHashFieldName, schema_hash);
+			output.WriteLine("this->JSONLoadValidatedFields(object);");
+			output.WriteLine("return;");
+			output.EndBlock("}}");
+		}
+		output.StartBlock("for (auto const& [key, value] : src_object.template get_ref<{}::object_t const&>())", options.JSON.Type);
+		output.WriteLine("this->JSONLoadField(::Reflector::FieldNameHash(key), key, value, loaded);");
+		output.EndBlock();
+		output.EndBlock("}}");
+		output.WriteLine("this->JSONLoadFinish(loaded);");
+		output.EndBlock("}}");
+
+		const auto field_index_base = klass.BaseClass.empty() ? std::string{ "0" } : format("{}::parent_type::JSONLoadableFieldCount", klass.FullType());
+
+		std::vector<StringSwitchCase> cases;
+		size_t field_index = 0;
 		for (auto& field : klass.Fields)
 		{
 			if (field->Flags.contain(FieldFlags::NoLoad))
 				continue;
 
-			std::string reset_line;
-			if (!field->InitializingExpression.empty())
-			{
-				if (field->Flags.contain(FieldFlags::BraceInitialized))
-					reset_line = format("this->{} = {}{};", field->Name, field->Type, field->InitializingExpression);
-				else
-					reset_line = format("this->{} = {};", field->Name, field->InitializingExpression);
-			}
+			std::string load;
+			load += format("{{ loaded.Set(field_index_base + {}); ", field_index++);
+			load += format("using field_type = std::remove_cvref_t<decltype({})>; ", field->FullName("::"));
+			load += format("static_assert(::nlohmann::detail::is_basic_json<field_type>::value || ::nlohmann::detail::has_from_json<::nlohmann::json, field_type>::value, \"cannot serialize type '{0}' of field {1}\"); ", field->Type, field->FullName("::"));
+			/// Without exceptions for the common cases, as invalid fields are expected to be frequent if they are ignored
+			if (options.JSON.IgnoreInvalidObjectFields)
+				load += format("if (!::Reflector::TryGetJSON(value, this->{})) {} ", field->Name, FieldResetLine(*field));
 			else
-				reset_line = format("this->{0} = decltype(this->{0}){{}};", field->Name);
+				load += format("try {{ value.get_to<field_type>(this->{}); }} catch (::Reflector::DataError& e) {{ e.File += \"/{}\"; throw; }} ", field->Name, field->LoadName);
+			load += "return true; }";
+			cases.push_back({ field->LoadName, std::move(load) });
+		}
 
-			output.StartBlock("if (auto it = src_object.find(\"{}\"); it == src_object.end())", field->LoadName);
+		output.StartBlock("bool {}::JSONLoadField(uint32_t key_hash, std::string_view key, {} const& value, ::Reflector::JSONLoadedFields& loaded) {{", klass.FullType(), options.JSON.Type);
+		if (!cases.empty())
+		{
+			output.WriteLine("constexpr size_t field_index_base = {};", field_index_base);
+			WriteFieldNameHashSwitch(output, "key_hash", "key", cases);
+		}
+		if (!klass.BaseClass.empty())
+			output.WriteLine("return {}::parent_type::JSONLoadField(key_hash, key, value, loaded);", klass.FullType());
+		else
+			output.WriteLine("return false;");
+		output.EndBlock("}}");
 
+		output.StartBlock("void {}::JSONLoadFinish(::Reflector::JSONLoadedFields const& loaded) {{", klass.FullType());
+		if (!klass.BaseClass.empty())
+			output.WriteLine("{}::parent_type::JSONLoadFinish(loaded);", klass.FullType());
+		if (!cases.empty())
+			output.WriteLine("constexpr size_t field_index_base = {};", field_index_base);
+		field_index = 0;
+		for (auto& field : klass.Fields)
+		{
+			if (field->Flags.contain(FieldFlags::NoLoad))
+				continue;
+
+			output.StartBlock("if (!loaded.Test(field_index_base + {})){}", field_index++, DebuggingComment(options, field->LoadName));
 			if (field->Flags.contain(FieldFlags::Required))
 				output.WriteLine("throw ::Reflector::DataError{{ \"Missing field '{}'\" }};", field->LoadName);
 			else
-				output.WriteLine("{}", reset_line);
-
+				output.WriteLine("{}", FieldResetLine(*field));
 			output.EndBlock();
-			output.StartBlock("else try {{");
-			output.WriteLine("using field_type = std::remove_cvref_t<decltype({})>;", field->FullName("::"));
-			output.WriteLine("static_assert(::nlohmann::detail::is_basic_json<field_type>::value || ::nlohmann::detail::has_from_json<::nlohmann::json, field_type>::value, \"cannot serialize type '{0}' of field {1}\");", field->Type, field->FullName("::"));
-			output.WriteLine("it->get_to<field_type>(this->{});", field->Name);
-			output.EndBlock("}}");
-			if (options.JSON.IgnoreInvalidObjectFields)
-			{
-				output.StartBlock("catch (...) {{");
-				output.WriteLine("{}", reset_line);
-				/// TODO: Probably should report this error somehow
-				output.EndBlock("}}");
-			}
-			else
-			{
-				output.StartBlock("catch (::Reflector::DataError& e) {{");
-				output.WriteLine("e.File += \"/{}\";", field->LoadName);
-				output.WriteLine("throw;");
-				output.EndBlock("}}");
-			}
-
-			output.WriteLine();
 		}
 		output.EndBlock("}}");
 
+		/// Presence of required fields is still checked by `at`, so that a document with a forged hash results in an exception
+		/// instead of undefined behavior, but there is no tracking of loaded fields, and no per-field error handling
+		if (has_schema)
+		{
+			output.StartBlock("void {}::JSONLoadValidatedFields({}::object_t const& src_object) {{", klass.FullType(), options.JSON.Type);
+			if (!klass.BaseClass.empty())
+				output.WriteLine("{}::parent_type::JSONLoadValidatedFields(src_object);", klass.FullType());
+			for (auto& field : klass.Fields)
+			{
+				if (field->Flags.contain(FieldFlags::NoLoad))
+					continue;
+
+				if (field->Flags.contain(FieldFlags::Required))
+					output.WriteLine("src_object.at(\"{}\").get_to(this->{});", field->LoadName, field->Name);
+				else
+				{
+					output.StartBlock("if (auto it = src_object.find(\"{}\"); it != src_object.end())", field->LoadName);
+					output.WriteLine("it->second.get_to(this->{});", field->Name);
+					output.EndBlock();
+					output.StartBlock("else");
+					output.WriteLine("{}", FieldResetLine(*field));
+					output.EndBlock();
+				}
+			}
+			output.EndBlock("}}");
+		}
 
 		output.StartBlock("void {}::JSONSaveFields({}& dest_object) const {{", klass.FullType(), options.JSON.Type);
 		if (!klass.BaseClass.empty())
@@ -974,112 +1710,99 @@ void OutputContext::BuildStaticReflectionData(const Class& klass)
 			if (!klass.GUID.empty())
 				output.WriteLine(R"(dest_object["{}"] = "{}";)", options.JSON.ObjectGUIDFieldName, klass.GUID);
 		}
+		if (has_schema && options.JSON.SaveSchemaHash)
+			output.WriteLine(R"(dest_object["{}"] = "{}";)", options.JSON.SchemaHashFieldName, schema_hash);
 		output.EndBlock("}}");
 	}
 
-	output.StartBlock("::Reflector::Class const& StaticGetReflectionData_For_{}() {{", klass.GeneratedUniqueName());
-	if (!klass.Namespace.empty())
-		output.WriteLine("using namespace {};", klass.Namespace);
-	output.StartBlock("static const ::Reflector::Class _data = {{");
-	output.WriteLine(".Name = \"{}\",", klass.Name);
-	if (!klass.DisplayName.empty())
-		output.WriteLine(R"(.DisplayName = "{}",)", klass.DisplayName);
-	output.WriteLine(R"(.FullType = "{}",)", klass.FullType());
+	if (options.JSON.Use && options.JSON.GenerateSerializationMethods && options.JSON.GenerateStreamingLoadMethods && Attribute::Serialize.GetOr(klass, true) != false)
+		BuildJSONStreamingLoadMethods(klass);
 
-	/// TODO: Comment and describe here why we should only give the type as the parent class name, since we support full namespaced names?
-	///output.WriteLine(".BaseClassName = \"{}\",", OnlyType(klass.BaseClass));
-	output.WriteLine(R"(.BaseClassName = "{}",)", klass.BaseClass);
+	if (options.JSON.Use && options.JSON.GenerateSerializationMethods && options.JSON.GenerateStreamingSaveMethods && Attribute::Serialize.GetOr(klass, true) != false)
+		BuildJSONStreamingSaveMethods(klass);
 
-	if (!klass.Attributes.empty())
-	{
-		output.WriteLine(".Attributes = {},", EscapeJSON(klass.Attributes));
-		if (options.JSON.Use)
-			output.WriteLine(".AttributesJSON = {}({}),", options.JSON.ParseFunction, EscapeJSON(klass.Attributes));
-	}
-	output.WriteLine(".ReflectionUID = {}ULL,", klass.ReflectionUID);
-	if (!klass.GUID.empty())
-		output.WriteLine(".GUID = {},", EscapeString(klass.GUID));
-	output.WriteLine(".Alignment = alignof({0}),", klass.FullType());
-	output.WriteLine(".Size = sizeof({0}),", klass.FullType());
-	if (!klass.Flags.is_set(ClassFlags::NoConstructors))
-	{
-		output.WriteLine(".DefaultPlacementConstructor = +[](void* ptr){{ new (ptr) {0}({0}::StaticGetReflectionData()); }},", klass.FullType());
-		output.WriteLine(".DefaultConstructor = +[]() -> void* {{ return new {0}({0}::StaticGetReflectionData()); }},", klass.FullType());
-	}
-	output.WriteLine(".Destructor = +[](void* obj){{ auto _tobj = ({}*)obj; _tobj->~{}(); }},", klass.FullType(), klass.Name);
+	if (options.Binary.Use && Attribute::Serialize.GetOr(klass, true) != false)
+		BuildBinarySerializationMethods(klass);
 
-	/// Fields
-	output.StartBlock(".Fields = {{");
-	for (auto& field : klass.Fields)
-	{
+	if (klass.TracksChanges())
+		BuildChangeTrackingMethods(klass);
+
+	if (HasFlatView(options, klass))
+		BuildFlatViewMethods(klass);
+
+	/// In constinit mode, the reflection data lives in namespace-scope `constinit` arrays that the class data references via spans;
+	/// otherwise, it's a function-local static with the lists given inline.
+	const bool constinit_database = options.ConstantInitializedDatabase;
+	const auto data_namespace = std::format("ReflectionData_{}", klass.GeneratedUniqueName());
+	const auto parent_class_ref = constinit_database ? "&Data" : "&_data";
+
+	const auto write_field = [&](Field const& field) {
 		output.StartBlock("{{");
-		output.WriteLine(".Name = \"{}\",", field->Name);
-		if (!field->DisplayName.empty())
-			output.WriteLine(".DisplayName = \"{}\",", field->DisplayName);
-		output.WriteLine(".FieldType = \"{}\",", field->Type);
-		if (field->InitializingExpression == "{}")
+		output.WriteLine(".Name = \"{}\",", field.Name);
+		if (!field.DisplayName.empty())
+			output.WriteLine(".DisplayName = \"{}\",", field.DisplayName);
+		output.WriteLine(".FieldType = \"{}\",", field.Type);
+		if (field.InitializingExpression == "{}")
 			output.WriteLine(".Initializer = empty_json_object_str,");
-		else if (!field->InitializingExpression.empty())
-			output.WriteLine(".Initializer = {},", EscapeString(field->InitializingExpression));
-		if (!field->Attributes.empty())
+		else if (!field.InitializingExpression.empty())
+			output.WriteLine(".Initializer = {},", EscapeString(field.InitializingExpression));
+		if (!field.Attributes.empty())
 		{
-			output.WriteLine(".Attributes = {},", EscapeJSON(field->Attributes));
-			if (options.JSON.Use)
-				output.WriteLine(".AttributesJSON = {}({}),", options.JSON.ParseFunction, EscapeJSON(field->Attributes));
+			output.WriteLine(".Attributes = {},", EscapeJSON(field.Attributes));
 		}
-		output.WriteLine(".FieldTypeIndex = typeid({}),", field->Type);
-		if (!field->Flags.empty())
-			output.WriteLine(".Flags = {},", field->Flags.bits);
-		output.WriteLine(".ParentClass = &_data");
+		output.WriteLine(".FieldTypeIndex = typeid({}),", field.Type);
+		if (!field.Flags.empty())
+			output.WriteLine(".Flags = {},", field.Flags.bits);
+		output.WriteLine(".ParentClass = {}", parent_class_ref);
 		output.EndBlock("}},");
-	}
-	output.EndBlock("}},");
+	};
 
-	/// Methods
-	output.StartBlock(".Methods = {{");
-	for (auto& method : klass.Methods)
-	{
+	const auto write_method = [&](Method const& method, size_t method_index) {
 		output.StartBlock("::Reflector::Method {{");
-		output.WriteLine(".Name = \"{}\",", method->Name);
-		if (!method->DisplayName.empty())
-			output.WriteLine(".DisplayName = \"{}\",", method->DisplayName);
-		if (method->Return.Name != "void")
-			output.WriteLine(".ReturnType = \"{}\",", method->Return.Name);
-		if (!method->GetParameters().empty())
+		output.WriteLine(".Name = \"{}\",", method.Name);
+		if (!method.DisplayName.empty())
+			output.WriteLine(".DisplayName = \"{}\",", method.DisplayName);
+		if (method.Return.Name != "void")
+			output.WriteLine(".ReturnType = \"{}\",", method.Return.Name);
+		if (!method.GetParameters().empty())
 		{
-			output.WriteLine(".Parameters = {},", EscapeString(method->GetParameters()));
-			output.WriteLine(".ParametersSplit = {{ {} }},", join(method->ParametersSplit, ", ", [](MethodParameter const& param) {
-				return format("{{ {}, {}, {} }}", EscapeString(param.Name), EscapeString(param.Type), EscapeString(param.Initializer));
-			}));
+			output.WriteLine(".Parameters = {},", EscapeString(method.GetParameters()));
+			if (constinit_database)
+				output.WriteLine(".ParametersSplit = Method{}Parameters,", method_index);
+			else
+			{
+				output.WriteLine(".ParametersSplit = {{ {} }},", join(method.ParametersSplit, ", ", [](MethodParameter const& param) {
+					return format("{{ {}, {}, {} }}", EscapeString(param.Name), EscapeString(param.Type), EscapeString(param.Initializer));
+				}));
+			}
 		}
-		if (!method->Attributes.empty())
+		if (!method.Attributes.empty())
 		{
-			output.WriteLine(".Attributes = {},", EscapeJSON(method->Attributes));
-			if (options.JSON.Use)
-				output.WriteLine(".AttributesJSON = {}({}),", options.JSON.ParseFunction, EscapeJSON(method->Attributes));
+			output.WriteLine(".Attributes = {},", EscapeJSON(method.Attributes));
 		}
-		if (!method->UniqueName.empty())
-			output.WriteLine(".UniqueName = \"{}\",", method->UniqueName);
+		if (!method.UniqueName.empty())
+			output.WriteLine(".UniqueName = \"{}\",", method.UniqueName);
 		if (options.ReflectBodiesOfArtificialFunctions)
 		{
-			if (!method->ArtificialBody.empty())
-				output.WriteLine(".ArtificialBody = {},", EscapeString(method->ArtificialBody));
+			if (!method.ArtificialBody.empty())
+				output.WriteLine(".ArtificialBody = {},", EscapeString(method.ArtificialBody));
 		}
-		if (method->Return.Name != "void")
-			output.WriteLine(".ReturnTypeIndex = typeid({}),", method->Return.Name);
-		if (!method->GetParameters().empty())
-			output.WriteLine(".ParameterTypeIndices = {{ {} }},", join(method->ParametersSplit, ", ", [](MethodParameter const& param) { return format("typeid({})", param.Type); }));
-		if (!method->Flags.empty())
-			output.WriteLine(".Flags = {},", method->Flags.bits);
-		output.WriteLine(".ParentClass = &_data");
+		if (method.Return.Name != "void")
+			output.WriteLine(".ReturnTypeIndex = typeid({}),", method.Return.Name);
+		if (!method.GetParameters().empty())
+		{
+			if (constinit_database)
+				output.WriteLine(".ParameterTypeIndices = Method{}ParameterTypeIndices,", method_index);
+			else
+				output.WriteLine(".ParameterTypeIndices = {{ {} }},", join(method.ParametersSplit, ", ", [](MethodParameter const& param) { return format("typeid({})", param.Type); }));
+		}
+		if (!method.Flags.empty())
+			output.WriteLine(".Flags = {},", method.Flags.bits);
+		output.WriteLine(".ParentClass = {}", parent_class_ref);
 		output.EndBlock("}},");
-	}
-	output.EndBlock("}},");
+	};
 
-	/// Properties
-	output.StartBlock(".Properties = {{");
-	for (auto& [name, property] : klass.Properties)
-	{
+	const auto write_property = [&](std::string const& name, Property const& property) {
 		output.StartBlock("::Reflector::Property {{");
 		output.WriteLine(".Name = \"{}\",", name);
 		if (!property.DisplayName.empty())
@@ -1089,8 +1812,6 @@ void OutputContext::BuildStaticReflectionData(const Class& klass)
 		if (!property.Attributes.empty())
 		{
 			output.WriteLine(".Attributes = {},", EscapeJSON(property.Attributes));
-			if (options.JSON.Use)
-				output.WriteLine(".AttributesJSON = {}({}),", options.JSON.ParseFunction, EscapeJSON(property.Attributes));
 		}
 
 		if (property.Getter)
@@ -1112,10 +1833,117 @@ void OutputContext::BuildStaticReflectionData(const Class& klass)
 		output.WriteLine(".PropertyTypeIndex = typeid({}),", klass.Name, property.Type);
 		if (!property.Flags.empty())
 			output.WriteLine(".Flags = {},", property.Flags.bits);
-		output.WriteLine(".ParentClass = &_data");
+		output.WriteLine(".ParentClass = {}", parent_class_ref);
+		output.EndBlock("}},");
+	};
+
+	if (constinit_database)
+	{
+		output.StartBlock("namespace {} {{", data_namespace);
+		if (!klass.Namespace.empty())
+			output.WriteLine("using namespace {};", klass.Namespace);
+		output.WriteLine("extern const ::Reflector::Class Data;");
+
+		if (!klass.Fields.empty())
+		{
+			output.StartBlock("constinit const ::Reflector::Field Fields[] = {{");
+			for (auto& field : klass.Fields)
+				write_field(*field);
+			output.EndBlock("}};");
+		}
+
+		for (size_t i = 0; i < klass.Methods.size(); i++)
+		{
+			auto const& method = klass.Methods[i];
+			if (method->GetParameters().empty())
+				continue;
+			output.WriteLine("constinit const ::Reflector::Method::Parameter Method{}Parameters[] = {{ {} }};", i, join(method->ParametersSplit, ", ", [](MethodParameter const& param) {
+				return format("{{ {}, {}, {} }}", EscapeString(param.Name), EscapeString(param.Type), EscapeString(param.Initializer));
+			}));
+			output.WriteLine("constinit const ::Reflector::TypeIndexType Method{}ParameterTypeIndices[] = {{ {} }};", i, join(method->ParametersSplit, ", ", [](MethodParameter const& param) { return format("typeid({})", param.Type); }));
+		}
+		if (!klass.Methods.empty())
+		{
+			output.StartBlock("constinit const ::Reflector::Method Methods[] = {{");
+			for (size_t i = 0; i < klass.Methods.size(); i++)
+				write_method(*klass.Methods[i], i);
+			output.EndBlock("}};");
+		}
+
+		if (!klass.Properties.empty())
+		{
+			output.StartBlock("constinit const ::Reflector::Property Properties[] = {{");
+			for (auto& [name, property] : klass.Properties)
+				write_property(name, property);
+			output.EndBlock("}};");
+		}
+
+		output.StartBlock("constinit const ::Reflector::Class Data = {{");
+	}
+	else
+	{
+		output.StartBlock("::Reflector::Class const& StaticGetReflectionData_For_{}() {{", klass.GeneratedUniqueName());
+		if (!klass.Namespace.empty())
+			output.WriteLine("using namespace {};", klass.Namespace);
+		output.StartBlock("static const ::Reflector::Class _data = {{");
+	}
+
+	output.WriteLine(".Name = \"{}\",", klass.Name);
+	if (!klass.DisplayName.empty())
+		output.WriteLine(R"(.DisplayName = "{}",)", klass.DisplayName);
+	output.WriteLine(R"(.FullType = "{}",)", klass.FullType());
+
+	/// TODO: Comment and describe here why we should only give the type as the parent class name, since we support full namespaced names?
+	///output.WriteLine(".BaseClassName = \"{}\",", OnlyType(klass.BaseClass));
+	output.WriteLine(R"(.BaseClassName = "{}",)", klass.BaseClass);
+
+	if (!klass.Attributes.empty())
+	{
+		output.WriteLine(".Attributes = {},", EscapeJSON(klass.Attributes));
+	}
+	output.WriteLine(".ReflectionUID = {}ULL,", klass.ReflectionUID);
+	if (!klass.GUID.empty())
+		output.WriteLine(".GUID = {},", EscapeString(klass.GUID));
+	output.WriteLine(".Alignment = alignof({0}),", klass.FullType());
+	output.WriteLine(".Size = sizeof({0}),", klass.FullType());
+	if (!klass.Flags.is_set(ClassFlags::NoConstructors))
+	{
+		output.WriteLine(".DefaultPlacementConstructor = +[](void* ptr){{ new (ptr) {0}({0}::StaticGetReflectionData()); }},", klass.FullType());
+		output.WriteLine(".DefaultConstructor = +[]() -> void* {{ return new {0}({0}::StaticGetReflectionData()); }},", klass.FullType());
+	}
+	output.WriteLine(".Destructor = +[](void* obj){{ auto _tobj = ({}*)obj; _tobj->~{}(); }},", klass.FullType(), klass.Name);
+	if (options.AddGCFunctionality && Attribute::Relocatable(klass))
+		output.WriteLine(".Relocate = ::Reflector::RelocateFunction<{}>(),", klass.FullType());
+
+	if (constinit_database)
+	{
+		if (!klass.Fields.empty())
+			output.WriteLine(".Fields = Fields,");
+		if (!klass.Methods.empty())
+			output.WriteLine(".Methods = Methods,");
+		if (!klass.Properties.empty())
+			output.WriteLine(".Properties = Properties,");
+	}
+	else
+	{
+		/// Fields
+		output.StartBlock(".Fields = {{");
+		for (auto& field : klass.Fields)
+			write_field(*field);
+		output.EndBlock("}},");
+
+		/// Methods
+		output.StartBlock(".Methods = {{");
+		for (size_t i = 0; i < klass.Methods.size(); i++)
+			write_method(*klass.Methods[i], i);
+		output.EndBlock("}},");
+
+		/// Properties
+		output.StartBlock(".Properties = {{");
+		for (auto& [name, property] : klass.Properties)
+			write_property(name, property);
 		output.EndBlock("}},");
 	}
-	output.EndBlock("}},");
 
 	if (options.JSON.Use && Attribute::Serialize.GetOr(klass, true) != false)
 	{
@@ -1126,10 +1954,300 @@ void OutputContext::BuildStaticReflectionData(const Class& klass)
 		output.WriteLine("(({0} const*)src_object)->JSONSaveFields(dest_object);", klass.FullType());
 		output.EndBlock("}},");
 	}
+	if (options.Binary.Use && Attribute::Serialize.GetOr(klass, true) != false)
+	{
+		output.StartBlock(".BinaryLoadFieldsFunc = [](void* dest_object, ::Reflector::BinaryObject const& src_object){{");
+		output.WriteLine("(({0}*)dest_object)->BinaryLoadFields(src_object);", klass.FullType());
+		output.EndBlock("}},");
+		output.StartBlock(".BinarySaveFieldsFunc = [](void const* src_object, ::Reflector::BinaryWriter& dest_object){{");
+		output.WriteLine("(({0} const*)src_object)->BinarySaveFields(dest_object);", klass.FullType());
+		output.EndBlock("}},");
+	}
 
 	output.WriteLine(".TypeIndex = typeid({}),", klass.FullType());
 	output.WriteLine(".Flags = {}", klass.Flags.bits);
-	output.EndBlock("}}; return _data;");
+	if (constinit_database)
+	{
+		output.EndBlock("}};");
+		output.EndBlock("}}");
+		output.WriteLine("::Reflector::Class const& StaticGetReflectionData_For_{}() {{ return {}::Data; }}", klass.GeneratedUniqueName(), data_namespace);
+	}
+	else
+	{
+		output.EndBlock("}}; return _data;");
+		output.EndBlock("}}");
+	}
+
+}
+
+/// `JSONSAXField` is used by the streaming JSON loader in ReflectorJSON.h; it pushes the loader sink of the field with the given key.
+/// The fields that were missing from the object are handled by `JSONLoadFinish`, same as with `JSONLoadFields`.
+void OutputContext::BuildJSONStreamingLoadMethods(const Class& klass)
+{
+	std::vector<StringSwitchCase> cases;
+	size_t field_index = 0;
+	for (auto& field : klass.Fields)
+	{
+		if (field->Flags.contain(FieldFlags::NoLoad))
+			continue;
+
+		const auto load = options.JSON.IgnoreInvalidObjectFields
+			? format("loader.Load(this->{}, [this] {{ {} }});", field->Name, FieldResetLine(*field))
+			: format("loader.Load(this->{});", field->Name);
+		cases.push_back({ field->LoadName, format("{{ loaded.Set(field_index_base + {}); {} return true; }}", field_index++, load) });
+	}
+
+	output.StartBlock("bool {}::JSONSAXField(uint32_t key_hash, std::string_view key, ::Reflector::JSONSAXLoader& loader, ::Reflector::JSONLoadedFields& loaded) {{", klass.FullType());
+	if (!cases.empty())
+	{
+		output.WriteLine("constexpr size_t field_index_base = {};", klass.BaseClass.empty() ? std::string{ "0" } : format("{}::parent_type::JSONLoadableFieldCount", klass.FullType()));
+		WriteFieldNameHashSwitch(output, "key_hash", "key", cases);
+	}
+	if (!klass.BaseClass.empty())
+		output.WriteLine("return {}::parent_type::JSONSAXField(key_hash, key, loader, loaded);", klass.FullType());
+	else
+		output.WriteLine("return false;");
 	output.EndBlock("}}");
+}
 
+/// `JSONWriteFields` writes the same fields as `JSONSaveFields`, straight into a `Reflector::JSONWriter`.
+/// The type and GUID fields are written by the writer itself, before the fields of the object, based on its runtime class.
+void OutputContext::BuildJSONStreamingSaveMethods(const Class& klass)
+{
+	output.StartBlock("void {}::JSONWriteFields(::Reflector::JSONWriter& writer) const {{", klass.FullType());
+	if (!klass.BaseClass.empty())
+		output.WriteLine("{}::parent_type::JSONWriteFields(writer);", klass.FullType());
+
+	for (auto& field : klass.Fields)
+	{
+		if (field->Flags.contain(FieldFlags::NoSave))
+			continue;
+
+		const auto check_for_init_value = !field->InitializingExpression.empty()
+			&& !options.JSON.AlwaysSaveAllFields
+			&& !field->Flags.contain(FieldFlags::Required);
+
+		if (check_for_init_value)
+		{
+			output.StartBlock("do {{");
+			output.StartBlock("if constexpr (std::equality_comparable<{}>)", field->Type);
+			output.WriteLine("if (::Compare_(this->{}, {})) break;", field->Name, field->InitializingExpression);
+			output.EndBlock();
+		}
+
+		output.WriteLine("writer.Field({}, this->{});", BuildCompileTimeLiteral(field->SaveName), field->Name);
+
+		if (check_for_init_value)
+			output.EndBlock("}} while (false);");
+	}
+	output.EndBlock("}}");
+}
+
+/// Mirrors the generated JSON serialization methods, with fields identified by the `FieldNameHash` of their save/load names
+void OutputContext::BuildBinarySerializationMethods(const Class& klass)
+{
+	/// Field ids need to be unique within a class (base class fields are checked by their own class)
+	std::map<uint32_t, Field const*> save_ids, load_ids;
+	for (auto& field : klass.Fields)
+	{
+		if (!field->Flags.contain(FieldFlags::NoSave))
+		{
+			if (auto [it, inserted] = save_ids.emplace(FieldNameHash(field->SaveName), field.get()); !inserted)
+				ReportError(*field, "Binary field id of '{}' is the same as that of field '{}'; change the save name of one of them", field->SaveName, it->second->Name);
+		}
+		if (!field->Flags.contain(FieldFlags::NoLoad))
+		{
+			if (auto [it, inserted] = load_ids.emplace(FieldNameHash(field->LoadName), field.get()); !inserted)
+				ReportError(*field, "Binary field id of '{}' is the same as that of field '{}'; change the load name of one of them", field->LoadName, it->second->Name);
+		}
+	}
+
+	output.StartBlock("void {}::BinaryLoadFields(::Reflector::BinaryObject const& src_object) {{", klass.FullType());
+	if (!klass.BaseClass.empty())
+		output.WriteLine("{}::parent_type::BinaryLoadFields(src_object);", klass.FullType());
+
+	output.WriteLine();
+	for (auto& field : klass.Fields)
+	{
+		if (field->Flags.contain(FieldFlags::NoLoad))
+			continue;
+
+		const auto reset_line = FieldResetLine(*field);
+
+		output.StartBlock("if (auto entry = src_object.Find(0x{:08x}u); !entry){}", FieldNameHash(field->LoadName), DebuggingComment(options, field->LoadName));
+
+		if (field->Flags.contain(FieldFlags::Required))
+			output.WriteLine("throw ::Reflector::DataError{{ \"Missing field '{}'\" }};", field->LoadName);
+		else
+			output.WriteLine("{}", reset_line);
+
+		output.EndBlock();
+		output.StartBlock("else try {{");
+		output.WriteLine("using field_type = std::remove_cvref_t<decltype({})>;", field->FullName("::"));
+		output.WriteLine("static_assert(::Reflector::binary_serializable<field_type>, \"cannot serialize type '{0}' of field {1}\");", field->Type, field->FullName("::"));
+		output.WriteLine("::Reflector::BinaryReadField(*entry, this->{});", field->Name);
+		output.EndBlock("}}");
+		if (options.Binary.IgnoreInvalidObjectFields)
+		{
+			output.StartBlock("catch (...) {{");
+			output.WriteLine("{}", reset_line);
+			output.EndBlock("}}");
+		}
+		else
+		{
+			output.StartBlock("catch (::Reflector::DataError& e) {{");
+			output.WriteLine("e.File += \"/{}\";", field->LoadName);
+			output.WriteLine("throw;");
+			output.EndBlock("}}");
+		}
+
+		output.WriteLine();
+	}
+	output.EndBlock("}}");
+
+	output.StartBlock("void {}::BinarySaveFields(::Reflector::BinaryWriter& dest_object) const {{", klass.FullType());
+	if (!klass.BaseClass.empty())
+		output.WriteLine("{}::parent_type::BinarySaveFields(dest_object);", klass.FullType());
+
+	for (auto& field : klass.Fields)
+	{
+		if (field->Flags.contain(FieldFlags::NoSave))
+			continue;
+
+		const auto check_for_init_value = !field->InitializingExpression.empty()
+			&& !options.Binary.AlwaysSaveAllFields
+			&& !field->Flags.contain(FieldFlags::Required);
+
+		if (check_for_init_value)
+		{
+			output.StartBlock("do {{");
+			output.StartBlock("if constexpr (std::equality_comparable<{}>)", field->Type);
+			output.WriteLine("if (::Compare_(this->{}, {})) break;", field->Name, field->InitializingExpression);
+			output.EndBlock();
+		}
+
+		output.WriteLine("::Reflector::BinaryWriteField(dest_object, 0x{:08x}u, this->{});{}", FieldNameHash(field->SaveName), field->Name, DebuggingComment(options, field->SaveName));
+
+		if (check_for_init_value)
+			output.EndBlock("}} while (false);");
+	}
+	output.EndBlock("}}");
+}
+
+/// The delta methods only save the fields whose bits are set in `mChangedFields_` (by setters) and then clear the bits, so that
+/// only the changes since the last save are sent. Loading a delta does not mark the fields as changed, nor resets the fields missing from it.
+void OutputContext::BuildChangeTrackingMethods(const Class& klass)
+{
+	const auto parent_class = Class::FindClassByPossiblyQualifiedName(klass.BaseClass, &klass);
+	const auto parent_tracks_changes = parent_class && parent_class->TracksChanges();
+
+	const auto for_each_changed_field = [&](auto&& write_field) {
+		for (size_t i = 0; i < klass.Fields.size(); ++i)
+		{
+			auto& field = *klass.Fields[i];
+			if (field.Flags.contain(FieldFlags::NoSave))
+				continue;
+			output.StartBlock("if (this->mChangedFields_.test({})){}", i, DebuggingComment(options, field.SaveName));
+			write_field(field);
+			output.EndBlock();
+		}
+	};
+
+	if (options.JSON.Use && options.JSON.GenerateSerializationMethods && Attribute::Serialize.GetOr(klass, true) != false)
+	{
+		output.StartBlock("void {}::SaveDelta({}& dest_object) {{", klass.FullType(), options.JSON.Type);
+		if (parent_tracks_changes)
+			output.WriteLine("{}::parent_type::SaveDelta(dest_object);", klass.FullType());
+		for_each_changed_field([&](Field const& field) {
+			output.WriteLine("dest_object[\"{}\"] = this->{};", field.SaveName, field.Name);
+		});
+		output.WriteLine("this->mChangedFields_.reset();");
+		output.EndBlock("}}");
+
+		/// `JSONLoadField` already handles the fields of the parent classes
+		output.StartBlock("void {}::LoadDelta({} const& src_object) {{", klass.FullType(), options.JSON.Type);
+		output.WriteLine("::Reflector::JSONLoadedFields loaded;");
+		output.StartBlock("if (src_object.is_object()) {{");
+		output.StartBlock("for (auto const& [key, value] : src_object.template get_ref<{}::object_t const&>())", options.JSON.Type);
+		output.WriteLine("this->JSONLoadField(::Reflector::FieldNameHash(key), key, value, loaded);");
+		output.EndBlock();
+		output.EndBlock("}}");
+		output.EndBlock("}}");
+	}
+
+	if (options.Binary.Use && Attribute::Serialize.GetOr(klass, true) != false)
+	{
+		output.StartBlock("void {}::BinarySaveDelta(::Reflector::BinaryWriter& dest_object) {{", klass.FullType());
+		if (parent_tracks_changes)
+			output.WriteLine("{}::parent_type::BinarySaveDelta(dest_object);", klass.FullType());
+		for_each_changed_field([&](Field const& field) {
+			output.WriteLine("::Reflector::BinaryWriteField(dest_object, 0x{:08x}u, this->{});", FieldNameHash(field.SaveName), field.Name);
+		});
+		output.WriteLine("this->mChangedFields_.reset();");
+		output.EndBlock("}}");
+
+		output.StartBlock("void {}::BinaryLoadDelta(::Reflector::BinaryObject const& src_object) {{", klass.FullType());
+		if (parent_tracks_changes)
+			output.WriteLine("{}::parent_type::BinaryLoadDelta(src_object);", klass.FullType());
+		for (auto& field : klass.Fields)
+		{
+			if (field->Flags.contain(FieldFlags::NoLoad))
+				continue;
+
+			output.StartBlock("if (auto entry = src_object.Find(0x{:08x}u)){}", FieldNameHash(field->LoadName), DebuggingComment(options, field->LoadName));
+			output.StartBlock("try {{");
+			output.WriteLine("::Reflector::BinaryReadField(*entry, this->{});", field->Name);
+			output.EndBlock("}}");
+			if (options.Binary.IgnoreInvalidObjectFields)
+			{
+				output.StartBlock("catch (...) {{");
+				output.WriteLine("{}", FieldResetLine(*field));
+				output.EndBlock("}}");
+			}
+			else
+			{
+				output.StartBlock("catch (::Reflector::DataError& e) {{");
+				output.WriteLine("e.File += \"/{}\";", field->LoadName);
+				output.WriteLine("throw;");
+				output.EndBlock("}}");
+			}
+			output.EndBlock();
+		}
+		output.EndBlock("}}");
+	}
+}
+
+/// The fields are written and verified in slot order, which is also the order their out-of-line data is laid out in
+void OutputContext::BuildFlatViewMethods(const Class& klass)
+{
+	const auto parent_class = Class::FindClassByPossiblyQualifiedName(klass.BaseClass, &klass);
+	const auto parent_has_flat_view = parent_class && HasFlatView(options, *parent_class);
+	const auto flat_fields = FlatFields(klass);
+
+	output.StartBlock("void {}::FlatWriteFields(::Reflector::FlatWriter& writer, size_t table) const {{", klass.FullType());
+	if (parent_has_flat_view)
+		output.WriteLine("{}::parent_type::FlatWriteFields(writer, table);", klass.FullType());
+	for (size_t i = 0; i < flat_fields.size(); ++i)
+	{
+		auto& field = *flat_fields[i];
+		output.WriteLine("static_assert(::Reflector::flat_storable<{0}>, \"cannot store type '{0}' of field {1} in the flat format\");", field.Type, field.FullName("::"));
+		output.WriteLine("::Reflector::FlatTraits<{}>::Write(writer, table + ::Reflector::FlatFieldOffset<{}, {}>, this->{});", field.Type, klass.FullType(), i, field.Name);
+	}
+	output.EndBlock("}}");
+
+	output.StartBlock("bool {}::FlatVerifyFields(::Reflector::FlatVerifier& verifier, size_t table) {{", klass.FullType());
+	if (parent_has_flat_view)
+	{
+		output.StartBlock("if (!{}::parent_type::FlatVerifyFields(verifier, table))", klass.FullType());
+		output.WriteLine("return false;");
+		output.EndBlock();
+	}
+	for (size_t i = 0; i < flat_fields.size(); ++i)
+	{
+		output.StartBlock("if (!::Reflector::FlatTraits<{}>::Verify(verifier, table + ::Reflector::FlatFieldOffset<{}, {}>)){}", flat_fields[i]->Type, klass.FullType(), i, DebuggingComment(options, flat_fields[i]->Name));
+		output.WriteLine("return false;");
+		output.EndBlock();
+	}
+	output.WriteLine("return true;");
+	output.EndBlock("}}");
 }
@@ -21,3 +21,7 @@ bool CreateIncludeListArtifact(ArtifactArgs args);
 bool CreateJSONDBArtifact(ArtifactArgs args);
 bool CreateReflectorHeaderArtifact(ArtifactArgs args);
 bool CreateReflectorDatabaseArtifact(ArtifactArgs args);
+
+bool GeneratesJSONSchema(Options const& options, Class const& klass);
+std::string JSONSchemaFileName(Class const& klass);
+bool CreateJSONSchemaArtifact(ArtifactArgs args, Class const& klass);
@@ -132,11 +132,30 @@ int main(int argc, const char* argv[])
 			factory.QueueLinkOrCopyArtifact(options.ArtifactPath / "ReflectorUtils.h", options.GetExePath().parent_path() / "Include" / "ReflectorUtils.h");
 			if (options.AddGCFunctionality)
 				factory.QueueLinkOrCopyArtifact(options.ArtifactPath / "ReflectorGC.h", options.GetExePath().parent_path() / "Include" / "ReflectorGC.h");
+			if (options.JSON.Use && (options.JSON.GenerateStreamingLoadMethods || options.JSON.GenerateStreamingSaveMethods))
+				factory.QueueLinkOrCopyArtifact(options.ArtifactPath / "ReflectorJSON.h", options.GetExePath().parent_path() / "Include" / "ReflectorJSON.h");
+			if (options.Binary.Use)
+				factory.QueueLinkOrCopyArtifact(options.ArtifactPath / "ReflectorBinary.h", options.GetExePath().parent_path() / "Include" / "ReflectorBinary.h");
+			if (options.GenerateFlatViews)
+				factory.QueueLinkOrCopyArtifact(options.ArtifactPath / "ReflectorFlat.h", options.GetExePath().parent_path() / "Include" / "ReflectorFlat.h");
 		}
 
 		if (options.CreateDatabase)
 			factory.QueueArtifact(options.ArtifactPath / "ReflectDatabase.json", CreateJSONDBArtifact);
 
+		if (options.JSON.Use && options.JSON.AllowSchemaGenerationPerClass)
+		{
+			create_directories(options.ArtifactPath / "Schemas");
+			for (const auto& file : GetMirrors())
+			{
+				for (auto& klass : file->Classes)
+				{
+					if (GeneratesJSONSchema(options, *klass))
+						factory.QueueArtifact(options.ArtifactPath / "Schemas" / JSONSchemaFileName(*klass), CreateJSONSchemaArtifact, std::ref(*klass));
+				}
+			}
+		}
+
 		if (options.Documentation.Generate)
 		{
 			files_changed += GenerateDocumentation(factory, options);
@@ -0,0 +1,296 @@
+/// Tests of the binary serializers (see ReflectorBinary.h)
+
+#include "SerializationTestCommon.h"
+
+using namespace Reflector;
+
+struct Part
+{
+	REFLECTOR_TEST_STRUCT_BODY(Part);
+
+	int32_t Count = 1;
+	std::string Label;
+	std::vector<int32_t> Values;
+	std::optional<std::string> Note;
+	std::map<std::string, double> Weights;
+
+	bool operator==(Part const&) const = default;
+
+	void BinaryLoadFields(BinaryObject const& src_object)
+	{
+		if (auto entry = src_object.Find(FieldNameHash("Count")); !entry)
+			this->Count = 1;
+		else try { BinaryReadField(*entry, this->Count); } catch (DataError& e) { e.File += "/Count"; throw; }
+		if (auto entry = src_object.Find(FieldNameHash("Label")); !entry)
+			this->Label = decltype(this->Label){};
+		else try { BinaryReadField(*entry, this->Label); } catch (DataError& e) { e.File += "/Label"; throw; }
+		if (auto entry = src_object.Find(FieldNameHash("Values")); !entry)
+			this->Values = decltype(this->Values){};
+		else try { BinaryReadField(*entry, this->Values); } catch (DataError& e) { e.File += "/Values"; throw; }
+		if (auto entry = src_object.Find(FieldNameHash("Note")); !entry)
+			this->Note = decltype(this->Note){};
+		else try { BinaryReadField(*entry, this->Note); } catch (DataError& e) { e.File += "/Note"; throw; }
+		if (auto entry = src_object.Find(FieldNameHash("Weights")); !entry)
+			this->Weights = decltype(this->Weights){};
+		else try { BinaryReadField(*entry, this->Weights); } catch (DataError& e) { e.File += "/Weights"; throw; }
+	}
+
+	void BinarySaveFields(BinaryWriter& dest_object) const
+	{
+		do { if (::Compare_(this->Count, 1)) break; BinaryWriteField(dest_object, FieldNameHash("Count"), this->Count); } while (false);
+		BinaryWriteField(dest_object, FieldNameHash("Label"), this->Label);
+		BinaryWriteField(dest_object, FieldNameHash("Values"), this->Values);
+		BinaryWriteField(dest_object, FieldNameHash("Note"), this->Note);
+		BinaryWriteField(dest_object, FieldNameHash("Weights"), this->Weights);
+	}
+};
+
+struct Node : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(Node);
+	using parent_type = Reflectable;
+	Node() : Reflectable(StaticGetReflectionData()) {}
+	explicit Node(Class const& klass) : Reflectable(klass) {}
+
+	std::string Name;
+	std::vector<std::unique_ptr<Node>> Children;
+
+	virtual bool Equals(Node const& other) const
+	{
+		return &GetReflectionData() == &other.GetReflectionData() && Name == other.Name
+			&& std::ranges::equal(Children, other.Children, [](auto const& a, auto const& b) { return a ? b && a->Equals(*b) : !b; });
+	}
+
+	void BinaryLoadFields(BinaryObject const& src_object) override
+	{
+		parent_type::BinaryLoadFields(src_object);
+		if (auto entry = src_object.Find(FieldNameHash("Name")); !entry)
+			this->Name = decltype(this->Name){};
+		else try { BinaryReadField(*entry, this->Name); } catch (DataError& e) { e.File += "/Name"; throw; }
+		if (auto entry = src_object.Find(FieldNameHash("Children")); !entry)
+			this->Children = decltype(this->Children){};
+		else try { BinaryReadField(*entry, this->Children); } catch (DataError& e) { e.File += "/Children"; throw; }
+	}
+
+	void BinarySaveFields(BinaryWriter& dest_object) const override
+	{
+		parent_type::BinarySaveFields(dest_object);
+		BinaryWriteField(dest_object, FieldNameHash("Name"), this->Name);
+		BinaryWriteField(dest_object, FieldNameHash("Children"), this->Children);
+	}
+};
+
+struct Leaf : Node
+{
+	REFLECTOR_TEST_CLASS_BODY(Leaf);
+	using parent_type = Node;
+	Leaf() : Node(StaticGetReflectionData()) {}
+
+	double Weight = 0;
+
+	bool Equals(Node const& other) const override { return Node::Equals(other) && Weight == static_cast<Leaf const&>(other).Weight; }
+
+	void BinaryLoadFields(BinaryObject const& src_object) override
+	{
+		parent_type::BinaryLoadFields(src_object);
+		if (auto entry = src_object.Find(FieldNameHash("Weight")); !entry)
+			this->Weight = 0;
+		else try { BinaryReadField(*entry, this->Weight); } catch (DataError& e) { e.File += "/Weight"; throw; }
+	}
+
+	void BinarySaveFields(BinaryWriter& dest_object) const override
+	{
+		parent_type::BinarySaveFields(dest_object);
+		do { if (::Compare_(this->Weight, 0)) break; BinaryWriteField(dest_object, FieldNameHash("Weight"), this->Weight); } while (false);
+	}
+};
+
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Part, "")
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Node, "")
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Leaf, "Node")
+
+namespace Reflector
+{
+	Class const* Classes[] = { &Node::StaticGetReflectionData(), &Leaf::StaticGetReflectionData(), nullptr };
+	Enum const* Enums[] = { nullptr };
+}
+
+static Part MakePart()
+{
+	Part part;
+	part.Count = -7;
+	part.Label = std::string(300, 'x');
+	part.Values = { 1, -2, 1 << 30 };
+	part.Note = "note";
+	part.Weights = { { "a", 0.5 }, { "b", -1e300 } };
+	return part;
+}
+
+static std::unique_ptr<Node> MakeTree()
+{
+	auto root = std::make_unique<Node>();
+	root->Name = "root";
+	for (int i = 0; i < 3; ++i)
+	{
+		auto leaf = std::make_unique<Leaf>();
+		leaf->Name = "leaf " + std::to_string(i);
+		leaf->Weight = i * 0.25;
+		root->Children.push_back(std::move(leaf));
+	}
+	root->Children.push_back(nullptr);
+	root->Children.push_back(std::make_unique<Node>());
+	root->Children.back()->Children.push_back(std::make_unique<Leaf>());
+	return root;
+}
+
+/// Binary data of a single length-delimited value (e.g. an object or a container), with the given contents
+template <typename FUNC>
+static std::vector<uint8_t> LengthDelimitedData(FUNC&& write_contents)
+{
+	BinaryWriter writer;
+	writer.WriteBytes(BinaryFormatMagic);
+	writer.WriteVarint(BinaryFormatVersion);
+	const auto start = writer.BeginLengthDelimited();
+	write_contents(writer);
+	writer.EndLengthDelimited(start);
+	return std::move(writer.Buffer);
+}
+
+template <typename T>
+static bool LoadThrowsDataError(std::span<uint8_t const> data, T& value)
+{
+	try { BinaryLoad(data, value); }
+	catch (DataError const&) { return true; }
+	return false;
+}
+
+static void TestRoundTrip()
+{
+	const auto part = MakePart();
+	Part loaded_part;
+	BinaryLoad(BinarySave(part), loaded_part);
+	REFLECTOR_TEST_CHECK(loaded_part == part);
+
+	/// Fields equal to their initializers aren't saved, and are reset when loading
+	loaded_part.Count = 5;
+	BinaryLoad(BinarySave(Part{}), loaded_part);
+	REFLECTOR_TEST_CHECK(loaded_part == Part{});
+
+	const auto tree = MakeTree();
+	std::unique_ptr<Node> loaded_tree;
+	BinaryLoad(BinarySave(tree), loaded_tree);
+	REFLECTOR_TEST_CHECK(loaded_tree && loaded_tree->Equals(*tree));
+	REFLECTOR_TEST_CHECK(loaded_tree && loaded_tree->Children[0]->Is<Leaf>() && !loaded_tree->Children[3]);
+}
+
+/// Unknown fields are skipped, and missing ones reset
+static void TestUnknownAndMissingFields()
+{
+	const auto data = LengthDelimitedData([](BinaryWriter& writer) {
+		BinaryWriteField(writer, FieldNameHash("Removed"), std::string{ "removed" });
+		BinaryWriteField(writer, FieldNameHash("Count"), int32_t(3));
+		BinaryWriteField(writer, FieldNameHash("Other"), 1.5);
+	});
+	auto part = MakePart();
+	BinaryLoad(data, part);
+	REFLECTOR_TEST_CHECK(part.Count == 3 && part.Label.empty() && part.Values.empty() && !part.Note && part.Weights.empty());
+}
+
+static void TestTruncatedData()
+{
+	const auto data = BinarySave(MakeTree());
+	for (size_t size = 0; size < data.size(); ++size)
+	{
+		std::unique_ptr<Node> tree;
+		REFLECTOR_TEST_CHECK(LoadThrowsDataError(std::span{ data }.first(size), tree));
+	}
+
+	const auto part_data = BinarySave(MakePart());
+	for (size_t size = 0; size < part_data.size(); ++size)
+	{
+		Part part;
+		REFLECTOR_TEST_CHECK(LoadThrowsDataError(std::span{ part_data }.first(size), part));
+	}
+}
+
+/// Counts and lengths larger than the data are rejected instead of being allocated for
+static void TestHugeCounts()
+{
+	constexpr uint64_t huge = uint64_t(1) << 60;
+
+	std::vector<int32_t> values;
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(LengthDelimitedData([](BinaryWriter& writer) { writer.WriteVarint(huge); writer.WriteVarint(1); }), values));
+
+	std::map<std::string, double> weights;
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(LengthDelimitedData([](BinaryWriter& writer) { writer.WriteVarint(huge); }), weights));
+
+	std::vector<std::string> strings;
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(LengthDelimitedData([](BinaryWriter& writer) { writer.WriteVarint(1); writer.WriteVarint(huge); }), strings));
+
+	Part part;
+	const auto huge_field = LengthDelimitedData([](BinaryWriter& writer) {
+		writer.WriteTag(FieldNameHash("Values"), BinaryWireType::LengthDelimited);
+		const auto start = writer.BeginLengthDelimited();
+		writer.WriteVarint(huge);
+		writer.EndLengthDelimited(start);
+	});
+	try
+	{
+		BinaryLoad(huge_field, part);
+		REFLECTOR_TEST_CHECK(false);
+	}
+	catch (DataError const& e)
+	{
+		REFLECTOR_TEST_CHECK(e.File == "/Values");
+	}
+}
+
+static void TestInvalidData()
+{
+	Part part;
+	auto data = BinarySave(MakePart());
+
+	auto wrong_magic = data;
+	wrong_magic[0] = 'X';
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(wrong_magic, part));
+
+	auto newer_version = data;
+	newer_version[sizeof(BinaryFormatMagic)] = uint8_t(BinaryFormatVersion + 1);
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(newer_version, part));
+
+	/// A varint that never ends
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(LengthDelimitedData([](BinaryWriter& writer) {
+		writer.WriteTag(FieldNameHash("Count"), BinaryWireType::Varint);
+		for (int i = 0; i < 11; ++i)
+			writer.Buffer.push_back(0xFF);
+	}), part));
+
+	/// A field saved with the wrong wire type
+	const auto wrong_type = LengthDelimitedData([](BinaryWriter& writer) { BinaryWriteField(writer, FieldNameHash("Label"), 5); });
+	try
+	{
+		BinaryLoad(wrong_type, part);
+		REFLECTOR_TEST_CHECK(false);
+	}
+	catch (DataError const& e)
+	{
+		REFLECTOR_TEST_CHECK(e.File == "/Label");
+	}
+
+	/// An object of an unknown class
+	std::unique_ptr<Node> tree;
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(LengthDelimitedData([](BinaryWriter& writer) { writer.WriteVarint(BinaryClassID("Unknown")); }), tree));
+	REFLECTOR_TEST_CHECK(!tree);
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestUnknownAndMissingFields();
+	TestTruncatedData();
+	TestHugeCounts();
+	TestInvalidData();
+	if (ReflectorTests::Failures == 0)
+		std::printf("BinaryTests: all checks passed\n");
+	return ReflectorTests::Failures;
+}
@@ -0,0 +1,251 @@
+/// Tests of the serialization of vectors of `Columnar` classes (see `Reflector::ColumnarJSONSave` and the columnar `BinarySerializer`)
+
+#include "SerializationTestCommon.h"
+
+using namespace Reflector;
+
+enum class Kind : int16_t { A = -2, B = 7 };
+
+struct SampleAttributes
+{
+	static constexpr uint64_t AttributeFlagBits = 0;
+	static constexpr std::array<std::string_view, 1> AttributeNames = { "Columnar" };
+	static constexpr bool Columnar = true;
+};
+
+/// `SaveName` and `LoadName`
+struct NameAttributes
+{
+	static constexpr uint64_t AttributeFlagBits = 0;
+	static constexpr std::array<std::string_view, 2> AttributeNames = { "SaveName", "LoadName" };
+	static constexpr std::string_view SaveName = "name";
+	static constexpr std::string_view LoadName = "name";
+};
+
+/// Only `LoadName`, for a column that was renamed
+struct WeightAttributes
+{
+	static constexpr uint64_t AttributeFlagBits = 0;
+	static constexpr std::array<std::string_view, 1> AttributeNames = { "LoadName" };
+	static constexpr std::string_view LoadName = "mass";
+};
+
+struct Sample
+{
+	REFLECTOR_TEST_STRUCT_BODY(Sample);
+	using self_attributes = SampleAttributes;
+
+	static constexpr uint64_t RequiredFlags = 1ULL << uint64_t(FieldFlags::Required);
+	static constexpr uint64_t TransientFlags = (1ULL << uint64_t(FieldFlags::NoSave)) | (1ULL << uint64_t(FieldFlags::NoLoad));
+	static constexpr uint64_t StaticFlags = 1ULL << uint64_t(FieldFlags::Static);
+
+	float X = 0;
+	Kind K = Kind::A;
+	uint64_t Big = 0;
+	std::string Name;
+	double Weight = 0;
+	int32_t Id = 0;
+	int Cache = 42;
+	static inline int Shared = 0;
+
+	bool operator==(Sample const&) const = default;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldVisitorData<CompileTimeFieldData<float, Sample, 0, "X", decltype(&Sample::X), &Sample::X>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<Kind, Sample, 0, "K", decltype(&Sample::K), &Sample::K>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<uint64_t, Sample, 0, "Big", decltype(&Sample::Big), &Sample::Big>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<std::string, Sample, 0, "Name", decltype(&Sample::Name), &Sample::Name, NameAttributes>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<double, Sample, 0, "Weight", decltype(&Sample::Weight), &Sample::Weight, WeightAttributes>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<int32_t, Sample, RequiredFlags, "Id", decltype(&Sample::Id), &Sample::Id>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<int, Sample, TransientFlags, "Cache", decltype(&Sample::Cache), &Sample::Cache>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<int, Sample, StaticFlags, "Shared", decltype(&Sample::Shared), &Sample::Shared>>{ nullptr });
+	}
+};
+
+static_assert(columnar_vector<std::vector<Sample>>);
+
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Sample, "")
+
+namespace Reflector
+{
+	Class const* Classes[] = { nullptr };
+	Enum const* Enums[] = { nullptr };
+}
+
+/// `Weight` is left at its default, as it's saved under a different name than it's loaded from
+static std::vector<Sample> MakeSamples(size_t count)
+{
+	std::vector<Sample> samples(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		samples[i].X = 1.5f * float(i);
+		samples[i].K = i % 2 ? Kind::B : Kind::A;
+		samples[i].Big = 0xFFFFFFFFFFull * i;
+		samples[i].Name = std::string(i % 5, 'n');
+		samples[i].Id = -int32_t(i);
+		samples[i].Cache = 1;
+	}
+	return samples;
+}
+
+/// Binary data of a columnar vector with the given element count, followed by the columns written by `write_columns`
+template <typename FUNC>
+static std::vector<uint8_t> ColumnarData(uint64_t count, FUNC&& write_columns)
+{
+	BinaryWriter writer;
+	writer.WriteBytes(BinaryFormatMagic);
+	writer.WriteVarint(BinaryFormatVersion);
+	const auto start = writer.BeginLengthDelimited();
+	writer.WriteVarint(count);
+	write_columns(writer);
+	writer.EndLengthDelimited(start);
+	return std::move(writer.Buffer);
+}
+
+/// A column of the given type, with raw contents
+static void WriteColumn(BinaryWriter& writer, std::string_view name, ColumnarType type, std::vector<uint8_t> const& contents)
+{
+	writer.WriteTag(FieldNameHash(name), BinaryWireType::LengthDelimited);
+	const auto start = writer.BeginLengthDelimited();
+	writer.WriteVarint(uint64_t(type));
+	writer.WriteBytes(contents);
+	writer.EndLengthDelimited(start);
+}
+
+/// Checks that loading fails, and leaves the loaded vector as it was
+static bool JSONLoadFails(char const* text)
+{
+	auto samples = MakeSamples(3);
+	const auto original = samples;
+	try { nlohmann::json::parse(text).get_to(samples); }
+	catch (DataError const&) { return samples == original; }
+	catch (nlohmann::json::exception const&) { return samples == original; }
+	return false;
+}
+
+static bool BinaryLoadFails(std::span<uint8_t const> data)
+{
+	auto samples = MakeSamples(3);
+	const auto original = samples;
+	try { BinaryLoad(data, samples); }
+	catch (DataError const&) { return samples == original; }
+	return false;
+}
+
+static void TestRoundTrip()
+{
+	Sample::Shared = 5;
+	for (size_t count : { size_t(0), size_t(1), size_t(100) })
+	{
+		const auto samples = MakeSamples(count);
+		auto expected = samples;
+		for (auto& sample : expected)
+			sample.Cache = 42;
+
+		const nlohmann::json json = samples;
+		REFLECTOR_TEST_CHECK(json.at("$count") == count);
+		REFLECTOR_TEST_CHECK(json.at("$columns") == nlohmann::json::parse(R"({"X":"f32","K":"i16","Big":"u64","name":"values","Weight":"f64","Id":"i32"})"));
+		REFLECTOR_TEST_CHECK(!json.contains("Name") && !json.contains("Cache") && !json.contains("Shared"));
+
+		std::vector<Sample> loaded;
+		json.get_to(loaded);
+		REFLECTOR_TEST_CHECK(loaded == expected);
+
+		/// Through the streaming writer and loader
+		const auto text = JSONStreamSave(samples);
+		REFLECTOR_TEST_CHECK(text == json.dump());
+		loaded.clear();
+		JSONStreamLoad(std::string_view{ text }, loaded);
+		REFLECTOR_TEST_CHECK(loaded == expected);
+
+		loaded.clear();
+		BinaryLoad(BinarySave(samples), loaded);
+		REFLECTOR_TEST_CHECK(loaded == expected);
+	}
+	REFLECTOR_TEST_CHECK(Sample::Shared == 5);
+}
+
+/// Columns are loaded from the `LoadName`s of the fields; packed columns can also be arrays, and unknown columns are ignored
+static void TestLoadNames()
+{
+	std::vector<Sample> samples;
+	nlohmann::json::parse(R"({"$count":2,"Id":[3,4],"X":[0.5,-1],"mass":"AAAAAAAA+D8AAAAAAAAEQA==","Weight":[9,9],"Unknown":1})").get_to(samples);
+	REFLECTOR_TEST_CHECK(samples.size() == 2 && samples[0].Id == 3 && samples[1].X == -1 && samples[0].Weight == 1.5 && samples[1].Weight == 2.5);
+
+	samples.clear();
+	BinaryLoad(ColumnarData(2, [](BinaryWriter& writer) {
+		WriteColumn(writer, "Id", ColumnarType::I32, { 3, 0, 0, 0, 4, 0, 0, 0 });
+		WriteColumn(writer, "mass", ColumnarType::F64, { 0, 0, 0, 0, 0, 0, 0xF8, 0x3F, 0, 0, 0, 0, 0, 0, 0x04, 0x40 });
+		WriteColumn(writer, "Weight", ColumnarType::F64, std::vector<uint8_t>(16, 0));
+		WriteColumn(writer, "Unknown", ColumnarType::U8, { 1, 2 });
+	}), samples);
+	REFLECTOR_TEST_CHECK(samples.size() == 2 && samples[1].Id == 4 && samples[0].Weight == 1.5 && samples[1].Weight == 2.5);
+}
+
+static void TestInvalidJSON()
+{
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"([])"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"Id":[]})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":-1,"Id":[]})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":"1","Id":[1]})"));
+
+	/// Counts that the columns don't back up
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1000000000000000000})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1000000000000000000,"Unknown":[]})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1000000000000000000,"Id":"AAAAAA=="})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":2,"Id":[1]})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":2,"Id":[1,2],"name":["a"]})"));
+
+	/// Required columns
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1,"X":[1]})"));
+
+	/// Packed columns of the wrong type, size or encoding
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1,"$columns":{"Id":"f32"},"Id":"AAAAAA=="})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1,"$columns":{"Id":5},"Id":"AAAAAA=="})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1,"Id":"AAAAAAAAAAA="})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":2,"Id":"AAAAAA=="})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1,"Id":"AA*AAA=="})"));
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1,"Id":{}})"));
+
+	/// Invalid values, in the last column
+	REFLECTOR_TEST_CHECK(JSONLoadFails(R"({"$count":1,"Id":[1],"X":[1],"name":[5]})"));
+}
+
+static void TestInvalidBinary()
+{
+	const auto data = BinarySave(MakeSamples(20));
+	for (size_t size = 0; size < data.size(); ++size)
+		REFLECTOR_TEST_CHECK(BinaryLoadFails(std::span{ data }.first(size)));
+
+	constexpr uint64_t huge = uint64_t(1) << 60;
+	const std::vector<uint8_t> id = { 1, 0, 0, 0 };
+
+	/// Counts that the columns don't back up
+	REFLECTOR_TEST_CHECK(BinaryLoadFails(ColumnarData(huge, [](BinaryWriter&) {})));
+	REFLECTOR_TEST_CHECK(BinaryLoadFails(ColumnarData(huge, [&](BinaryWriter& writer) { WriteColumn(writer, "Id", ColumnarType::I32, id); })));
+	REFLECTOR_TEST_CHECK(BinaryLoadFails(ColumnarData(5, [](BinaryWriter& writer) { WriteColumn(writer, "Unknown", ColumnarType::U8, { 1, 2, 3, 4, 5 }); })));
+	REFLECTOR_TEST_CHECK(BinaryLoadFails(ColumnarData(2, [&](BinaryWriter& writer) { WriteColumn(writer, "Id", ColumnarType::I32, id); })));
+	REFLECTOR_TEST_CHECK(BinaryLoadFails(ColumnarData(4, [&](BinaryWriter& writer) {
+		WriteColumn(writer, "Id", ColumnarType::I32, std::vector<uint8_t>(16, 0));
+		WriteColumn(writer, "name", ColumnarType::Values, { 0, 0, 0 });
+	})));
+
+	/// Required columns
+	REFLECTOR_TEST_CHECK(BinaryLoadFails(ColumnarData(1, [](BinaryWriter& writer) { WriteColumn(writer, "X", ColumnarType::F32, { 0, 0, 0, 0 }); })));
+
+	/// Columns of the wrong type
+	REFLECTOR_TEST_CHECK(BinaryLoadFails(ColumnarData(1, [&](BinaryWriter& writer) { WriteColumn(writer, "Id", ColumnarType::F32, id); })));
+	REFLECTOR_TEST_CHECK(BinaryLoadFails(ColumnarData(1, [](BinaryWriter& writer) { writer.WriteTag(FieldNameHash("Id"), BinaryWireType::Varint); writer.WriteVarint(1); })));
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestLoadNames();
+	TestInvalidJSON();
+	TestInvalidBinary();
+	if (ReflectorTests::Failures == 0)
+		std::printf("ColumnarTests: all checks passed\n");
+	return ReflectorTests::Failures;
+}
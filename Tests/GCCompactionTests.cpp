@@ -0,0 +1,193 @@
+/// Tests of heap compaction (see `Reflector::Heap::Compact`)
+
+#include "GCTestCommon.h"
+
+#include <set>
+
+using namespace Reflector;
+using ReflectorTests::FieldData;
+
+struct Item;
+
+/// A struct with its own `GCMark`; the objects it points to can't be moved, as the pointer can't be updated
+struct Handle
+{
+	Item* Target = nullptr;
+	void GCMark() const;
+};
+
+/// A class with the `Relocatable` attribute
+struct Item : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(Item);
+	using parent_type = Reflectable;
+	Item() : Reflectable(StaticGetReflectionData()) {}
+	Item(RelocationTag tag, Item&& other) noexcept
+		: Reflectable(tag, std::move(other)), Value(other.Value), Name(std::move(other.Name)), Next(other.Next), Children(std::move(other.Children)), Held(other.Held)
+	{
+	}
+
+	int Value = 0;
+	std::string Name;
+	Item* Next = nullptr;
+	std::vector<Item*> Children;
+	Handle Held;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldData<Item, int>{ &Item::Value });
+		visitor(FieldData<Item, std::string>{ &Item::Name });
+		visitor(FieldData<Item, Item*>{ &Item::Next });
+		visitor(FieldData<Item, std::vector<Item*>>{ &Item::Children });
+		visitor(FieldData<Item, Handle>{ &Item::Held });
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(false, REFLECTOR_TEST_GC_FIELD(Value), REFLECTOR_TEST_GC_FIELD(Name), REFLECTOR_TEST_GC_FIELD(Next), REFLECTOR_TEST_GC_FIELD(Children), REFLECTOR_TEST_GC_FIELD(Held))
+};
+REFLECTOR_TEST_GC_POINTER(Item)
+
+void Handle::GCMark() const { Reflector::GCMark(Target); }
+
+/// A class without the `Relocatable` attribute
+struct Fixed : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(Fixed);
+	using parent_type = Reflectable;
+	Fixed() : Reflectable(StaticGetReflectionData()) {}
+
+	Item* Ref = nullptr;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldData<Fixed, Item*>{ &Fixed::Ref });
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(false, REFLECTOR_TEST_GC_FIELD(Ref))
+};
+REFLECTOR_TEST_GC_POINTER(Fixed)
+
+/// Relocation doesn't make reflected classes movable
+static_assert(!std::is_move_constructible_v<Item> && !std::is_move_constructible_v<Fixed>);
+
+REFLECTOR_TEST_RELOCATABLE_CLASS_DATA(Item)
+REFLECTOR_TEST_CLASS_DATA(Fixed)
+
+namespace Reflector
+{
+	Class const* Classes[] = { &Item::StaticGetReflectionData(), &Fixed::StaticGetReflectionData(), nullptr };
+	Enum const* Enums[] = { nullptr };
+}
+
+/// Allocates `count` objects of each class and keeps every 10th alive, to leave the pages sparse
+template <typename T>
+static std::vector<T*> MakeSparseObjects(Heap& heap, int count)
+{
+	std::vector<T*> all;
+	for (int i = 0; i < count; ++i)
+		all.push_back(heap.New<T>());
+	std::vector<T*> kept;
+	for (int i = 0; i < count; i += 10)
+		kept.push_back(all[i]);
+	return kept;
+}
+
+static void TestCompactMovesObjects()
+{
+	Heap heap;
+	auto root = heap.NewRoot<Item>("root");
+	auto kept = MakeSparseObjects<Item>(heap, 20000);
+	std::map<int, std::string> expected;
+	for (size_t i = 0; i < kept.size(); ++i)
+	{
+		kept[i]->Value = int(i + 1);
+		kept[i]->Name = "item " + std::to_string(i + 1);
+		expected[kept[i]->Value] = kept[i]->Name;
+		if (i % 2)
+			root->Children.push_back(kept[i]);
+		else
+			kept[i + 1]->Next = kept[i];
+	}
+
+	heap.Collect();
+	const auto before = heap.GetStatistics();
+	const auto moved = heap.Compact();
+	const auto after = heap.GetStatistics();
+
+	REFLECTOR_TEST_CHECK(moved > 0);
+	REFLECTOR_TEST_CHECK(after.PageCount < before.PageCount);
+	REFLECTOR_TEST_CHECK(after.ObjectCount == before.ObjectCount);
+	REFLECTOR_TEST_CHECK(after.TotalObjectsMoved == moved);
+
+	/// The root and all the fields pointing to moved objects were updated
+	root = heap.GetRoot<Item>("root");
+	std::set<Item*> seen;
+	std::vector<Item*> stack{ root };
+	while (!stack.empty())
+	{
+		const auto item = stack.back();
+		stack.pop_back();
+		if (!item || !seen.insert(item).second)
+			continue;
+		REFLECTOR_TEST_CHECK(item->GC_IsOnHeap() && Heap::Of(item) == &heap);
+		if (item != root)
+		{
+			const auto it = expected.find(item->Value);
+			REFLECTOR_TEST_CHECK(it != expected.end() && it->second == item->Name);
+		}
+		stack.push_back(item->Next);
+		stack.insert(stack.end(), item->Children.begin(), item->Children.end());
+	}
+	REFLECTOR_TEST_CHECK(seen.size() == expected.size() + 1);
+
+	/// Nothing is left to compact, and the compacted heap still collects correctly
+	REFLECTOR_TEST_CHECK(heap.Compact() == 0);
+	heap.Collect();
+	REFLECTOR_TEST_CHECK(heap.ObjectCount() == after.ObjectCount);
+}
+
+static void TestUnmovableObjects()
+{
+	Heap heap;
+	auto root = heap.NewRoot<Item>("root");
+	auto items = MakeSparseObjects<Item>(heap, 5000);
+	auto fixed = MakeSparseObjects<Fixed>(heap, 5000);
+	root->Children = items;
+	for (auto obj : fixed)
+		obj->Ref = items[0];
+	heap.NewRoot<Fixed>("fixed")->Ref = items[1];
+
+	/// Pinned objects, objects pointed to by fields the pointer maps can't describe, and objects of classes that aren't
+	/// `Relocatable` all keep their addresses
+	const auto pinned = items[10];
+	heap.Pin(pinned);
+	const auto held = items[20];
+	root->Held.Target = held;
+	std::vector<Fixed*> fixed_kept;
+	for (auto obj : fixed)
+	{
+		heap.SetRoot("fixed " + std::to_string(fixed_kept.size()), obj);
+		fixed_kept.push_back(obj);
+	}
+
+	const auto moved = heap.Compact();
+	REFLECTOR_TEST_CHECK(moved > 0);
+	root = heap.GetRoot<Item>("root");
+	REFLECTOR_TEST_CHECK(heap.IsPinned(pinned) && std::ranges::count(root->Children, pinned) == 1);
+	REFLECTOR_TEST_CHECK(root->Held.Target == held && std::ranges::count(root->Children, held) == 1);
+	for (size_t i = 0; i < fixed_kept.size(); ++i)
+	{
+		REFLECTOR_TEST_CHECK(heap.GetRoot<Fixed>("fixed " + std::to_string(i)) == fixed_kept[i]);
+		REFLECTOR_TEST_CHECK(fixed_kept[i]->Ref == root->Children[0]);
+	}
+	REFLECTOR_TEST_CHECK(heap.GetRoot<Fixed>("fixed")->Ref == root->Children[1]);
+
+	heap.Unpin(pinned);
+	REFLECTOR_TEST_CHECK(!heap.IsPinned(pinned));
+}
+
+int main()
+{
+	TestCompactMovesObjects();
+	TestUnmovableObjects();
+	if (ReflectorTests::Failures == 0)
+		std::printf("GCCompactionTests: all checks passed\n");
+	return ReflectorTests::Failures;
+}
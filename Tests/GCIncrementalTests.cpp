@@ -0,0 +1,66 @@
+/// Tests of incremental collection (see `Reflector::Heap::Step` and `Reflector::Heap::WriteBarrier`)
+
+#include "GCTestCommon.h"
+
+using namespace Reflector;
+using ReflectorTests::FieldData;
+
+struct Node : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(Node);
+	using parent_type = Reflectable;
+	Node() : Reflectable(StaticGetReflectionData()) {}
+	explicit Node(Node* next) : Reflectable(StaticGetReflectionData()), Next(next) {}
+
+	Node* Next = nullptr;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldData<Node, Node*>{ &Node::Next });
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(false, REFLECTOR_TEST_GC_FIELD(Next))
+};
+REFLECTOR_TEST_GC_POINTER(Node)
+
+REFLECTOR_TEST_CLASS_DATA(Node)
+
+namespace Reflector
+{
+	Class const* Classes[] = { &Node::StaticGetReflectionData(), nullptr };
+	Enum const* Enums[] = { nullptr };
+}
+
+/// Pointers stored by the constructors of objects created while marking are traced, even if nothing else points to their targets
+static void TestObjectsCreatedWhileMarking()
+{
+	Heap heap;
+	const auto root = heap.NewRoot<Node>("root");
+	const auto target = heap.New<Node>();
+	root->Next = target;
+
+	/// Starts marking, without tracing anything
+	REFLECTOR_TEST_CHECK(!heap.Step(size_t(0)));
+	REFLECTOR_TEST_CHECK(heap.CurrentPhase() == Heap::Phase::Mark);
+
+	const auto created = heap.New<Node>(target);
+	heap.SetRoot("created", created);
+	root->Next = nullptr;
+	Heap::WriteBarrier(root);
+
+	while (!heap.Step(size_t(1))) {}
+	REFLECTOR_TEST_CHECK(heap.ObjectCount() == 3);
+	REFLECTOR_TEST_CHECK(created->Next == target && target->GC_IsOnHeap());
+
+	/// Once nothing points to it, it's collected as usual
+	created->Next = nullptr;
+	heap.Collect();
+	REFLECTOR_TEST_CHECK(heap.ObjectCount() == 2);
+}
+
+int main()
+{
+	TestObjectsCreatedWhileMarking();
+	if (ReflectorTests::Failures == 0)
+		std::printf("GCIncrementalTests: all checks passed\n");
+	return ReflectorTests::Failures;
+}
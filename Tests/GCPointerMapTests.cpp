@@ -0,0 +1,287 @@
+/// Tests of the pointer maps that the collector uses to mark objects (see `Reflector::GCPointerMap`)
+
+#include "GCTestCommon.h"
+
+using namespace Reflector;
+using ReflectorTests::FieldData;
+using ReflectorTests::StaticFieldData;
+
+/// A class deriving directly from `Reflectable`
+struct Node : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(Node);
+	using parent_type = Reflectable;
+	Node() : Reflectable(StaticGetReflectionData()) {}
+	explicit Node(Class const& klass) : Reflectable(klass) {}
+
+	int Value = 0;
+	std::string Name;
+	Node* Next = nullptr;
+	std::vector<Node*> Children;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldData<Node, int>{ &Node::Value });
+		visitor(FieldData<Node, std::string>{ &Node::Name });
+		visitor(FieldData<Node, Node*>{ &Node::Next });
+		visitor(FieldData<Node, std::vector<Node*>>{ &Node::Children });
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(false, REFLECTOR_TEST_GC_FIELD(Value), REFLECTOR_TEST_GC_FIELD(Name), REFLECTOR_TEST_GC_FIELD(Next), REFLECTOR_TEST_GC_FIELD(Children))
+};
+REFLECTOR_TEST_GC_POINTER(Node)
+
+/// A class deriving from a generated class
+struct DerivedNode : Node
+{
+	REFLECTOR_TEST_CLASS_BODY(DerivedNode);
+	using parent_type = Node;
+	DerivedNode() : Node(StaticGetReflectionData()) {}
+
+	Node* Extra = nullptr;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		if (!own_only) parent_type::ForEachField(visitor);
+		visitor(FieldData<DerivedNode, Node*>{ &DerivedNode::Extra });
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(true, REFLECTOR_TEST_GC_FIELD(Extra))
+};
+REFLECTOR_TEST_GC_POINTER(DerivedNode)
+
+/// A struct with its own `GCMark`; fields of this type can't be described by pointer maps
+struct Link
+{
+	Node* Target = nullptr;
+	void GCMark() const { Reflector::GCMark(Target); }
+};
+
+/// A class with a field the map can't describe
+struct StructHolder : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(StructHolder);
+	using parent_type = Reflectable;
+	StructHolder() : Reflectable(StaticGetReflectionData()) {}
+
+	Node* Direct = nullptr;
+	Link Indirect;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldData<StructHolder, Node*>{ &StructHolder::Direct });
+		visitor(FieldData<StructHolder, Link>{ &StructHolder::Indirect });
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(false, REFLECTOR_TEST_GC_FIELD(Direct), REFLECTOR_TEST_GC_FIELD(Indirect))
+};
+REFLECTOR_TEST_GC_POINTER(StructHolder)
+
+/// A class that isn't generated, so it's marked by its `GCMark`
+struct HandWritten : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(HandWritten);
+	HandWritten() : Reflectable(StaticGetReflectionData()) {}
+	explicit HandWritten(Class const& klass) : Reflectable(klass) {}
+
+	Node* Ref = nullptr;
+
+	void GCMark() const override
+	{
+		Reflectable::GCMark();
+		Reflector::GCMark(Ref);
+	}
+};
+REFLECTOR_TEST_GC_POINTER(HandWritten)
+
+/// A generated class deriving from a class that isn't generated
+struct HandWrittenChild : HandWritten
+{
+	REFLECTOR_TEST_CLASS_BODY(HandWrittenChild);
+	using parent_type = HandWritten;
+	HandWrittenChild() : HandWritten(StaticGetReflectionData()) {}
+
+	Node* Own = nullptr;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldData<HandWrittenChild, Node*>{ &HandWrittenChild::Own });
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(false, REFLECTOR_TEST_GC_FIELD(Own))
+};
+REFLECTOR_TEST_GC_POINTER(HandWrittenChild)
+
+/// A class with a static field, which isn't part of its objects, so it can't be in the map
+struct StaticHolder : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(StaticHolder);
+	using parent_type = Reflectable;
+	StaticHolder() : Reflectable(StaticGetReflectionData()) {}
+
+	Node* Own = nullptr;
+	static inline Node* Shared = nullptr;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldData<StaticHolder, Node*>{ &StaticHolder::Own });
+		visitor(StaticFieldData<StaticHolder, Node*, &StaticHolder::Shared>{});
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(false, REFLECTOR_TEST_GC_FIELD(Own), REFLECTOR_TEST_GC_STATIC_FIELD(Shared))
+};
+REFLECTOR_TEST_GC_POINTER(StaticHolder)
+
+/// A class whose `Reflectable` base is not at its start; pointers to it have to be adjusted to get to the `Reflectable`
+struct Mixin
+{
+	virtual ~Mixin() = default;
+	int MixinData = 0;
+};
+struct MixedNode : Mixin, Node
+{
+	REFLECTOR_TEST_CLASS_BODY(MixedNode);
+	MixedNode() : Node(StaticGetReflectionData()) {}
+};
+REFLECTOR_TEST_GC_POINTER(MixedNode)
+
+struct MixedHolder : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(MixedHolder);
+	using parent_type = Reflectable;
+	MixedHolder() : Reflectable(StaticGetReflectionData()) {}
+
+	MixedNode* Mixed = nullptr;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldData<MixedHolder, MixedNode*>{ &MixedHolder::Mixed });
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(false, REFLECTOR_TEST_GC_FIELD(Mixed))
+};
+REFLECTOR_TEST_GC_POINTER(MixedHolder)
+
+REFLECTOR_TEST_CLASS_DATA(Node)
+REFLECTOR_TEST_CLASS_DATA(DerivedNode)
+REFLECTOR_TEST_CLASS_DATA(StructHolder)
+REFLECTOR_TEST_CLASS_DATA(HandWritten)
+REFLECTOR_TEST_CLASS_DATA(HandWrittenChild)
+REFLECTOR_TEST_CLASS_DATA(StaticHolder)
+REFLECTOR_TEST_CLASS_DATA(MixedNode)
+REFLECTOR_TEST_CLASS_DATA(MixedHolder)
+
+namespace Reflector
+{
+	Class const* Classes[] = {
+		&Node::StaticGetReflectionData(), &DerivedNode::StaticGetReflectionData(), &StructHolder::StaticGetReflectionData(),
+		&HandWritten::StaticGetReflectionData(), &HandWrittenChild::StaticGetReflectionData(), &StaticHolder::StaticGetReflectionData(),
+		&MixedNode::StaticGetReflectionData(), &MixedHolder::StaticGetReflectionData(), nullptr
+	};
+	Enum const* Enums[] = { nullptr };
+}
+
+/// The maps are built at compile time
+static_assert(Node::GCPointerFields().Entries.size() == 2 && Node::GCPointerFields().Complete);
+static_assert(DerivedNode::GCPointerFields().Entries.size() == 3 && DerivedNode::GCPointerFields().Complete);
+static_assert(!HandWrittenChild::GCPointerFields().Complete && !StaticHolder::GCPointerFields().Complete);
+
+static void TestMapContents()
+{
+	Node node;
+	auto const& node_map = node.GCGetPointerMap();
+	REFLECTOR_TEST_CHECK(node_map.Complete);
+	REFLECTOR_TEST_CHECK(node_map.Entries.size() == 2);
+
+	DerivedNode derived;
+	auto const& derived_map = derived.GCGetPointerMap();
+	REFLECTOR_TEST_CHECK(derived_map.Complete);
+	REFLECTOR_TEST_CHECK(derived_map.Entries.size() == 3);
+
+	StructHolder holder;
+	REFLECTOR_TEST_CHECK(!holder.GCGetPointerMap().Complete);
+	REFLECTOR_TEST_CHECK(holder.GCGetPointerMap().Entries.size() == 1);
+
+	HandWritten hand_written;
+	REFLECTOR_TEST_CHECK(&hand_written.GCGetPointerMap() == &Reflectable::GCEmptyPointerMap());
+
+	HandWrittenChild child;
+	REFLECTOR_TEST_CHECK(!child.GCGetPointerMap().Complete);
+
+	StaticHolder static_holder;
+	REFLECTOR_TEST_CHECK(!static_holder.GCGetPointerMap().Complete);
+	REFLECTOR_TEST_CHECK(static_holder.GCGetPointerMap().Entries.size() == 1);
+	for (auto const& entry : static_holder.GCGetPointerMap().Entries)
+		REFLECTOR_TEST_CHECK(entry.Offset + sizeof(void*) <= sizeof(StaticHolder));
+}
+
+/// Pointer entries convert the pointers to `Reflectable*`, rather than assuming it's at the start of the pointed-to object
+static void TestPointerConversion()
+{
+	MixedNode first, second;
+	MixedHolder holder;
+	holder.Mixed = &first;
+	REFLECTOR_TEST_CHECK(static_cast<void*>(static_cast<Reflectable*>(&first)) != static_cast<void*>(&first));
+
+	auto const& map = holder.GCGetPointerMap();
+	REFLECTOR_TEST_CHECK(map.Complete && map.Entries.size() == 1);
+	if (map.Entries.size() != 1)
+		return;
+	auto const& entry = map.Entries[0];
+	const auto field = reinterpret_cast<char*>(&holder) + entry.Offset;
+	REFLECTOR_TEST_CHECK(entry.Functions->LoadPointer(field) == static_cast<Reflectable const*>(&first));
+	entry.Functions->StorePointer(field, static_cast<Reflectable*>(&second));
+	REFLECTOR_TEST_CHECK(holder.Mixed == &second);
+}
+
+/// Objects only reachable through each kind of field must survive a collection, and nothing else
+static void TestMarking()
+{
+	Heap heap;
+	auto node = heap.NewRoot<Node>("node");
+	node->Next = heap.New<Node>();
+	node->Children = { heap.New<Node>(), heap.New<Node>() };
+
+	auto derived = heap.NewRoot<DerivedNode>("derived");
+	derived->Next = heap.New<Node>();
+	derived->Extra = heap.New<Node>();
+
+	auto holder = heap.NewRoot<StructHolder>("holder");
+	holder->Direct = heap.New<Node>();
+	holder->Indirect.Target = heap.New<Node>();
+
+	auto child = heap.NewRoot<HandWrittenChild>("child");
+	child->Ref = heap.New<Node>();
+	child->Own = heap.New<Node>();
+
+	auto static_holder = heap.NewRoot<StaticHolder>("static");
+	static_holder->Own = heap.New<Node>();
+	StaticHolder::Shared = heap.New<Node>();
+
+	for (int i = 0; i < 10; ++i)
+		heap.New<Node>();
+
+	heap.Collect();
+	REFLECTOR_TEST_CHECK(heap.ObjectCount() == 4 + 3 + 2 + 2 + 2 + 2 + 1);
+	REFLECTOR_TEST_CHECK(StaticHolder::Shared->GC_IsOnHeap());
+	StaticHolder::Shared = nullptr;
+}
+
+/// Marking outside of a collection (e.g. by calling `GCMark` directly) doesn't shade anything, even right after one
+static void TestMarkingOutsideCollections()
+{
+	Heap heap;
+	heap.NewRoot<Node>("node");
+	heap.Collect();
+	heap.CollectMinor();
+	while (!heap.Step(size_t(16))) {}
+
+	const auto node = heap.New<Node>();
+	Reflector::GCMark(static_cast<Reflectable const*>(node));
+	REFLECTOR_TEST_CHECK(!node->GC_IsMarked() && !node->GC_IsGray());
+}
+
+int main()
+{
+	TestMapContents();
+	TestPointerConversion();
+	TestMarking();
+	TestMarkingOutsideCollections();
+	if (ReflectorTests::Failures == 0)
+		std::printf("GCPointerMapTests: all checks passed\n");
+	return ReflectorTests::Failures;
+}
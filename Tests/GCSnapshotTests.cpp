@@ -0,0 +1,224 @@
+/// Tests of heap snapshots (see `Reflector::Heap::SaveSnapshot` and `Reflector::Heap::LoadSnapshot`)
+
+#define REFLECTOR_USES_BINARY 1
+#include "GCTestCommon.h"
+
+#include <sstream>
+
+using namespace Reflector;
+using ReflectorTests::FieldData;
+
+struct Node : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(Node);
+	using parent_type = Reflectable;
+	Node() : Reflectable(StaticGetReflectionData()) {}
+
+	int Value = 0;
+	Node* Next = nullptr;
+	std::string Name;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldData<Node, Node*>{ &Node::Next });
+	}
+	REFLECTOR_TEST_GC_FUNCTIONS(false, REFLECTOR_TEST_GC_FIELD(Next))
+
+	void BinarySaveFields(BinaryWriter& writer) const override
+	{
+		BinaryWriteField(writer, 1, Value);
+		BinaryWriteField(writer, 2, Next);
+		BinaryWriteField(writer, 3, Name);
+	}
+	void BinaryLoadFields(BinaryObject const& object) override
+	{
+		if (auto element = object.Find(1)) BinaryReadField(*element, Value);
+		if (auto element = object.Find(2)) BinaryReadField(*element, Next);
+		if (auto element = object.Find(3)) BinaryReadField(*element, Name);
+	}
+};
+REFLECTOR_TEST_GC_POINTER(Node)
+
+REFLECTOR_TEST_CLASS_DATA(Node)
+
+namespace Reflector
+{
+	Class const* Classes[] = { &Node::StaticGetReflectionData(), nullptr };
+	Enum const* Enums[] = { nullptr };
+}
+
+/// A stream buffer that can't seek, like that of a pipe or a socket
+struct UnseekableBuffer : std::streambuf
+{
+	explicit UnseekableBuffer(std::string& data) { setg(data.data(), data.data(), data.data() + data.size()); }
+};
+
+static std::string SaveTestSnapshot()
+{
+	Heap heap;
+	auto root = heap.NewRoot<Node>("root");
+	root->Value = 1;
+	root->Name = "root";
+	for (int i = 0; i < 100; ++i)
+	{
+		auto node = heap.New<Node>();
+		node->Value = i + 2;
+		node->Next = root->Next;
+		root->Next = node;
+	}
+	std::stringstream out;
+	heap.SaveSnapshot(out);
+	return out.str();
+}
+
+/// The start of a snapshot with a single group of `Node` objects, `object_count` long
+static BinaryWriter SnapshotHeader(uint64_t group_count, uint64_t object_count)
+{
+	BinaryWriter writer;
+	writer.WriteBytes(std::span{ SnapshotFormatMagic });
+	writer.WriteVarint(SnapshotFormatVersion);
+	writer.WriteVarint(group_count);
+	writer.WriteFixed64(BinaryClassID(Node::StaticGetReflectionData().FullType));
+	writer.WriteVarint(object_count);
+	return writer;
+}
+
+static std::string ToString(BinaryWriter const& writer)
+{
+	return { reinterpret_cast<char const*>(writer.Buffer.data()), writer.Buffer.size() };
+}
+
+static bool LoadThrowsDataError(std::string data, bool seekable = true)
+{
+	Heap heap;
+	try
+	{
+		if (seekable)
+		{
+			std::stringstream in{ data };
+			heap.LoadSnapshot(in);
+		}
+		else
+		{
+			UnseekableBuffer buffer{ data };
+			std::istream in{ &buffer };
+			heap.LoadSnapshot(in);
+		}
+	}
+	catch (DataError const&)
+	{
+		return true;
+	}
+	return false;
+}
+
+static void TestRoundTrip()
+{
+	auto data = SaveTestSnapshot();
+	for (bool seekable : { true, false })
+	{
+		Heap heap;
+		if (seekable)
+		{
+			std::stringstream in{ data };
+			heap.LoadSnapshot(in);
+		}
+		else
+		{
+			UnseekableBuffer buffer{ data };
+			std::istream in{ &buffer };
+			heap.LoadSnapshot(in);
+		}
+		REFLECTOR_TEST_CHECK(heap.ObjectCount() == 101);
+		const auto root = heap.GetRoot<Node>("root");
+		REFLECTOR_TEST_CHECK(root && root->Name == "root" && root->Next && root->Next->Value == 101);
+	}
+}
+
+static void TestTruncatedSnapshots()
+{
+	const auto data = SaveTestSnapshot();
+	for (size_t size : { size_t(0), size_t(3), size_t(8), size_t(20), data.size() / 2, data.size() - 1 })
+	{
+		REFLECTOR_TEST_CHECK(LoadThrowsDataError(data.substr(0, size)));
+		REFLECTOR_TEST_CHECK(LoadThrowsDataError(data.substr(0, size), false));
+	}
+}
+
+/// Counts and lengths larger than the snapshot are rejected before anything is allocated for them
+static void TestCorruptedCounts()
+{
+	constexpr uint64_t huge = uint64_t(1) << 50;
+
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(ToString(SnapshotHeader(huge, 1))));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(ToString(SnapshotHeader(1, huge))));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(ToString(SnapshotHeader(1, huge)), false));
+
+	auto long_root_name = SnapshotHeader(1, 1);
+	long_root_name.WriteVarint(1);
+	long_root_name.WriteVarint(huge);
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(ToString(long_root_name)));
+
+	auto long_object = SnapshotHeader(1, 1);
+	long_object.WriteVarint(0);
+	long_object.WriteVarint(huge);
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(ToString(long_object)));
+}
+
+/// The same heap always gives the same snapshot, and so does a heap loaded from it
+static void TestDeterministicSnapshots()
+{
+	const auto data = SaveTestSnapshot();
+	REFLECTOR_TEST_CHECK(SaveTestSnapshot() == data);
+
+	Heap heap;
+	std::stringstream in{ data };
+	heap.LoadSnapshot(in);
+	std::stringstream out;
+	heap.SaveSnapshot(out);
+	REFLECTOR_TEST_CHECK(out.str() == data);
+}
+
+/// A snapshot that fails to load leaves the heap as it was
+static void TestFailedLoadKeepsHeap()
+{
+	const auto data = SaveTestSnapshot();
+	Heap heap;
+	const auto root = heap.NewRoot<Node>("original");
+	root->Name = "original";
+	root->Next = heap.New<Node>();
+
+	for (size_t size : { size_t(20), data.size() / 2, data.size() - 1 })
+	{
+		std::stringstream in{ data.substr(0, size) };
+		bool threw = false;
+		try { heap.LoadSnapshot(in); }
+		catch (DataError const&) { threw = true; }
+		REFLECTOR_TEST_CHECK(threw);
+		REFLECTOR_TEST_CHECK(heap.ObjectCount() == 2);
+		REFLECTOR_TEST_CHECK(heap.GetRoot<Node>("original") == root && root->Name == "original" && root->Next->GC_IsOnHeap());
+		REFLECTOR_TEST_CHECK(!heap.GetRoot("root"));
+	}
+
+	/// A valid snapshot still replaces everything, and the loaded objects behave like any others
+	std::stringstream in{ data };
+	heap.LoadSnapshot(in);
+	REFLECTOR_TEST_CHECK(heap.ObjectCount() == 101 && !heap.GetRoot("original"));
+	heap.New<Node>();
+	heap.Collect();
+	REFLECTOR_TEST_CHECK(heap.ObjectCount() == 101);
+	for (auto obj : heap.Objects())
+		REFLECTOR_TEST_CHECK(Heap::Of(obj) == &heap);
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestTruncatedSnapshots();
+	TestCorruptedCounts();
+	TestDeterministicSnapshots();
+	TestFailedLoadKeepsHeap();
+	if (ReflectorTests::Failures == 0)
+		std::printf("GCSnapshotTests: all checks passed\n");
+	return ReflectorTests::Failures;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+/// Shared helpers for the standalone GC tests. Each test is a single program that includes the Reflector runtime directly:
+///   g++ -std=c++20 -fpermissive -I../Include -o GCPointerMapTests GCPointerMapTests.cpp
+/// The test classes are written by hand, in the same shape as the code generated for them by Reflector.
+
+#define REFLECTOR_USES_GC 1
+#include "ReflectorGC.h"
+#include "Reflector.cpp"
+#include "TestCommon.h"
+
+namespace ReflectorTests
+{
+	/// Stands in for the `FieldVisitorData` of the generated field visitors
+	template <typename CLASS, typename FIELD>
+	struct FieldData
+	{
+		static constexpr bool IsStatic = false;
+		FIELD CLASS::* Pointer;
+		auto Getter(CLASS const* obj) const -> FIELD const& { return obj->*Pointer; }
+	};
+
+	/// Same, for static fields
+	template <typename CLASS, typename FIELD, FIELD* POINTER>
+	struct StaticFieldData
+	{
+		static constexpr bool IsStatic = true;
+		static auto Getter(CLASS const*) -> FIELD const& { return *POINTER; }
+	};
+}
+
+/// The pointer map entries of the parent of a test class, as passed to `GCPointerFields` by the generated code
+namespace ReflectorTests
+{
+	template <bool PARENT_IS_GENERATED, typename PARENT>
+	constexpr auto ParentPointerFields()
+	{
+		if constexpr (PARENT_IS_GENERATED)
+			return PARENT::GCPointerFields();
+		else
+			return ::Reflector::GCPointerFieldList<0>{ {}, std::is_same_v<PARENT, ::Reflector::Reflectable> };
+	}
+}
+
+/// The fields of a test class, as listed in its generated `GCPointerFields` function
+#define REFLECTOR_TEST_GC_FIELD(NAME) ::Reflector::GCMemberField<decltype(self_type::NAME)>(offsetof(self_type, NAME))
+#define REFLECTOR_TEST_GC_STATIC_FIELD(NAME) ::Reflector::GCStaticField<decltype(self_type::NAME)>()
+
+/// The GC members generated for a class, as written by `BuildClassEntry`; `PARENT_IS_GENERATED` selects between its two forms,
+/// and the rest of the arguments are the own fields of the class (see `REFLECTOR_TEST_GC_FIELD`)
+#define REFLECTOR_TEST_GC_FUNCTIONS(PARENT_IS_GENERATED, ...) \
+	virtual void GCMark() const override \
+	{ \
+		parent_type::GCMark(); \
+		ForEachField([this](auto&& visitor_data) { ::Reflector::GCMark(visitor_data.Getter(this)); }); \
+	} \
+	REFLECTOR_GC_OFFSETOF_BEGIN \
+	static constexpr auto GCPointerFields() \
+	{ \
+		return ::Reflector::GCPointerFields(::ReflectorTests::ParentPointerFields<PARENT_IS_GENERATED, parent_type>(), [] { return ::Reflector::GCFieldEntries(__VA_ARGS__); }); \
+	} \
+	REFLECTOR_GC_OFFSETOF_END \
+	virtual ::Reflector::GCPointerMap const& GCGetPointerMap() const override \
+	{ \
+		static constexpr auto _fields = GCPointerFields(); \
+		static constexpr ::Reflector::GCPointerMap _map{ _fields.Entries, _fields.Complete }; \
+		return _map; \
+	} \
+	virtual void GCMarkUnmapped() const override \
+	{ \
+		if constexpr (PARENT_IS_GENERATED) parent_type::GCMarkUnmapped(); \
+		else if constexpr (!std::is_same_v<parent_type, ::Reflector::Reflectable>) parent_type::GCMark(); \
+		ForEachField([this](auto&& visitor_data) { ::Reflector::GCMarkIfUnmapped(this, visitor_data); }, true); \
+	}
+
+/// The `GCMark` overload for pointers to a test class; has to come right after the class, before anything marks such pointers
+#define REFLECTOR_TEST_GC_POINTER(T) \
+	template <> void Reflector::GCMark<T>(T const* r) { GCMark(static_cast<Reflectable const*>(r)); }
+
+/// Reflection data for a hand-written test class
+#define REFLECTOR_TEST_CLASS_DATA(T) \
+	::Reflector::Class const& T::StaticGetReflectionData() \
+	{ \
+		static const ::Reflector::Class data{ .Name = #T, .FullType = #T, .Alignment = alignof(T), .Size = sizeof(T), \
+			.DefaultPlacementConstructor = [](void* p) { new (p) T(); }, .Destructor = [](void* p) { static_cast<T*>(p)->~T(); } }; \
+		return data; \
+	}
+
+/// Reflection data for a hand-written test class with the `Relocatable` attribute
+#define REFLECTOR_TEST_RELOCATABLE_CLASS_DATA(T) \
+	::Reflector::Class const& T::StaticGetReflectionData() \
+	{ \
+		static const ::Reflector::Class data{ .Name = #T, .FullType = #T, .Alignment = alignof(T), .Size = sizeof(T), \
+			.DefaultPlacementConstructor = [](void* p) { new (p) T(); }, .Destructor = [](void* p) { static_cast<T*>(p)->~T(); }, \
+			.Relocate = ::Reflector::RelocateFunction<T>() }; \
+		return data; \
+	}
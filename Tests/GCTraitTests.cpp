@@ -0,0 +1,64 @@
+/// Compile-time tests of the GC type traits (see ReflectorGC.h); the program itself does nothing
+
+#include "GCTestCommon.h"
+
+#include <map>
+#include <filesystem>
+
+using namespace Reflector;
+
+struct Node : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(Node);
+	Node() : Reflectable(StaticGetReflectionData()) {}
+};
+
+/// A struct with its own `GCMark`
+struct Handle
+{
+	Node* Target = nullptr;
+	void GCMark() const { Reflector::GCMark(static_cast<Reflectable const*>(Target)); }
+};
+
+/// `could_be_marked` decides which setters get write barriers, so it must only be true for types that can hold GC pointers
+static_assert(!could_be_marked<int>::value);
+static_assert(!could_be_marked<double const&>::value);
+static_assert(!could_be_marked<std::string>::value);
+static_assert(!could_be_marked<std::vector<int>>::value);
+static_assert(!could_be_marked<std::vector<std::string>>::value);
+static_assert(!could_be_marked<std::map<std::string, int>>::value);
+static_assert(!could_be_marked<std::pair<int, std::string>>::value);
+static_assert(!could_be_marked<std::filesystem::path>::value);
+static_assert(!could_be_marked<int*>::value);
+
+static_assert(could_be_marked<Node*>::value);
+static_assert(could_be_marked<Node const* const&>::value);
+static_assert(could_be_marked<Reflectable*>::value);
+static_assert(could_be_marked<Handle>::value);
+static_assert(could_be_marked<Node>::value);
+static_assert(could_be_marked<std::vector<Node*>>::value);
+static_assert(could_be_marked<Node* [4]>::value);
+static_assert(could_be_marked<std::vector<Handle>>::value);
+static_assert(could_be_marked<std::map<std::string, Node*>>::value);
+static_assert(could_be_marked<std::tuple<int, Node*>>::value);
+static_assert(could_be_marked<std::variant<int, std::vector<Node*>>>::value);
+
+static_assert(GCFieldKindOf<std::string>() == GCFieldKind::NotMarked);
+static_assert(GCFieldKindOf<std::vector<std::string>>() == GCFieldKind::NotMarked);
+static_assert(GCFieldKindOf<Node*>() == GCFieldKind::Pointer);
+static_assert(GCFieldKindOf<std::vector<Node*>>() == GCFieldKind::Range);
+static_assert(GCFieldKindOf<Handle>() == GCFieldKind::Unmapped);
+
+REFLECTOR_TEST_CLASS_DATA(Node)
+
+namespace Reflector
+{
+	Class const* Classes[] = { &Node::StaticGetReflectionData(), nullptr };
+	Enum const* Enums[] = { nullptr };
+}
+
+int main()
+{
+	std::printf("GCTraitTests: all checks passed\n");
+	return 0;
+}
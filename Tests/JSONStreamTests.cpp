@@ -0,0 +1,363 @@
+/// Tests of the streaming JSON loader and writer (see `Reflector::JSONStreamLoad` and `Reflector::JSONStreamSave`)
+
+#include "SerializationTestCommon.h"
+
+#include <cmath>
+#include <sstream>
+
+using namespace Reflector;
+
+struct Entry
+{
+	REFLECTOR_TEST_STRUCT_BODY(Entry);
+
+	int32_t Count = 1;
+	std::string Text;
+	std::vector<double> Values;
+	std::map<std::string, std::vector<int>> Tags;
+	nlohmann::json Extra;
+
+	bool operator==(Entry const&) const = default;
+
+	static constexpr size_t JSONLoadableFieldCount = 5;
+
+	bool JSONSAXField(uint32_t key_hash, std::string_view key, JSONSAXLoader& loader, JSONLoadedFields& loaded)
+	{
+		constexpr size_t field_index_base = 0;
+		switch (key_hash) {
+		case FieldNameHash("Count"): if (key == "Count") { loaded.Set(field_index_base + 0); loader.Load(this->Count); return true; } break;
+		case FieldNameHash("Text"): if (key == "Text") { loaded.Set(field_index_base + 1); loader.Load(this->Text); return true; } break;
+		case FieldNameHash("Values"): if (key == "Values") { loaded.Set(field_index_base + 2); loader.Load(this->Values); return true; } break;
+		case FieldNameHash("Tags"): if (key == "Tags") { loaded.Set(field_index_base + 3); loader.Load(this->Tags); return true; } break;
+		case FieldNameHash("Extra"): if (key == "Extra") { loaded.Set(field_index_base + 4); loader.Load(this->Extra); return true; } break;
+		}
+		return false;
+	}
+
+	void JSONLoadFinish(JSONLoadedFields const& loaded)
+	{
+		constexpr size_t field_index_base = 0;
+		if (!loaded.Test(field_index_base + 0)) this->Count = 1;
+		if (!loaded.Test(field_index_base + 1)) this->Text = decltype(this->Text){};
+		if (!loaded.Test(field_index_base + 2)) this->Values = decltype(this->Values){};
+		if (!loaded.Test(field_index_base + 3)) this->Tags = decltype(this->Tags){};
+		if (!loaded.Test(field_index_base + 4)) this->Extra = decltype(this->Extra){};
+	}
+
+	void JSONSaveFields(nlohmann::json& dest_object) const
+	{
+		do { if (::Compare_(this->Count, 1)) break; dest_object["Count"] = this->Count; } while (false);
+		dest_object["Text"] = this->Text;
+		dest_object["Values"] = this->Values;
+		dest_object["Tags"] = this->Tags;
+		dest_object["Extra"] = this->Extra;
+	}
+
+	void JSONWriteFields(JSONWriter& writer) const
+	{
+		do { if (::Compare_(this->Count, 1)) break; writer.Field("Count", this->Count); } while (false);
+		writer.Field("Text", this->Text);
+		writer.Field("Values", this->Values);
+		writer.Field("Tags", this->Tags);
+		writer.Field("Extra", this->Extra);
+	}
+};
+
+/// `Name` is `Required`
+struct Node : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(Node);
+	using parent_type = Reflectable;
+	Node() : Reflectable(StaticGetReflectionData()) {}
+	explicit Node(Class const& klass) : Reflectable(klass) {}
+
+	std::string Name;
+	std::vector<std::unique_ptr<Node>> Children;
+
+	virtual bool Equals(Node const& other) const
+	{
+		return &GetReflectionData() == &other.GetReflectionData() && Name == other.Name
+			&& std::ranges::equal(Children, other.Children, [](auto const& a, auto const& b) { return a ? b && a->Equals(*b) : !b; });
+	}
+
+	static constexpr size_t JSONLoadableFieldCount = parent_type::JSONLoadableFieldCount + 2;
+
+	void JSONLoadFields(nlohmann::json const& src_object) override
+	{
+		JSONLoadedFields loaded;
+		if (src_object.is_object())
+		{
+			for (auto const& [key, value] : src_object.get_ref<nlohmann::json::object_t const&>())
+				this->JSONLoadField(FieldNameHash(key), key, value, loaded);
+		}
+		this->JSONLoadFinish(loaded);
+	}
+
+	bool JSONLoadField(uint32_t key_hash, std::string_view key, nlohmann::json const& value, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Name"):
+			if (key == "Name") { loaded.Set(field_index_base + 0); try { value.get_to<std::string>(this->Name); } catch (DataError& e) { e.File += "/Name"; throw; } return true; }
+			break;
+		case FieldNameHash("Children"):
+			if (key == "Children") { loaded.Set(field_index_base + 1); try { value.get_to<std::vector<std::unique_ptr<Node>>>(this->Children); } catch (DataError& e) { e.File += "/Children"; throw; } return true; }
+			break;
+		}
+		return parent_type::JSONLoadField(key_hash, key, value, loaded);
+	}
+
+	bool JSONSAXField(uint32_t key_hash, std::string_view key, JSONSAXLoader& loader, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Name"): if (key == "Name") { loaded.Set(field_index_base + 0); loader.Load(this->Name); return true; } break;
+		case FieldNameHash("Children"): if (key == "Children") { loaded.Set(field_index_base + 1); loader.Load(this->Children); return true; } break;
+		}
+		return parent_type::JSONSAXField(key_hash, key, loader, loaded);
+	}
+
+	void JSONLoadFinish(JSONLoadedFields const& loaded) override
+	{
+		parent_type::JSONLoadFinish(loaded);
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		if (!loaded.Test(field_index_base + 0)) throw DataError{ "Missing field 'Name'" };
+		if (!loaded.Test(field_index_base + 1)) this->Children = decltype(this->Children){};
+	}
+
+	void JSONSaveFields(nlohmann::json& dest_object) const override
+	{
+		parent_type::JSONSaveFields(dest_object);
+		dest_object["Name"] = this->Name;
+		dest_object["Children"] = this->Children;
+		dest_object["$type"] = "Node";
+	}
+
+	void JSONWriteFields(JSONWriter& writer) const override
+	{
+		parent_type::JSONWriteFields(writer);
+		writer.Field("Name", this->Name);
+		writer.Field("Children", this->Children);
+	}
+};
+
+struct Leaf : Node
+{
+	REFLECTOR_TEST_CLASS_BODY(Leaf);
+	using parent_type = Node;
+	Leaf() : Node(StaticGetReflectionData()) {}
+
+	double Weight = 0;
+
+	bool Equals(Node const& other) const override { return Node::Equals(other) && Weight == static_cast<Leaf const&>(other).Weight; }
+
+	static constexpr size_t JSONLoadableFieldCount = parent_type::JSONLoadableFieldCount + 1;
+
+	void JSONLoadFields(nlohmann::json const& src_object) override
+	{
+		JSONLoadedFields loaded;
+		if (src_object.is_object())
+		{
+			for (auto const& [key, value] : src_object.get_ref<nlohmann::json::object_t const&>())
+				this->JSONLoadField(FieldNameHash(key), key, value, loaded);
+		}
+		this->JSONLoadFinish(loaded);
+	}
+
+	bool JSONLoadField(uint32_t key_hash, std::string_view key, nlohmann::json const& value, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Weight"):
+			if (key == "Weight") { loaded.Set(field_index_base + 0); try { value.get_to<double>(this->Weight); } catch (DataError& e) { e.File += "/Weight"; throw; } return true; }
+			break;
+		}
+		return parent_type::JSONLoadField(key_hash, key, value, loaded);
+	}
+
+	bool JSONSAXField(uint32_t key_hash, std::string_view key, JSONSAXLoader& loader, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Weight"): if (key == "Weight") { loaded.Set(field_index_base + 0); loader.Load(this->Weight); return true; } break;
+		}
+		return parent_type::JSONSAXField(key_hash, key, loader, loaded);
+	}
+
+	void JSONLoadFinish(JSONLoadedFields const& loaded) override
+	{
+		parent_type::JSONLoadFinish(loaded);
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		if (!loaded.Test(field_index_base + 0)) this->Weight = 0;
+	}
+
+	void JSONSaveFields(nlohmann::json& dest_object) const override
+	{
+		parent_type::JSONSaveFields(dest_object);
+		do { if (::Compare_(this->Weight, 0)) break; dest_object["Weight"] = this->Weight; } while (false);
+		dest_object["$type"] = "Leaf";
+	}
+
+	void JSONWriteFields(JSONWriter& writer) const override
+	{
+		parent_type::JSONWriteFields(writer);
+		do { if (::Compare_(this->Weight, 0)) break; writer.Field("Weight", this->Weight); } while (false);
+	}
+};
+
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Entry, "")
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Node, "")
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Leaf, "Node")
+
+namespace Reflector
+{
+	Class const* Classes[] = { &Node::StaticGetReflectionData(), &Leaf::StaticGetReflectionData(), nullptr };
+	Enum const* Enums[] = { nullptr };
+}
+
+static Entry MakeEntry()
+{
+	Entry entry;
+	entry.Count = -3;
+	entry.Text = "text";
+	entry.Values = { 1.0, 0.1, -2.5e300 };
+	entry.Tags = { { "a", { 1, 2, 3 } }, { "empty", {} } };
+	entry.Extra = nlohmann::json::parse(R"({"q":[1,"two",null,{"r":true}]})");
+	return entry;
+}
+
+static std::unique_ptr<Node> MakeTree()
+{
+	auto root = std::make_unique<Node>();
+	root->Name = "root";
+	for (int i = 0; i < 3; ++i)
+	{
+		auto leaf = std::make_unique<Leaf>();
+		leaf->Name = "leaf " + std::to_string(i);
+		leaf->Weight = i * 0.25;
+		root->Children.push_back(std::move(leaf));
+	}
+	root->Children.push_back(nullptr);
+	root->Children.push_back(std::make_unique<Node>());
+	root->Children.back()->Name = "inner";
+	return root;
+}
+
+template <typename T>
+static bool LoadThrowsDataError(std::string_view text, T& value)
+{
+	try { JSONStreamLoad(text, value); }
+	catch (DataError const&) { return true; }
+	return false;
+}
+
+/// The writer writes the same JSON as the DOM, and the loader loads it back
+static void TestRoundTrip()
+{
+	const auto entry = MakeEntry();
+	const auto entry_text = JSONStreamSave(entry);
+	REFLECTOR_TEST_CHECK(nlohmann::json::parse(entry_text) == nlohmann::json(entry));
+	Entry loaded_entry;
+	JSONStreamLoad(std::string_view{ entry_text }, loaded_entry);
+	REFLECTOR_TEST_CHECK(loaded_entry == entry);
+
+	const auto tree = MakeTree();
+	const auto tree_text = JSONStreamSave(tree);
+	REFLECTOR_TEST_CHECK(nlohmann::json::parse(tree_text) == nlohmann::json(tree));
+	std::unique_ptr<Node> loaded_tree;
+	JSONStreamLoad(std::string_view{ tree_text }, loaded_tree);
+	REFLECTOR_TEST_CHECK(loaded_tree && loaded_tree->Equals(*tree));
+
+	/// Also from and to streams, with more than the writer buffers at once
+	std::vector<Entry> entries(2000, entry);
+	std::ostringstream out;
+	JSONStreamSave(out, entries);
+	REFLECTOR_TEST_CHECK(out.str() == JSONStreamSave(entries));
+	std::istringstream in{ out.str() };
+	std::vector<Entry> loaded_entries;
+	JSONStreamLoad(in, loaded_entries);
+	REFLECTOR_TEST_CHECK(loaded_entries == entries);
+}
+
+/// Unknown fields are skipped, whatever their contents, and missing ones reset
+static void TestUnknownAndMissingFields()
+{
+	auto entry = MakeEntry();
+	JSONStreamLoad(std::string_view{ R"({"Unknown":{"deep":[1,{"x":[]}],"more":null},"Count":3,"Other":[[]]})" }, entry);
+	REFLECTOR_TEST_CHECK(entry.Count == 3 && entry.Text.empty() && entry.Values.empty() && entry.Tags.empty() && entry.Extra.is_null());
+}
+
+static void TestPolymorphicPointers()
+{
+	/// The type field doesn't have to come first
+	std::unique_ptr<Node> node;
+	JSONStreamLoad(std::string_view{ R"({"Name":"late","Weight":2,"$type":"Leaf"})" }, node);
+	REFLECTOR_TEST_CHECK(node && node->Is<Leaf>() && node->Name == "late" && node->As<Leaf>()->Weight == 2);
+
+	/// An object of the same class is reused, an object of a different class replaced
+	const auto leaf = node.get();
+	JSONStreamLoad(std::string_view{ R"({"$type":"Leaf","Name":"again"})" }, node);
+	REFLECTOR_TEST_CHECK(node.get() == leaf && node->Name == "again" && node->As<Leaf>()->Weight == 0);
+	JSONStreamLoad(std::string_view{ R"({"$type":"Node","Name":"node"})" }, node);
+	REFLECTOR_TEST_CHECK(node && !node->Is<Leaf>() && node->Name == "node");
+
+	JSONStreamLoad(std::string_view{ "null" }, node);
+	REFLECTOR_TEST_CHECK(!node);
+}
+
+static void TestMalformedInput()
+{
+	const auto text = JSONStreamSave(MakeTree());
+	for (size_t size = 0; size < text.size(); ++size)
+	{
+		std::unique_ptr<Node> tree;
+		REFLECTOR_TEST_CHECK(LoadThrowsDataError(std::string_view{ text }.substr(0, size), tree));
+	}
+
+	Entry entry;
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError("{} {}", entry));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(R"({"Count":1,})", entry));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError("5", entry));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError("[{}]", entry));
+
+	std::unique_ptr<Node> node;
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(R"({"$type":"Unknown","Name":"x"})", node));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(R"({"Name":"x","$type":"Unknown"})", node));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(R"({"Name":"x"})", node));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(R"("Node")", node));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(R"([{"$type":"Node","Name":"x"}])", node));
+	REFLECTOR_TEST_CHECK(!node);
+
+	/// Missing required fields, in streamed and buffered objects
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(R"({"$type":"Leaf","Weight":1})", node));
+	REFLECTOR_TEST_CHECK(LoadThrowsDataError(R"({"Children":[{"$type":"Node"}],"$type":"Node","Name":"x"})", node));
+}
+
+/// Strings and numbers are written the way `REFLECTOR_JSON_TYPE::dump` writes them
+static void TestWriterEscaping()
+{
+	std::string text = "quote \" backslash \\ slash / utf-8 \xC3\xA9 controls ";
+	for (char c = 1; c < 0x20; ++c)
+		text += c;
+	text += '\x7F';
+	REFLECTOR_TEST_CHECK(JSONStreamSave(text) == nlohmann::json(text).dump());
+	REFLECTOR_TEST_CHECK(nlohmann::json::parse(JSONStreamSave(text)) == text);
+
+	const std::vector<double> values = { 0.0, -0.0, 1.0, 0.1, 1e300, -2.5e-300, 123456789.0, NAN, INFINITY, -INFINITY };
+	REFLECTOR_TEST_CHECK(JSONStreamSave(values) == nlohmann::json(values).dump());
+
+	const std::map<std::string, int> keys = { { "\"key\"\n", 1 }, { "", 2 } };
+	REFLECTOR_TEST_CHECK(JSONStreamSave(keys) == nlohmann::json(keys).dump());
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestUnknownAndMissingFields();
+	TestPolymorphicPointers();
+	TestMalformedInput();
+	TestWriterEscaping();
+	if (ReflectorTests::Failures == 0)
+		std::printf("JSONStreamTests: all checks passed\n");
+	return ReflectorTests::Failures;
+}
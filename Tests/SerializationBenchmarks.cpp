@@ -0,0 +1,617 @@
+/// Benchmarks of the serialization formats: the JSON DOM (`adl_serializer`, i.e. the generated `JSONSaveFields`/`JSONLoadFields`),
+/// the streaming JSON loader and writer (`JSONStreamLoad`/`JSONStreamSave`), and the binary format (`BinarySave`/`BinaryLoad`),
+/// over flat records (saved row by row, and column by column with the `Columnar` attribute) and a polymorphic `std::unique_ptr` graph.
+///
+/// For each data set and format, reports the size of the saved data, the throughput of saving and loading it (in MB/s of saved data
+/// and objects/s; best of the repetitions), the number of allocations per object made by saving and loading it, and the peak RSS of
+/// the process so far. Loaded data is compared with the original, and the program fails if they differ.
+///
+/// Build with optimizations (see SerializationTestCommon.h for the include paths), and run with an optional object count and
+/// repetition count:
+///   g++ -std=c++20 -fpermissive -O2 -DNDEBUG -I../Include -I<nlohmann/json include directory> -o SerializationBenchmarks SerializationBenchmarks.cpp
+///   ./SerializationBenchmarks 100000 10
+
+#include "SerializationTestCommon.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sys/resource.h>
+
+using namespace Reflector;
+
+/// Allocation counting
+/// ///////////////////////////////////// ///
+
+namespace ReflectorTests
+{
+	inline size_t AllocationCount = 0;
+}
+
+void* operator new(size_t size)
+{
+	++ReflectorTests::AllocationCount;
+	if (const auto ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc{};
+}
+void* operator new[](size_t size) { return ::operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+/// Data sets
+/// ///////////////////////////////////// ///
+
+/// A flat record, saved as an object per record
+struct Record
+{
+	REFLECTOR_TEST_STRUCT_BODY(Record);
+
+	float X = 0;
+	float Y = 0;
+	float Z = 0;
+	int32_t ID = 0;
+	uint64_t Flags = 0;
+	std::string Name;
+
+	bool operator==(Record const&) const = default;
+
+	static constexpr size_t JSONLoadableFieldCount = 6;
+
+	void JSONLoadFields(nlohmann::json const& src_object)
+	{
+		JSONLoadedFields loaded;
+		if (src_object.is_object())
+		{
+			for (auto const& [key, value] : src_object.get_ref<nlohmann::json::object_t const&>())
+				this->JSONLoadField(FieldNameHash(key), key, value, loaded);
+		}
+		this->JSONLoadFinish(loaded);
+	}
+
+	bool JSONLoadField(uint32_t key_hash, std::string_view key, nlohmann::json const& value, JSONLoadedFields& loaded)
+	{
+		constexpr size_t field_index_base = 0;
+		switch (key_hash) {
+		case FieldNameHash("X"):
+			if (key == "X") { loaded.Set(field_index_base + 0); try { value.get_to<float>(this->X); } catch (DataError& e) { e.File += "/X"; throw; } return true; }
+			break;
+		case FieldNameHash("Y"):
+			if (key == "Y") { loaded.Set(field_index_base + 1); try { value.get_to<float>(this->Y); } catch (DataError& e) { e.File += "/Y"; throw; } return true; }
+			break;
+		case FieldNameHash("Z"):
+			if (key == "Z") { loaded.Set(field_index_base + 2); try { value.get_to<float>(this->Z); } catch (DataError& e) { e.File += "/Z"; throw; } return true; }
+			break;
+		case FieldNameHash("ID"):
+			if (key == "ID") { loaded.Set(field_index_base + 3); try { value.get_to<int32_t>(this->ID); } catch (DataError& e) { e.File += "/ID"; throw; } return true; }
+			break;
+		case FieldNameHash("Flags"):
+			if (key == "Flags") { loaded.Set(field_index_base + 4); try { value.get_to<uint64_t>(this->Flags); } catch (DataError& e) { e.File += "/Flags"; throw; } return true; }
+			break;
+		case FieldNameHash("Name"):
+			if (key == "Name") { loaded.Set(field_index_base + 5); try { value.get_to<std::string>(this->Name); } catch (DataError& e) { e.File += "/Name"; throw; } return true; }
+			break;
+		}
+		return false;
+	}
+
+	void JSONLoadFinish(JSONLoadedFields const& loaded)
+	{
+		constexpr size_t field_index_base = 0;
+		if (!loaded.Test(field_index_base + 0)) this->X = 0;
+		if (!loaded.Test(field_index_base + 1)) this->Y = 0;
+		if (!loaded.Test(field_index_base + 2)) this->Z = 0;
+		if (!loaded.Test(field_index_base + 3)) this->ID = 0;
+		if (!loaded.Test(field_index_base + 4)) this->Flags = 0;
+		if (!loaded.Test(field_index_base + 5)) this->Name = decltype(this->Name){};
+	}
+
+	void JSONSaveFields(nlohmann::json& dest_object) const
+	{
+		do { if (::Compare_(this->X, 0)) break; dest_object["X"] = this->X; } while (false);
+		do { if (::Compare_(this->Y, 0)) break; dest_object["Y"] = this->Y; } while (false);
+		do { if (::Compare_(this->Z, 0)) break; dest_object["Z"] = this->Z; } while (false);
+		do { if (::Compare_(this->ID, 0)) break; dest_object["ID"] = this->ID; } while (false);
+		do { if (::Compare_(this->Flags, 0)) break; dest_object["Flags"] = this->Flags; } while (false);
+		dest_object["Name"] = this->Name;
+	}
+
+	bool JSONSAXField(uint32_t key_hash, std::string_view key, JSONSAXLoader& loader, JSONLoadedFields& loaded)
+	{
+		constexpr size_t field_index_base = 0;
+		switch (key_hash) {
+		case FieldNameHash("X"): if (key == "X") { loaded.Set(field_index_base + 0); loader.Load(this->X); return true; } break;
+		case FieldNameHash("Y"): if (key == "Y") { loaded.Set(field_index_base + 1); loader.Load(this->Y); return true; } break;
+		case FieldNameHash("Z"): if (key == "Z") { loaded.Set(field_index_base + 2); loader.Load(this->Z); return true; } break;
+		case FieldNameHash("ID"): if (key == "ID") { loaded.Set(field_index_base + 3); loader.Load(this->ID); return true; } break;
+		case FieldNameHash("Flags"): if (key == "Flags") { loaded.Set(field_index_base + 4); loader.Load(this->Flags); return true; } break;
+		case FieldNameHash("Name"): if (key == "Name") { loaded.Set(field_index_base + 5); loader.Load(this->Name); return true; } break;
+		}
+		return false;
+	}
+
+	void JSONWriteFields(JSONWriter& writer) const
+	{
+		do { if (::Compare_(this->X, 0)) break; writer.Field("X", this->X); } while (false);
+		do { if (::Compare_(this->Y, 0)) break; writer.Field("Y", this->Y); } while (false);
+		do { if (::Compare_(this->Z, 0)) break; writer.Field("Z", this->Z); } while (false);
+		do { if (::Compare_(this->ID, 0)) break; writer.Field("ID", this->ID); } while (false);
+		do { if (::Compare_(this->Flags, 0)) break; writer.Field("Flags", this->Flags); } while (false);
+		writer.Field("Name", this->Name);
+	}
+
+	void BinaryLoadFields(BinaryObject const& src_object)
+	{
+		if (auto entry = src_object.Find(FieldNameHash("X")); !entry) this->X = 0; else BinaryReadField(*entry, this->X);
+		if (auto entry = src_object.Find(FieldNameHash("Y")); !entry) this->Y = 0; else BinaryReadField(*entry, this->Y);
+		if (auto entry = src_object.Find(FieldNameHash("Z")); !entry) this->Z = 0; else BinaryReadField(*entry, this->Z);
+		if (auto entry = src_object.Find(FieldNameHash("ID")); !entry) this->ID = 0; else BinaryReadField(*entry, this->ID);
+		if (auto entry = src_object.Find(FieldNameHash("Flags")); !entry) this->Flags = 0; else BinaryReadField(*entry, this->Flags);
+		if (auto entry = src_object.Find(FieldNameHash("Name")); !entry) this->Name = decltype(this->Name){}; else BinaryReadField(*entry, this->Name);
+	}
+
+	void BinarySaveFields(BinaryWriter& dest_object) const
+	{
+		do { if (::Compare_(this->X, 0)) break; BinaryWriteField(dest_object, FieldNameHash("X"), this->X); } while (false);
+		do { if (::Compare_(this->Y, 0)) break; BinaryWriteField(dest_object, FieldNameHash("Y"), this->Y); } while (false);
+		do { if (::Compare_(this->Z, 0)) break; BinaryWriteField(dest_object, FieldNameHash("Z"), this->Z); } while (false);
+		do { if (::Compare_(this->ID, 0)) break; BinaryWriteField(dest_object, FieldNameHash("ID"), this->ID); } while (false);
+		do { if (::Compare_(this->Flags, 0)) break; BinaryWriteField(dest_object, FieldNameHash("Flags"), this->Flags); } while (false);
+		BinaryWriteField(dest_object, FieldNameHash("Name"), this->Name);
+	}
+};
+
+struct SampleAttributes
+{
+	static constexpr uint64_t AttributeFlagBits = 0;
+	static constexpr std::array<std::string_view, 1> AttributeNames = { "Columnar" };
+	static constexpr bool Columnar = true;
+};
+
+/// The same record, with the `Columnar` attribute; vectors of it are saved column by column, through its field visitor
+struct Sample
+{
+	REFLECTOR_TEST_STRUCT_BODY(Sample);
+	using self_attributes = SampleAttributes;
+
+	float X = 0;
+	float Y = 0;
+	float Z = 0;
+	int32_t ID = 0;
+	uint64_t Flags = 0;
+	std::string Name;
+
+	bool operator==(Sample const&) const = default;
+
+	template <typename VISITOR> static void ForEachField(VISITOR&& visitor, bool own_only = false)
+	{
+		visitor(FieldVisitorData<CompileTimeFieldData<float, Sample, 0, "X", decltype(&Sample::X), &Sample::X>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<float, Sample, 0, "Y", decltype(&Sample::Y), &Sample::Y>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<float, Sample, 0, "Z", decltype(&Sample::Z), &Sample::Z>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<int32_t, Sample, 0, "ID", decltype(&Sample::ID), &Sample::ID>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<uint64_t, Sample, 0, "Flags", decltype(&Sample::Flags), &Sample::Flags>>{ nullptr });
+		visitor(FieldVisitorData<CompileTimeFieldData<std::string, Sample, 0, "Name", decltype(&Sample::Name), &Sample::Name>>{ nullptr });
+	}
+};
+
+/// The polymorphic graph: a list of shapes of different classes, owned by `std::unique_ptr`s
+struct Shape : Reflectable
+{
+	REFLECTOR_TEST_CLASS_BODY(Shape);
+	using parent_type = Reflectable;
+	Shape() : Reflectable(StaticGetReflectionData()) {}
+	explicit Shape(Class const& klass) : Reflectable(klass) {}
+
+	std::string Name;
+	int32_t Layer = 0;
+
+	virtual bool Equals(Shape const& other) const { return &GetReflectionData() == &other.GetReflectionData() && Name == other.Name && Layer == other.Layer; }
+
+	static constexpr size_t JSONLoadableFieldCount = parent_type::JSONLoadableFieldCount + 2;
+
+	void JSONLoadFields(nlohmann::json const& src_object) override
+	{
+		JSONLoadedFields loaded;
+		if (src_object.is_object())
+		{
+			for (auto const& [key, value] : src_object.get_ref<nlohmann::json::object_t const&>())
+				this->JSONLoadField(FieldNameHash(key), key, value, loaded);
+		}
+		this->JSONLoadFinish(loaded);
+	}
+
+	bool JSONLoadField(uint32_t key_hash, std::string_view key, nlohmann::json const& value, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Name"):
+			if (key == "Name") { loaded.Set(field_index_base + 0); try { value.get_to<std::string>(this->Name); } catch (DataError& e) { e.File += "/Name"; throw; } return true; }
+			break;
+		case FieldNameHash("Layer"):
+			if (key == "Layer") { loaded.Set(field_index_base + 1); try { value.get_to<int32_t>(this->Layer); } catch (DataError& e) { e.File += "/Layer"; throw; } return true; }
+			break;
+		}
+		return parent_type::JSONLoadField(key_hash, key, value, loaded);
+	}
+
+	void JSONLoadFinish(JSONLoadedFields const& loaded) override
+	{
+		parent_type::JSONLoadFinish(loaded);
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		if (!loaded.Test(field_index_base + 0)) this->Name = decltype(this->Name){};
+		if (!loaded.Test(field_index_base + 1)) this->Layer = 0;
+	}
+
+	void JSONSaveFields(nlohmann::json& dest_object) const override
+	{
+		parent_type::JSONSaveFields(dest_object);
+		dest_object["Name"] = this->Name;
+		do { if (::Compare_(this->Layer, 0)) break; dest_object["Layer"] = this->Layer; } while (false);
+		dest_object["$type"] = "Shape";
+	}
+
+	bool JSONSAXField(uint32_t key_hash, std::string_view key, JSONSAXLoader& loader, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Name"): if (key == "Name") { loaded.Set(field_index_base + 0); loader.Load(this->Name); return true; } break;
+		case FieldNameHash("Layer"): if (key == "Layer") { loaded.Set(field_index_base + 1); loader.Load(this->Layer); return true; } break;
+		}
+		return parent_type::JSONSAXField(key_hash, key, loader, loaded);
+	}
+
+	void JSONWriteFields(JSONWriter& writer) const override
+	{
+		parent_type::JSONWriteFields(writer);
+		writer.Field("Name", this->Name);
+		do { if (::Compare_(this->Layer, 0)) break; writer.Field("Layer", this->Layer); } while (false);
+	}
+
+	void BinaryLoadFields(BinaryObject const& src_object) override
+	{
+		parent_type::BinaryLoadFields(src_object);
+		if (auto entry = src_object.Find(FieldNameHash("Name")); !entry) this->Name = decltype(this->Name){}; else BinaryReadField(*entry, this->Name);
+		if (auto entry = src_object.Find(FieldNameHash("Layer")); !entry) this->Layer = 0; else BinaryReadField(*entry, this->Layer);
+	}
+
+	void BinarySaveFields(BinaryWriter& dest_object) const override
+	{
+		parent_type::BinarySaveFields(dest_object);
+		BinaryWriteField(dest_object, FieldNameHash("Name"), this->Name);
+		do { if (::Compare_(this->Layer, 0)) break; BinaryWriteField(dest_object, FieldNameHash("Layer"), this->Layer); } while (false);
+	}
+};
+
+struct Circle : Shape
+{
+	REFLECTOR_TEST_CLASS_BODY(Circle);
+	using parent_type = Shape;
+	Circle() : Shape(StaticGetReflectionData()) {}
+
+	float Radius = 0;
+
+	bool Equals(Shape const& other) const override { return Shape::Equals(other) && Radius == static_cast<Circle const&>(other).Radius; }
+
+	static constexpr size_t JSONLoadableFieldCount = parent_type::JSONLoadableFieldCount + 1;
+
+	void JSONLoadFields(nlohmann::json const& src_object) override
+	{
+		JSONLoadedFields loaded;
+		if (src_object.is_object())
+		{
+			for (auto const& [key, value] : src_object.get_ref<nlohmann::json::object_t const&>())
+				this->JSONLoadField(FieldNameHash(key), key, value, loaded);
+		}
+		this->JSONLoadFinish(loaded);
+	}
+
+	bool JSONLoadField(uint32_t key_hash, std::string_view key, nlohmann::json const& value, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Radius"):
+			if (key == "Radius") { loaded.Set(field_index_base + 0); try { value.get_to<float>(this->Radius); } catch (DataError& e) { e.File += "/Radius"; throw; } return true; }
+			break;
+		}
+		return parent_type::JSONLoadField(key_hash, key, value, loaded);
+	}
+
+	void JSONLoadFinish(JSONLoadedFields const& loaded) override
+	{
+		parent_type::JSONLoadFinish(loaded);
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		if (!loaded.Test(field_index_base + 0)) this->Radius = 0;
+	}
+
+	void JSONSaveFields(nlohmann::json& dest_object) const override
+	{
+		parent_type::JSONSaveFields(dest_object);
+		do { if (::Compare_(this->Radius, 0)) break; dest_object["Radius"] = this->Radius; } while (false);
+		dest_object["$type"] = "Circle";
+	}
+
+	bool JSONSAXField(uint32_t key_hash, std::string_view key, JSONSAXLoader& loader, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Radius"): if (key == "Radius") { loaded.Set(field_index_base + 0); loader.Load(this->Radius); return true; } break;
+		}
+		return parent_type::JSONSAXField(key_hash, key, loader, loaded);
+	}
+
+	void JSONWriteFields(JSONWriter& writer) const override
+	{
+		parent_type::JSONWriteFields(writer);
+		do { if (::Compare_(this->Radius, 0)) break; writer.Field("Radius", this->Radius); } while (false);
+	}
+
+	void BinaryLoadFields(BinaryObject const& src_object) override
+	{
+		parent_type::BinaryLoadFields(src_object);
+		if (auto entry = src_object.Find(FieldNameHash("Radius")); !entry) this->Radius = 0; else BinaryReadField(*entry, this->Radius);
+	}
+
+	void BinarySaveFields(BinaryWriter& dest_object) const override
+	{
+		parent_type::BinarySaveFields(dest_object);
+		do { if (::Compare_(this->Radius, 0)) break; BinaryWriteField(dest_object, FieldNameHash("Radius"), this->Radius); } while (false);
+	}
+};
+
+struct Polygon : Shape
+{
+	REFLECTOR_TEST_CLASS_BODY(Polygon);
+	using parent_type = Shape;
+	Polygon() : Shape(StaticGetReflectionData()) {}
+
+	std::vector<float> Points;
+
+	bool Equals(Shape const& other) const override { return Shape::Equals(other) && Points == static_cast<Polygon const&>(other).Points; }
+
+	static constexpr size_t JSONLoadableFieldCount = parent_type::JSONLoadableFieldCount + 1;
+
+	void JSONLoadFields(nlohmann::json const& src_object) override
+	{
+		JSONLoadedFields loaded;
+		if (src_object.is_object())
+		{
+			for (auto const& [key, value] : src_object.get_ref<nlohmann::json::object_t const&>())
+				this->JSONLoadField(FieldNameHash(key), key, value, loaded);
+		}
+		this->JSONLoadFinish(loaded);
+	}
+
+	bool JSONLoadField(uint32_t key_hash, std::string_view key, nlohmann::json const& value, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Points"):
+			if (key == "Points") { loaded.Set(field_index_base + 0); try { value.get_to<std::vector<float>>(this->Points); } catch (DataError& e) { e.File += "/Points"; throw; } return true; }
+			break;
+		}
+		return parent_type::JSONLoadField(key_hash, key, value, loaded);
+	}
+
+	void JSONLoadFinish(JSONLoadedFields const& loaded) override
+	{
+		parent_type::JSONLoadFinish(loaded);
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		if (!loaded.Test(field_index_base + 0)) this->Points = decltype(this->Points){};
+	}
+
+	void JSONSaveFields(nlohmann::json& dest_object) const override
+	{
+		parent_type::JSONSaveFields(dest_object);
+		dest_object["Points"] = this->Points;
+		dest_object["$type"] = "Polygon";
+	}
+
+	bool JSONSAXField(uint32_t key_hash, std::string_view key, JSONSAXLoader& loader, JSONLoadedFields& loaded) override
+	{
+		constexpr size_t field_index_base = parent_type::JSONLoadableFieldCount;
+		switch (key_hash) {
+		case FieldNameHash("Points"): if (key == "Points") { loaded.Set(field_index_base + 0); loader.Load(this->Points); return true; } break;
+		}
+		return parent_type::JSONSAXField(key_hash, key, loader, loaded);
+	}
+
+	void JSONWriteFields(JSONWriter& writer) const override
+	{
+		parent_type::JSONWriteFields(writer);
+		writer.Field("Points", this->Points);
+	}
+
+	void BinaryLoadFields(BinaryObject const& src_object) override
+	{
+		parent_type::BinaryLoadFields(src_object);
+		if (auto entry = src_object.Find(FieldNameHash("Points")); !entry) this->Points = decltype(this->Points){}; else BinaryReadField(*entry, this->Points);
+	}
+
+	void BinarySaveFields(BinaryWriter& dest_object) const override
+	{
+		parent_type::BinarySaveFields(dest_object);
+		BinaryWriteField(dest_object, FieldNameHash("Points"), this->Points);
+	}
+};
+
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Record, "")
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Sample, "")
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Shape, "")
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Circle, "Shape")
+REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(Polygon, "Shape")
+
+namespace Reflector
+{
+	Class const* Classes[] = { &Shape::StaticGetReflectionData(), &Circle::StaticGetReflectionData(), &Polygon::StaticGetReflectionData(), nullptr };
+	Enum const* Enums[] = { nullptr };
+}
+
+using Scene = std::vector<std::unique_ptr<Shape>>;
+
+static std::vector<Record> MakeRecords(size_t count)
+{
+	std::mt19937 random{ 1234 };
+	std::uniform_real_distribution<float> coordinate{ -1000.0f, 1000.0f };
+	std::vector<Record> records(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto& record = records[i];
+		record.X = coordinate(random);
+		record.Y = coordinate(random);
+		record.Z = coordinate(random);
+		record.ID = int32_t(i);
+		record.Flags = random() & 0xFFFF;
+		record.Name = "record " + std::to_string(i);
+	}
+	return records;
+}
+
+static std::vector<Sample> MakeSamples(std::vector<Record> const& records)
+{
+	std::vector<Sample> samples(records.size());
+	for (size_t i = 0; i < records.size(); ++i)
+		samples[i] = { records[i].X, records[i].Y, records[i].Z, records[i].ID, records[i].Flags, records[i].Name };
+	return samples;
+}
+
+static Scene MakeScene(size_t count)
+{
+	std::mt19937 random{ 5678 };
+	std::uniform_real_distribution<float> coordinate{ -1000.0f, 1000.0f };
+	Scene scene;
+	scene.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::unique_ptr<Shape> shape;
+		if (i % 2)
+		{
+			auto circle = std::make_unique<Circle>();
+			circle->Radius = coordinate(random);
+			shape = std::move(circle);
+		}
+		else
+		{
+			auto polygon = std::make_unique<Polygon>();
+			polygon->Points.resize(2 * (3 + random() % 6));
+			for (auto& point : polygon->Points)
+				point = coordinate(random);
+			shape = std::move(polygon);
+		}
+		shape->Name = "shape " + std::to_string(i);
+		shape->Layer = int32_t(random() % 8);
+		scene.push_back(std::move(shape));
+	}
+	return scene;
+}
+
+static bool Equal(std::vector<Record> const& a, std::vector<Record> const& b) { return a == b; }
+static bool Equal(std::vector<Sample> const& a, std::vector<Sample> const& b) { return a == b; }
+static bool Equal(Scene const& a, Scene const& b)
+{
+	return std::ranges::equal(a, b, [](auto const& x, auto const& y) { return x && y && x->Equals(*y); });
+}
+
+/// Formats
+/// ///////////////////////////////////// ///
+
+struct JSONDOMFormat
+{
+	static constexpr char const* Name = "JSON DOM";
+	template <typename T> static std::string Save(T const& value) { return nlohmann::json(value).dump(); }
+	template <typename T> static void Load(std::string const& data, T& value) { nlohmann::json::parse(data).get_to(value); }
+};
+
+struct JSONStreamFormat
+{
+	static constexpr char const* Name = "JSON stream";
+	template <typename T> static std::string Save(T const& value) { return JSONStreamSave(value); }
+	template <typename T> static void Load(std::string const& data, T& value) { JSONStreamLoad(std::string_view{ data }, value); }
+};
+
+struct BinaryFormat
+{
+	static constexpr char const* Name = "binary";
+	template <typename T> static std::vector<uint8_t> Save(T const& value) { return BinarySave(value); }
+	template <typename T> static void Load(std::vector<uint8_t> const& data, T& value) { BinaryLoad(data, value); }
+};
+
+/// Benchmarking
+/// ///////////////////////////////////// ///
+
+static size_t PeakRSSKilobytes()
+{
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return size_t(usage.ru_maxrss);
+}
+
+template <typename FUNC>
+static double BestSeconds(int repetitions, FUNC&& func)
+{
+	double best = 0;
+	for (int i = 0; i < repetitions; ++i)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		func();
+		const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (i == 0 || seconds < best)
+			best = seconds;
+	}
+	return best;
+}
+
+template <typename FORMAT, typename T>
+static void Benchmark(char const* data_set, T const& original, int repetitions)
+{
+	const auto count = original.size();
+
+	auto allocations = ReflectorTests::AllocationCount;
+	auto saved = FORMAT::Save(original);
+	const auto save_allocations = ReflectorTests::AllocationCount - allocations;
+	const auto save_seconds = BestSeconds(repetitions, [&] { saved = FORMAT::Save(original); });
+
+	/// Loading into an empty container, which is the common case, and allocates every object
+	T loaded;
+	allocations = ReflectorTests::AllocationCount;
+	FORMAT::Load(saved, loaded);
+	const auto load_allocations = ReflectorTests::AllocationCount - allocations;
+	REFLECTOR_TEST_CHECK(Equal(original, loaded));
+	const auto load_seconds = BestSeconds(repetitions, [&] { T target; FORMAT::Load(saved, target); });
+
+	const auto megabytes = double(saved.size()) / (1024.0 * 1024.0);
+	std::printf("%-10s %-12s %12zu %10.1f %10.1f %12.0f %12.0f %10.1f %10.1f %10zu\n", data_set, FORMAT::Name, saved.size(),
+		megabytes / save_seconds, megabytes / load_seconds, double(count) / save_seconds, double(count) / load_seconds,
+		double(save_allocations) / double(count), double(load_allocations) / double(count), PeakRSSKilobytes() / 1024);
+}
+
+template <typename T>
+static void BenchmarkAllFormats(char const* data_set, T const& original, int repetitions)
+{
+	Benchmark<JSONDOMFormat>(data_set, original, repetitions);
+	Benchmark<JSONStreamFormat>(data_set, original, repetitions);
+	Benchmark<BinaryFormat>(data_set, original, repetitions);
+}
+
+int main(int argc, char** argv)
+{
+	const size_t count = argc > 1 ? size_t(std::strtoull(argv[1], nullptr, 10)) : 20000;
+	const int repetitions = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+
+	std::printf("%zu objects per data set, best of %d repetitions\n", count, repetitions);
+	std::printf("%-10s %-12s %12s %10s %10s %12s %12s %10s %10s %10s\n", "data set", "format", "bytes", "save MB/s", "load MB/s",
+		"save obj/s", "load obj/s", "save al/ob", "load al/ob", "peak MB");
+
+	{
+		const auto records = MakeRecords(count);
+		BenchmarkAllFormats("rows", records, repetitions);
+		BenchmarkAllFormats("columns", MakeSamples(records), repetitions);
+	}
+	BenchmarkAllFormats("shapes", MakeScene(count), repetitions);
+
+	if (ReflectorTests::Failures == 0)
+		std::printf("SerializationBenchmarks: all loaded data matched\n");
+	return ReflectorTests::Failures;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+/// Shared helpers for the standalone serialization tests and benchmarks. The Reflector runtime is configured the way a Reflector.h
+/// generated with `JSON.Use`, `JSON.GenerateStreamingLoadMethods`, `JSON.GenerateStreamingSaveMethods` and `Binary.Use` configures it,
+/// so the programs also need the nlohmann/json headers:
+///   g++ -std=c++20 -fpermissive -I../Include -I<nlohmann/json include directory> -o BinaryTests BinaryTests.cpp
+/// As with the GC tests, the test classes are written by hand, in the same shape as the code generated for them by Reflector.
+
+#include <nlohmann/json.hpp>
+#define REFLECTOR_USES_JSON 1
+#define REFLECTOR_JSON_TYPE ::nlohmann::json
+#define REFLECTOR_JSON_HEADER <nlohmann/json.hpp>
+#define REFLECTOR_JSON_PARSE_FUNC ::nlohmann::json::parse
+#define REFLECTOR_USES_BINARY 1
+#define REFLECTOR_USES_JSON_SAX 1
+#define REFLECTOR_USES_JSON_WRITER 1
+#include "ReflectorJSON.h"
+#include "ReflectorBinary.h"
+#include "Reflector.cpp"
+#include "TestCommon.h"
+
+/// Written into the generated database file, for the checks of saved fields against their initializers
+template <typename T, typename U = T> bool Compare_(T&& t, U&& u) { return t == u; }
+
+/// The reflection members of a test struct (a reflected class that doesn't derive from `Reflectable`)
+#define REFLECTOR_TEST_STRUCT_BODY(T) \
+	using self_type = T; \
+	static constexpr uint64_t StaticClassFlags() { return 0; } \
+	static ::Reflector::Class const& StaticGetReflectionData();
+
+/// Reflection data for a hand-written serializable test class; `BASE` is the full type of its reflected base class, or empty.
+/// Polymorphic objects are created through `DefaultConstructor` (and `DefaultPlacementConstructor`, by `from_json`).
+#define REFLECTOR_TEST_SERIALIZABLE_CLASS_DATA(T, BASE) \
+	::Reflector::Class const& T::StaticGetReflectionData() \
+	{ \
+		static const ::Reflector::Class data{ .Name = #T, .FullType = #T, .BaseClassName = BASE, .Alignment = alignof(T), .Size = sizeof(T), \
+			.DefaultPlacementConstructor = [](void* p) { new (p) T(); }, .DefaultConstructor = []() -> void* { return new T(); }, \
+			.Destructor = [](void* p) { static_cast<T*>(p)->~T(); } }; \
+		return data; \
+	}
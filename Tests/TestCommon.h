@@ -0,0 +1,21 @@
+#pragma once
+
+/// Helpers shared by all the standalone tests; included by the test-specific common headers (e.g. GCTestCommon.h) after the
+/// Reflector runtime
+
+#include <cstdio>
+
+namespace ReflectorTests
+{
+	inline int Failures = 0;
+}
+
+#define REFLECTOR_TEST_CHECK(...) \
+	do { if (!(__VA_ARGS__)) { std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__); ++::ReflectorTests::Failures; } } while (0)
+
+/// The reflection members of a test class
+#define REFLECTOR_TEST_CLASS_BODY(T) \
+	using self_type = T; \
+	static constexpr uint64_t StaticClassFlags() { return 0; } \
+	static ::Reflector::Class const& StaticGetReflectionData(); \
+	::Reflector::Class const& GetReflectionData() const override { return StaticGetReflectionData(); }